@@ -0,0 +1,351 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include <ctime>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+
+#include "caf/all.hpp"
+#include "caf/opencl/all.hpp"
+#include "caf/opencl/config.hpp"
+
+using namespace std;
+using namespace caf;
+using namespace caf::opencl;
+
+namespace {
+
+using ivec = vector<int>;
+using iref = mem_ref<int>;
+using clock_type = chrono::steady_clock;
+
+using done_atom = atom_constant<atom("done")>;
+
+constexpr const char* kernel_source = R"__(
+kernel void empty(global int* x) {
+  // nop
+}
+
+kernel void increment(global int* x) {
+  x[get_global_id(0)] += 1;
+}
+)__";
+
+class bench_config : public opencl::config {
+public:
+  bench_config() {
+    opt_group{custom_options_, "bench"}
+    .add(output, "output", "path of the JSON report")
+    .add(repetitions, "repetitions", "samples per measurement")
+    .add(max_senders, "max-senders", "max. number of concurrent senders")
+    .add(max_bytes, "max-bytes", "max. transfer size for bandwidth tests");
+  }
+
+  std::string output = "caf_opencl_bench.json";
+  size_t repetitions = 100;
+  size_t max_senders = 16;
+  size_t max_bytes = size_t{1} << 26;
+};
+
+double elapsed_since(clock_type::time_point start) {
+  chrono::duration<double> d = clock_type::now() - start;
+  return d.count();
+}
+
+// waits for the command that produces `x`
+void await(iref& x) {
+  auto event = x.event();
+  if (event) {
+    auto e = event.get();
+    clWaitForEvents(1, &e);
+  }
+}
+
+string escape(const string& str) {
+  string result;
+  for (auto c : str) {
+    if (c == '"' || c == '\\')
+      result += '\\';
+    result += c;
+  }
+  return result;
+}
+
+/// A single measurement, all samples in seconds.
+struct record {
+  string name;
+  vector<pair<string, size_t>> params;
+  vector<double> samples;
+  /// Bytes or messages processed per sample, used to compute throughput.
+  double work;
+};
+
+class report {
+public:
+  explicit report(const device_ptr& dev) : dev_(dev) {
+    // nop
+  }
+
+  void add(record x) {
+    if (x.samples.empty())
+      return;
+    auto& xs = x.samples;
+    sort(begin(xs), end(xs));
+    cout << setw(12) << left << x.name << right;
+    for (auto& p : x.params)
+      cout << " " << p.first << "=" << p.second;
+    cout << ": median " << fixed << setprecision(2)
+         << median(xs) * 1e6 << " us";
+    if (x.work > 0)
+      cout << ", " << setprecision(1) << x.work / median(xs) << " / s";
+    cout << endl;
+    records_.push_back(std::move(x));
+  }
+
+  void write(ostream& out) const {
+    out << "{\n"
+        << "  \"device\": \"" << escape(dev_->name()) << "\",\n"
+        << "  \"device_version\": \"" << escape(dev_->device_version())
+        << "\",\n"
+        << "  \"driver_version\": \"" << escape(dev_->driver_version())
+        << "\",\n"
+        << "  \"timestamp\": " << time(nullptr) << ",\n"
+        << "  \"results\": [";
+    for (size_t i = 0; i < records_.size(); ++i) {
+      auto& x = records_[i];
+      auto& xs = x.samples;
+      out << (i == 0 ? "\n" : ",\n")
+          << "    {\"name\": \"" << x.name << "\", \"params\": {";
+      for (size_t j = 0; j < x.params.size(); ++j)
+        out << (j == 0 ? "" : ", ") << "\"" << x.params[j].first << "\": "
+            << x.params[j].second;
+      out << "}, \"unit\": \"s\", \"samples\": " << xs.size()
+          << setprecision(9) << scientific
+          << ", \"min\": " << xs.front()
+          << ", \"median\": " << median(xs)
+          << ", \"p90\": " << xs[xs.size() * 9 / 10]
+          << ", \"max\": " << xs.back();
+      if (x.work > 0)
+        out << ", \"per_second\": " << x.work / median(xs);
+      out << "}";
+    }
+    out << "\n  ]\n}\n";
+  }
+
+private:
+  static double median(const vector<double>& xs) {
+    return xs[xs.size() / 2];
+  }
+
+  device_ptr dev_;
+  vector<record> records_;
+};
+
+// -- benchmarks ---------------------------------------------------------------
+
+void spawn_cost(actor_system& sys, program_ptr prog, size_t reps,
+                report& rep) {
+  auto& mngr = sys.opencl_manager();
+  record x{"spawn", {}, {}, 0};
+  for (size_t i = 0; i < reps; ++i) {
+    auto start = clock_type::now();
+    auto worker = mngr.spawn(prog, "empty", nd_range{dim_vec{1}},
+                             in_out<int>{});
+    x.samples.push_back(elapsed_since(start));
+    anon_send_exit(worker, exit_reason::user_shutdown);
+  }
+  rep.add(std::move(x));
+}
+
+void round_trip(actor_system& sys, program_ptr prog, size_t reps,
+                report& rep) {
+  auto& mngr = sys.opencl_manager();
+  auto worker = mngr.spawn(prog, "empty", nd_range{dim_vec{1}},
+                           in_out<int>{});
+  scoped_actor self{sys};
+  record x{"round_trip", {}, {}, 0};
+  for (size_t i = 0; i <= reps; ++i) {
+    auto start = clock_type::now();
+    self->request(worker, infinite, ivec{0}).receive(
+      [](ivec&) { /* nop */ },
+      [&](error& err) { cerr << sys.render(err) << endl; }
+    );
+    if (i > 0) // the first request creates the command queue
+      x.samples.push_back(elapsed_since(start));
+  }
+  anon_send_exit(worker, exit_reason::user_shutdown);
+  rep.add(std::move(x));
+}
+
+void bandwidth(const device_ptr& dev, size_t max_bytes, size_t reps,
+               report& rep) {
+  for (auto bytes = size_t{1} << 12; bytes <= max_bytes; bytes *= 4) {
+    ivec xs(bytes / sizeof(int), 1);
+    record h2d{"h2d", {{"bytes", bytes}}, {}, static_cast<double>(bytes)};
+    record d2h{"d2h", {{"bytes", bytes}}, {}, static_cast<double>(bytes)};
+    auto n = max(size_t{3}, min(reps, (size_t{1} << 28) / bytes));
+    for (size_t i = 0; i <= n; ++i) {
+      auto start = clock_type::now();
+      auto ref = dev->global_argument(xs);
+      await(ref);
+      auto t_h2d = elapsed_since(start);
+      start = clock_type::now();
+      auto ys = ref.data();
+      auto t_d2h = elapsed_since(start);
+      if (!ys || i == 0) // warm up buffer pools
+        continue;
+      h2d.samples.push_back(t_h2d);
+      d2h.samples.push_back(t_d2h);
+    }
+    rep.add(std::move(h2d));
+    rep.add(std::move(d2h));
+  }
+}
+
+void chaining(actor_system& sys, const device_ptr& dev, program_ptr prog,
+              size_t reps, report& rep) {
+  auto& mngr = sys.opencl_manager();
+  auto stage = mngr.spawn(prog, "increment", nd_range{dim_vec{1}},
+                          in_out<int, mref, mref>{});
+  scoped_actor self{sys};
+  auto input = dev->global_argument(ivec{0});
+  for (size_t length : {1, 4, 16}) {
+    auto chain = stage;
+    for (size_t i = 1; i < length; ++i)
+      chain = stage * chain;
+    record x{"chain", {{"length", length}}, {}, 0};
+    for (size_t i = 0; i <= reps; ++i) {
+      auto start = clock_type::now();
+      self->request(chain, infinite, input).receive(
+        [&](iref& result) {
+          await(result);
+          input = std::move(result);
+        },
+        [&](error& err) { cerr << sys.render(err) << endl; }
+      );
+      if (i > 0)
+        x.samples.push_back(elapsed_since(start));
+    }
+    rep.add(std::move(x));
+  }
+  anon_send_exit(stage, exit_reason::user_shutdown);
+}
+
+struct sender_state {
+  size_t remaining = 0;
+};
+
+// sends the response of each request as next request until done
+behavior sender(stateful_actor<sender_state>* self, actor worker,
+                size_t requests, actor parent) {
+  self->state.remaining = requests;
+  self->send(worker, ivec{0});
+  return {
+    [=](ivec& xs) {
+      if (--self->state.remaining == 0) {
+        self->send(parent, done_atom::value);
+        self->quit();
+        return;
+      }
+      self->send(worker, std::move(xs));
+    }
+  };
+}
+
+void concurrency(actor_system& sys, program_ptr prog, size_t max_senders,
+                 size_t reps, report& rep) {
+  auto& mngr = sys.opencl_manager();
+  auto worker = mngr.spawn(prog, "empty", nd_range{dim_vec{1}},
+                           in_out<int>{});
+  scoped_actor self{sys};
+  auto parent = actor_cast<actor>(self);
+  for (size_t senders = 1; senders <= max_senders; senders *= 2) {
+    record x{"concurrency", {{"senders", senders}}, {},
+             static_cast<double>(senders * reps)};
+    for (int run = 0; run < 4; ++run) {
+      auto start = clock_type::now();
+      for (size_t i = 0; i < senders; ++i)
+        sys.spawn(sender, worker, reps, parent);
+      for (size_t i = 0; i < senders; ++i)
+        self->receive([](done_atom) { /* nop */ });
+      if (run > 0)
+        x.samples.push_back(elapsed_since(start));
+    }
+    rep.add(std::move(x));
+  }
+  anon_send_exit(worker, exit_reason::user_shutdown);
+}
+
+void build_time(actor_system& sys, const device_ptr& dev, size_t reps,
+                report& rep) {
+  auto& mngr = sys.opencl_manager();
+  record x{"build", {}, {}, 0};
+  auto n = max(size_t{3}, reps / 10);
+  for (size_t i = 0; i < n; ++i) {
+    // a unique comment keeps drivers from returning cached binaries
+    auto source = "// build " + to_string(i) + " "
+                  + to_string(time(nullptr)) + "\n" + kernel_source;
+    auto start = clock_type::now();
+    mngr.create_program(source.c_str(), "", dev);
+    x.samples.push_back(elapsed_since(start));
+  }
+  rep.add(std::move(x));
+}
+
+} // namespace <anonymous>
+
+int main(int argc, char** argv) {
+  bench_config cfg;
+  cfg.load<opencl::manager>()
+     .add_message_type<ivec>("int_vector");
+  cfg.parse(argc, argv);
+  actor_system system{cfg};
+  auto& mngr = system.opencl_manager();
+  auto opt = mngr.find_device();
+  if (!opt) {
+    cerr << "No OpenCL device available." << endl;
+    return 1;
+  }
+  auto dev = *opt;
+  cout << "Benchmarking '" << dev->name() << "'" << endl;
+  auto reps = max(size_t{1}, cfg.repetitions);
+  report rep{dev};
+  auto prog = mngr.create_program(kernel_source, "", dev);
+  spawn_cost(system, prog, reps, rep);
+  round_trip(system, prog, reps, rep);
+  bandwidth(dev, cfg.max_bytes, reps, rep);
+  chaining(system, dev, prog, reps, rep);
+  concurrency(system, prog, cfg.max_senders, reps, rep);
+  build_time(system, dev, reps, rep);
+  ofstream out{cfg.output};
+  if (!out) {
+    cerr << "Cannot write " << cfg.output << endl;
+    return 1;
+  }
+  rep.write(out);
+  cout << "Wrote " << cfg.output << endl;
+  system.await_all_actors_done();
+  return 0;
+}
@@ -0,0 +1,114 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include <chrono>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+
+#include "caf/all.hpp"
+#include "caf/opencl/all.hpp"
+#include "caf/opencl/config.hpp"
+
+using namespace std;
+using namespace caf;
+using namespace caf::opencl;
+
+namespace {
+
+constexpr size_t min_size = 256;
+constexpr size_t max_size = 4096;
+
+template <class F>
+double measure(size_t reps, F f) {
+  auto start = chrono::steady_clock::now();
+  for (size_t i = 0; i < reps; ++i)
+    f();
+  auto stop = chrono::steady_clock::now();
+  chrono::duration<double> elapsed = stop - start;
+  return elapsed.count() / reps;
+}
+
+template <class T>
+void run(actor_system& system, const device_ptr& dev, const char* type) {
+  using ref = mem_ref<T>;
+  scoped_actor self{system};
+  for (auto n = min_size; n <= max_size; n *= 2) {
+    if (3 * n * n * sizeof(T) > dev->global_mem_size() / 2)
+      break;
+    gemm_shape shape{n, n, n};
+    auto tiling = tune_gemm<T>(system, dev, shape);
+    auto worker = spawn_gemm(system, dev, shape, in<T,mref>{},
+                             out<T,mref>{}, tiling);
+    vector<T> a(n * n, T{1});
+    vector<T> b(n * n, T{2});
+    auto a_ref = dev->global_argument(a);
+    auto b_ref = dev->global_argument(b);
+    auto multiply = [&] {
+      self->request(worker, infinite, a_ref, b_ref).receive(
+        [&](ref& c) {
+          // the reply arrives as soon as the kernel is enqueued
+          auto event = c.event();
+          if (event) {
+            auto e = event.get();
+            clWaitForEvents(1, &e);
+          }
+        },
+        [&](error& err) { cerr << system.render(err) << endl; }
+      );
+    };
+    multiply(); // warm up
+    auto reps = max(size_t{3}, (size_t{1} << 32) / (n * n * n));
+    auto t = measure(reps, multiply);
+    auto flops = 2. * n * n * n;
+    cout << setw(6) << type << " | " << setw(6) << n << " | "
+         << setw(3) << tiling.tile_m << "x" << setw(3) << left
+         << tiling.tile_n << right << "x" << setw(2) << tiling.tile_k
+         << " /" << setw(2) << tiling.work_m << "x" << setw(2) << left
+         << tiling.work_n << right << " | "
+         << fixed << setprecision(3) << setw(10) << t * 1e3 << " | "
+         << setprecision(1) << setw(9) << flops / t / 1e9 << endl;
+  }
+}
+
+} // namespace <anonymous>
+
+int main(int argc, char** argv) {
+  opencl::config cfg;
+  cfg.load<opencl::manager>();
+  cfg.parse(argc, argv);
+  actor_system system{cfg};
+  auto& mngr = system.opencl_manager();
+  auto opt = mngr.find_device();
+  if (!opt) {
+    cerr << "No OpenCL device available." << endl;
+    return 0;
+  }
+  auto dev = *opt;
+  cout << "Square matrix multiplication on '" << dev->name() << "'" << endl
+       << "  type |      n |        tiling |  time (ms) |   GFLOP/s" << endl
+       << "-------+--------+---------------+------------+----------" << endl;
+  run<cl_float>(system, dev, "float");
+  auto& exts = dev->extensions();
+  if (find(begin(exts), end(exts), "cl_khr_fp64") != end(exts))
+    run<cl_double>(system, dev, "double");
+  system.await_all_actors_done();
+  return 0;
+}
@@ -0,0 +1,191 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+
+#include "caf/all.hpp"
+#include "caf/opencl/all.hpp"
+#include "caf/opencl/config.hpp"
+
+using namespace std;
+using namespace caf;
+using namespace caf::opencl;
+
+namespace {
+
+using uval = cl_uint;
+using uvec = std::vector<uval>;
+using uref = mem_ref<uval>;
+
+constexpr size_t min_size = size_t{1} << 16;
+constexpr size_t max_size = size_t{1} << 26;
+
+// number of repetitions per size, scaled down for large inputs
+size_t repetitions(size_t n) {
+  return max(size_t{3}, (size_t{1} << 24) / n);
+}
+
+template <class F>
+double measure(size_t reps, F f) {
+  auto start = chrono::steady_clock::now();
+  for (size_t i = 0; i < reps; ++i)
+    f();
+  auto stop = chrono::steady_clock::now();
+  chrono::duration<double> elapsed = stop - start;
+  return elapsed.count() / reps;
+}
+
+// the sort replies as soon as its last kernel is enqueued
+template <class T>
+void await(mem_ref<T>& x) {
+  auto event = x.event();
+  if (event) {
+    auto e = event.get();
+    clWaitForEvents(1, &e);
+  }
+}
+
+struct distribution {
+  const char* name;
+  std::function<uvec (size_t)> make;
+};
+
+std::vector<distribution> distributions() {
+  return {
+    {"uniform", [](size_t n) {
+      std::mt19937 gen{42};
+      uvec xs(n);
+      for (auto& x : xs)
+        x = gen();
+      return xs;
+    }},
+    {"sorted", [](size_t n) {
+      uvec xs(n);
+      for (size_t i = 0; i < n; ++i)
+        xs[i] = static_cast<uval>(i);
+      return xs;
+    }},
+    {"reversed", [](size_t n) {
+      uvec xs(n);
+      for (size_t i = 0; i < n; ++i)
+        xs[i] = static_cast<uval>(n - i);
+      return xs;
+    }},
+    {"16 keys", [](size_t n) {
+      std::mt19937 gen{42};
+      uvec xs(n);
+      for (auto& x : xs)
+        x = gen() % 16;
+      return xs;
+    }},
+    {"constant", [](size_t n) {
+      return uvec(n, 7);
+    }}
+  };
+}
+
+} // namespace <anonymous>
+
+int main(int argc, char** argv) {
+  opencl::config cfg;
+  cfg.load<opencl::manager>()
+     .add_message_type<uvec>("uint_vector");
+  cfg.parse(argc, argv);
+  actor_system system{cfg};
+  auto& mngr = system.opencl_manager();
+  auto opt = mngr.find_device();
+  if (!opt) {
+    cerr << "No OpenCL device available." << endl;
+    return 0;
+  }
+  auto dev = *opt;
+  cout << "Radix sort of uint on '" << dev->name() << "' vs. std::sort" << endl
+       << "  elements | distribution | 4 bit (ms) | 8 bit (ms) "
+          "| pairs (ms) |  host (ms)" << endl
+       << "-----------+--------------+------------+------------"
+          "+------------+-----------" << endl;
+  {
+    scoped_actor self{system};
+    radix_sort_options wide;
+    wide.digit_bits = 8;
+    auto narrow_sort = spawn_radix_sort(system, dev, in_out<uval,mref,mref>{});
+    auto wide_sort = spawn_radix_sort(system, dev, in_out<uval,mref,mref>{},
+                                      wide);
+    auto pair_sort = spawn_radix_sort(system, dev, in_out<uval,mref,mref>{},
+                                      in_out<uval,mref,mref>{});
+    auto limit = min(static_cast<size_t>(dev->max_mem_alloc_size()),
+                     static_cast<size_t>(dev->global_mem_size() / 8));
+    auto on_error = [&](error& err) {
+      cerr << system.render(err) << endl;
+    };
+    for (auto n = min_size; n <= max_size; n *= 4) {
+      if (n * sizeof(uval) > limit)
+        break;
+      auto reps = repetitions(n);
+      for (auto& dist : distributions()) {
+        auto keys = dist.make(n);
+        auto ref = dev->global_argument(keys);
+        auto values = dev->global_argument(keys);
+        auto sort_keys = [&](actor& sorter) {
+          return [&] {
+            self->request(sorter, infinite, ref).receive(
+              [&](uref& result) { await(result); },
+              on_error
+            );
+          };
+        };
+        auto sort_pairs = [&] {
+          self->request(pair_sort, infinite, ref, values).receive(
+            [&](uref& ks, uref& vs) {
+              await(ks);
+              await(vs);
+            },
+            on_error
+          );
+        };
+        auto sort_host = [&] {
+          auto xs = keys;
+          sort(begin(xs), end(xs));
+        };
+        // warm up, e.g., for lazily created queues and buffer pools
+        sort_keys(narrow_sort)();
+        sort_keys(wide_sort)();
+        sort_pairs();
+        auto t_narrow = measure(reps, sort_keys(narrow_sort));
+        auto t_wide = measure(reps, sort_keys(wide_sort));
+        auto t_pairs = measure(reps, sort_pairs);
+        auto t_host = measure(reps, sort_host);
+        cout << setw(10) << n << " | " << setw(12) << dist.name << " | "
+             << fixed << setprecision(3)
+             << setw(10) << t_narrow * 1e3 << " | "
+             << setw(10) << t_wide * 1e3 << " | "
+             << setw(10) << t_pairs * 1e3 << " | "
+             << setw(10) << t_host * 1e3 << endl;
+      }
+    }
+  }
+  system.await_all_actors_done();
+  return 0;
+}
@@ -0,0 +1,125 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include <chrono>
+#include <vector>
+#include <iomanip>
+#include <numeric>
+#include <iostream>
+#include <algorithm>
+
+#include "caf/all.hpp"
+#include "caf/opencl/all.hpp"
+#include "caf/opencl/config.hpp"
+
+using namespace std;
+using namespace caf;
+using namespace caf::opencl;
+
+namespace {
+
+using fval = cl_float;
+using fvec = std::vector<fval>;
+
+constexpr size_t min_size = size_t{1} << 10;
+constexpr size_t max_size = size_t{1} << 28;
+
+// number of repetitions per size, scaled down for large inputs
+size_t repetitions(size_t n) {
+  return max(size_t{3}, (size_t{1} << 26) / n);
+}
+
+template <class F>
+double measure(size_t reps, F f) {
+  auto start = chrono::steady_clock::now();
+  for (size_t i = 0; i < reps; ++i)
+    f();
+  auto stop = chrono::steady_clock::now();
+  chrono::duration<double> elapsed = stop - start;
+  return elapsed.count() / reps;
+}
+
+} // namespace <anonymous>
+
+int main(int argc, char** argv) {
+  opencl::config cfg;
+  cfg.load<opencl::manager>()
+     .add_message_type<fvec>("float_vector");
+  cfg.parse(argc, argv);
+  actor_system system{cfg};
+  auto& mngr = system.opencl_manager();
+  // compare against the host on the same hardware if possible
+  auto opt = mngr.find_device_if([](const device_ptr& dev) {
+    return dev->type() == device_type::cpu;
+  });
+  if (!opt)
+    opt = mngr.find_device();
+  if (!opt) {
+    cerr << "No OpenCL device available." << endl;
+    return 0;
+  }
+  auto dev = *opt;
+  cout << "Sum of float on '" << dev->name() << "' vs. std::accumulate" << endl
+       << "  elements |   mref (ms) |    val (ms) |   host (ms)" << endl
+       << "-----------+-------------+-------------+------------" << endl;
+  {
+    scoped_actor self{system};
+    auto by_ref = spawn_reduce(system, dev, in<fval,mref>{}, out<fval>{});
+    auto by_val = spawn_reduce(system, dev, in<fval>{}, out<fval>{});
+    auto limit = min(static_cast<size_t>(dev->max_mem_alloc_size()),
+                     static_cast<size_t>(dev->global_mem_size() / 2));
+    for (auto n = min_size; n <= max_size; n *= 4) {
+      if (n * sizeof(fval) > limit)
+        break;
+      fvec values(n, 1.f);
+      auto reps = repetitions(n);
+      auto ref = dev->global_argument(values);
+      fval sink = 0;
+      auto reduce_ref = [&] {
+        self->request(by_ref, infinite, ref).receive(
+          [&](fval x) { sink += x; },
+          [&](error& err) { cerr << system.render(err) << endl; }
+        );
+      };
+      auto reduce_val = [&] {
+        self->request(by_val, infinite, values).receive(
+          [&](fval x) { sink += x; },
+          [&](error& err) { cerr << system.render(err) << endl; }
+        );
+      };
+      auto reduce_host = [&] {
+        sink += accumulate(begin(values), end(values), fval{0});
+      };
+      // warm up, e.g., for lazily created queues and buffer pools
+      reduce_ref();
+      reduce_val();
+      auto t_ref = measure(reps, reduce_ref);
+      auto t_val = measure(reps, reduce_val);
+      auto t_host = measure(reps, reduce_host);
+      cout << setw(10) << n << " | " << fixed << setprecision(3)
+           << setw(11) << t_ref * 1e3 << " | "
+           << setw(11) << t_val * 1e3 << " | "
+           << setw(11) << t_host * 1e3 << endl;
+      if (sink < 0) // keeps the compiler from discarding the host reduction
+        cout << sink << endl;
+    }
+  }
+  system.await_all_actors_done();
+  return 0;
+}
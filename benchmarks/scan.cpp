@@ -0,0 +1,115 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include <chrono>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+
+#include "caf/all.hpp"
+#include "caf/opencl/all.hpp"
+#include "caf/opencl/config.hpp"
+
+using namespace std;
+using namespace caf;
+using namespace caf::opencl;
+
+namespace {
+
+using uval = cl_uint;
+using uvec = std::vector<uval>;
+using uref = mem_ref<uval>;
+
+constexpr size_t min_size = size_t{1} << 10;
+constexpr size_t max_size = size_t{1} << 30;
+
+// number of repetitions per size, scaled down for large inputs
+size_t repetitions(size_t n) {
+  return max(size_t{3}, (size_t{1} << 26) / n);
+}
+
+template <class F>
+double measure(size_t reps, F f) {
+  auto start = chrono::steady_clock::now();
+  for (size_t i = 0; i < reps; ++i)
+    f();
+  auto stop = chrono::steady_clock::now();
+  chrono::duration<double> elapsed = stop - start;
+  return elapsed.count() / reps;
+}
+
+} // namespace <anonymous>
+
+int main(int argc, char** argv) {
+  opencl::config cfg;
+  cfg.load<opencl::manager>()
+     .add_message_type<uvec>("uint_vector");
+  cfg.parse(argc, argv);
+  actor_system system{cfg};
+  auto& mngr = system.opencl_manager();
+  auto opt = mngr.find_device();
+  if (!opt) {
+    cerr << "No OpenCL device available." << endl;
+    return 0;
+  }
+  auto dev = *opt;
+  cout << "Exclusive scan of uint on '" << dev->name() << "'" << endl
+       << "  elements |   mref (ms) |  Melem/s |    val (ms) |  Melem/s" << endl
+       << "-----------+-------------+----------+-------------+---------"
+       << endl;
+  {
+    scoped_actor self{system};
+    auto by_ref = spawn_scan(system, dev, in_out<uval,mref,mref>{});
+    auto by_val = spawn_scan(system, dev, in_out<uval,val,val>{});
+    auto limit = min(static_cast<size_t>(dev->max_mem_alloc_size()),
+                     static_cast<size_t>(dev->global_mem_size() / 2));
+    for (auto n = min_size; n <= max_size; n *= 4) {
+      if (n * sizeof(uval) > limit)
+        break;
+      uvec values(n, 1);
+      auto reps = repetitions(n);
+      auto ref = dev->global_argument(values);
+      auto scan_ref = [&] {
+        self->request(by_ref, infinite, ref).receive(
+          [&](uref& result) { ref = std::move(result); },
+          [&](error& err) { cerr << system.render(err) << endl; }
+        );
+      };
+      auto scan_val = [&] {
+        self->request(by_val, infinite, values).receive(
+          [&](uvec&) { /* nop */ },
+          [&](error& err) { cerr << system.render(err) << endl; }
+        );
+      };
+      // warm up, e.g., for lazily created queues and buffer pools
+      scan_ref();
+      scan_val();
+      auto t_ref = measure(reps, scan_ref);
+      auto t_val = measure(reps, scan_val);
+      cout << setw(10) << n << " | "
+           << setw(11) << fixed << setprecision(3) << t_ref * 1e3 << " | "
+           << setw(8) << setprecision(1) << n / t_ref / 1e6 << " | "
+           << setw(11) << setprecision(3) << t_val * 1e3 << " | "
+           << setw(8) << setprecision(1) << n / t_val / 1e6 << endl;
+    }
+  }
+  system.await_all_actors_done();
+  return 0;
+}
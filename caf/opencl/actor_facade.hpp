@@ -20,8 +20,12 @@
 #ifndef CAF_OPENCL_ACTOR_FACADE_HPP
 #define CAF_OPENCL_ACTOR_FACADE_HPP
 
+#include <array>
+#include <mutex>
+#include <cstring>
 #include <ostream>
 #include <iostream>
+#include <typeinfo>
 #include <algorithm>
 #include <stdexcept>
 
@@ -33,8 +37,12 @@
 
 #include "caf/opencl/global.hpp"
 #include "caf/opencl/command.hpp"
+#include "caf/opencl/image.hpp"
 #include "caf/opencl/mem_ref.hpp"
+#include "caf/opencl/svm_ref.hpp"
+#include "caf/opencl/shared_span.hpp"
 #include "caf/opencl/program.hpp"
+#include "caf/opencl/host_pool.hpp"
 #include "caf/opencl/nd_range.hpp"
 #include "caf/opencl/arguments.hpp"
 #include "caf/opencl/opencl_err.hpp"
@@ -75,11 +83,27 @@ public:
 
   typename detail::il_indices<arg_types>::type indices;
 
+  using input_indices = typename detail::il_indices<input_types>::type;
+
   using evnt_vec = std::vector<cl_event>;
   using mem_vec = std::vector<detail::raw_mem_ptr>;
   using len_vec = std::vector<size_t>;
   using out_tup = typename detail::tuple_type_of<output_types>::type;
 
+  /// Index space of a single message and the default length of its buffers.
+  struct index_space {
+    nd_range range;
+    size_t length;
+  };
+
+  /// The buffer uploaded for a constant argument by the last message.
+  struct constant_state {
+    detail::raw_mem_ptr buffer;
+    detail::raw_event_ptr event;
+    optional<size_t> version;
+    std::vector<char> content; // empty if versioned
+  };
+
   const char* name() const override {
     return "OpenCL actor";
   }
@@ -88,13 +112,22 @@ public:
                       const char* kernel_name, const nd_range& range,
                       input_mapping map_args, output_mapping map_result,
                       Ts&&... xs) {
-    if (range.dimensions().empty()) {
+    // the extent of the first image argument can replace the index space
+    if (range.dimensions().empty() && !range.input()
+        && !detail::tl_exists<arg_types, is_image_arg>::value) {
       auto str = "OpenCL kernel needs at least 1 global dimension.";
       CAF_LOG_ERROR(str);
       throw std::runtime_error(str);
     }
+    if (range.input()
+        && *range.input() >= detail::tl_size<input_types>::value) {
+      auto str = "Range policy selects an input that does not exist.";
+      CAF_LOG_ERROR(str);
+      throw std::runtime_error(str);
+    }
     auto check_vec = [&](const dim_vec& vec, const char* name) {
-      if (! vec.empty() && vec.size() != range.dimensions().size()) {
+      if (! vec.empty() && ! range.dimensions().empty()
+          && vec.size() != range.dimensions().size()) {
         std::ostringstream oss;
         oss << name << " vector is not empty, but "
             << "its size differs from global dimensions vector's size";
@@ -105,23 +138,10 @@ public:
     check_vec(range.offsets(), "offsets");
     check_vec(range.local_dimensions(), "local dimensions");
     auto& sys = actor_conf.host->system();
-    auto itr = prog->available_kernels_.find(kernel_name);
-    if (itr == prog->available_kernels_.end()) {
-      detail::raw_kernel_ptr kernel;
-      kernel.reset(v2get(CAF_CLF(clCreateKernel), prog->program_.get(),
-                                 kernel_name),
-                   false);
-      return make_actor<actor_facade, actor>(sys.next_actor_id(), sys.node(),
-                                             &sys, std::move(actor_conf),
-                                             prog, kernel, range,
-                                             std::move(map_args),
-                                             std::move(map_result),
-                                             std::forward_as_tuple(xs...));
-    }
     return make_actor<actor_facade, actor>(sys.next_actor_id(), sys.node(),
                                            &sys, std::move(actor_conf),
-                                           prog, itr->second, range,
-                                           std::move(map_args),
+                                           prog, prog->kernel(kernel_name),
+                                           range, std::move(map_args),
                                            std::move(map_result),
                                            std::forward_as_tuple(xs...));
   }
@@ -130,10 +150,38 @@ public:
                message content, response_promise promise) {
     CAF_PUSH_AID(id());
     CAF_LOG_TRACE("");
-    if (!map_arguments(content))
+    if (content.match_element<resident_atom>(0)) {
+      update_resident(content, promise);
+      return;
+    }
+    // senders call this function concurrently, i.e., all state that depends
+    // on the message lives on the stack
+    index_space space{range_, default_length_};
+    if (!map_arguments(content, space.range))
+      return;
+    // mapping functions reject messages by returning an error for the sender
+    if (content.match_elements<error>()) {
+      promise.deliver(content.get_as<error>(0));
       return;
+    }
     if (!content.match_elements(input_types{})) {
       CAF_LOG_ERROR("Message types do not match the expected signature.");
+      promise.deliver(make_error(sec::unexpected_message));
+      return;
+    }
+    if (derive_range_) {
+      auto err = derive_range(content, space);
+      if (err) {
+        CAF_LOG_ERROR(CAF_ARG(err));
+        promise.deliver(std::move(err));
+        return;
+      }
+    }
+    out_tup result;
+    auto err = prepare_arguments(result, content, space, indices);
+    if (err) {
+      CAF_LOG_ERROR(CAF_ARG(err));
+      promise.deliver(std::move(err));
       return;
     }
     auto hdl = std::make_tuple(sender, mid.response_id());
@@ -142,7 +190,9 @@ public:
     mem_vec output_buffers;
     mem_vec scratch_buffers;
     len_vec result_lengths;
-    out_tup result;
+    // kernel arguments belong to the kernel object, hence binding them and
+    // launching the kernel must not interleave with other messages
+    std::unique_lock<std::mutex> guard{launch_mtx_};
     add_kernel_arguments(events,          // accumulate events for execution
                          input_buffers,   // opencl buffers included in in msg
                          output_buffers,  // opencl buffers included in out msg
@@ -150,6 +200,7 @@ public:
                          result,          // tuple to save the output values
                          result_lengths,  // size of buffers to read back
                          content,         // message content
+                         space,           // index space of this message
                          indices);        // enable extraction of types from msg
     auto cmd = make_counted<command_type>(
       std::move(promise),
@@ -161,7 +212,7 @@ public:
       std::move(result_lengths),
       std::move(content),
       std::move(result),
-      range_
+      std::move(space.range)
     );
     cmd->enqueue();
   }
@@ -193,16 +244,220 @@ public:
         range_(std::move(range)),
         map_args_(std::move(map_args)),
         map_results_(std::move(map_result)),
-        kernel_signature_(std::move(xs)) {
+        kernel_signature_(std::move(xs)),
+        pool_(prog->pool_),
+        device_(prog->device_),
+        tracker_(device_->tracker()),
+        arg_index_(sizeof...(Ts)),
+        out_fields_(detail::tl_size<output_types>::value),
+        derive_range_(range_.dimensions().empty()),
+        size_input_(range_.input()),
+        group_multiple_(1),
+        group_limit_(1),
+        resident_(sizeof...(Ts)),
+        constants_(sizeof...(Ts)) {
     CAF_LOG_TRACE(CAF_ARG(this->id()));
+    init_arguments(0, indices);
+    init_resident(indices);
+    init_constants();
+    if (size_input_)
+      init_group_limits();
     default_length_ = std::accumulate(std::begin(range_.dimensions()),
                                       std::end(range_.dimensions()),
                                       size_t{1},
                                       std::multiplies<size_t>{});
   }
 
+  /// Queries the work group limits of the kernel on the device of this actor
+  /// for ranges that follow an `input_size` policy.
+  void init_group_limits() {
+    auto query = [&](cl_uint param) {
+      return v3get<size_t>(CAF_CLF(clGetKernelWorkGroupInfo), kernel_.get(),
+                           device_->device_id_.get(),
+                           static_cast<cl_kernel_work_group_info>(param));
+    };
+    group_limit_ = std::min(query(CL_KERNEL_WORK_GROUP_SIZE),
+                            device_->max_work_group_size());
+    group_limit_ = std::min(group_limit_, device_->max_work_item_sizes()[0]);
+    group_multiple_ = query(CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE);
+    if (group_multiple_ == 0 || group_multiple_ > group_limit_)
+      group_multiple_ = 1;
+  }
+
+  /// Sets a one-dimensional index space that covers the elements of the input
+  /// selected by the range policy. The global size is rounded up to the
+  /// preferred multiple, the local size is the largest multiple of it within
+  /// the limits of the kernel that divides the global size. Returns false if
+  /// the input has no elements.
+  bool derive_range_from_input(message& msg, index_space& space) {
+    auto n = input_length(msg, *size_input_, input_indices{});
+    if (n == 0)
+      return false;
+    auto global = (n + group_multiple_ - 1) / group_multiple_ * group_multiple_;
+    auto local = group_multiple_;
+    for (auto x = group_limit_ / group_multiple_ * group_multiple_;
+         x > group_multiple_; x -= group_multiple_) {
+      if (global % x == 0) {
+        local = x;
+        break;
+      }
+    }
+    space.range = nd_range{dim_vec{global}, {}, dim_vec{local}};
+    space.length = n;
+    return true;
+  }
+
+  size_t input_length(message&, size_t, detail::int_list<>) {
+    return 0;
+  }
+
+  template <long I, long... Is>
+  size_t input_length(message& msg, size_t pos, detail::int_list<I, Is...>) {
+    using type = typename detail::tl_at<input_types, I>::type;
+    if (static_cast<size_t>(I) == pos)
+      return element_count(msg.get_as<type>(I));
+    return input_length(msg, pos, detail::int_list<Is...>{});
+  }
+
+  template <class T>
+  static size_t element_count(const std::vector<T>& xs) {
+    return xs.size();
+  }
+
+  template <class T>
+  static size_t element_count(const mem_ref<T>& ref) {
+    return ref.size();
+  }
+
+  template <class T>
+  static size_t element_count(const svm_ref<T>& ref) {
+    return ref.size();
+  }
+
+  template <class T>
+  static size_t element_count(const shared_span<T>& span) {
+    return span.size();
+  }
+
+  template <class T>
+  static size_t element_count(const T&) {
+    return 0;
+  }
+
+  /// Sets the global dimensions to the extent of the first image argument
+  /// that has one or to the length of the input selected by the range policy.
+  /// Fails if no argument defines the index space or if the offsets or local
+  /// dimensions do not match the dimensions of the image.
+  error derive_range(message& msg, index_space& space) {
+    if (size_input_) {
+      if (!derive_range_from_input(msg, space))
+        return make_error(sec::invalid_argument,
+                          "No argument defines the index space.");
+      return none;
+    }
+    dim_vec dims;
+    image_extents(dims, msg, indices);
+    if (dims.empty())
+      return make_error(sec::invalid_argument,
+                        "No argument defines the index space.");
+    auto& offsets = space.range.offsets();
+    auto& local_dims = space.range.local_dimensions();
+    if ((!offsets.empty() && offsets.size() != dims.size())
+        || (!local_dims.empty() && local_dims.size() != dims.size()))
+      return make_error(sec::invalid_argument,
+                        "Offsets or local dimensions differ from the "
+                        "dimensions of the image.");
+    space.range = nd_range{dims, offsets, local_dims};
+    space.length = std::accumulate(std::begin(dims), std::end(dims),
+                                   size_t{1}, std::multiplies<size_t>{});
+    return none;
+  }
+
+  void image_extents(dim_vec&, message&, detail::int_list<>) {
+    // end of recursion
+  }
+
+  template <long I, long... Is>
+  void image_extents(dim_vec& dims, message& msg, detail::int_list<I, Is...>) {
+    using arg_type = typename detail::tl_at<processing_list,I>::type;
+    if (!dims.empty())
+      return;
+    dims = image_extent<arg_type::in_pos>(std::get<I>(kernel_signature_), msg);
+    image_extents(dims, msg, detail::int_list<Is...>{});
+  }
+
+  template <int InPos, class T>
+  dim_vec image_extent(const image_in<T, val>&, message& msg) {
+    return msg.get_as<T>(InPos).dimensions();
+  }
+
+  template <int InPos, class T>
+  dim_vec image_extent(const image_in<T, mref>&, message& msg) {
+    return msg.get_as<image_ref<T>>(InPos).dimensions();
+  }
+
+  template <int InPos, class T, class Tag>
+  dim_vec image_extent(const image_out<T, Tag>& wrapper, message&) {
+    return wrapper.extent;
+  }
+
+  template <int InPos, class T>
+  dim_vec image_extent(const T&, message&) {
+    return {};
+  }
+
+  error prepare_arguments(out_tup&, message&, const index_space&,
+                          detail::int_list<>) {
+    return none;
+  }
+
+  /// Checks the arguments of a message before the actor binds them to the
+  /// kernel, i.e., errors reach the sender instead of aborting the launch.
+  template <long I, long... Is>
+  error prepare_arguments(out_tup& result, message& msg,
+                          const index_space& space,
+                          detail::int_list<I, Is...>) {
+    using arg_type = typename detail::tl_at<processing_list,I>::type;
+    auto err = prepare_argument<I, arg_type::in_pos, arg_type::out_pos>(
+      std::get<I>(kernel_signature_), result, msg, space
+    );
+    if (err)
+      return err;
+    return prepare_arguments(result, msg, space, detail::int_list<Is...>{});
+  }
+
+  template <long I, int InPos, int OutPos, class T>
+  error prepare_argument(const constant<T>& wrapper, out_tup&, message& msg,
+                         const index_space&) {
+    using value_type = typename detail::tl_at<unpacked_types, I>::type;
+    auto n = msg.get_as<std::vector<value_type>>(InPos).size();
+    if (n <= wrapper.max_elements)
+      return none;
+    std::ostringstream oss;
+    oss << "constant argument has " << n << " elements, but allows only "
+        << wrapper.max_elements;
+    return make_error(sec::invalid_argument, oss.str());
+  }
+
+  template <long I, int InPos, int OutPos, class T>
+  error prepare_argument(const out<T,svm>& wrapper, out_tup& result,
+                         message& msg, const index_space& space) {
+    using value_type = typename detail::tl_at<unpacked_types, I>::type;
+    auto len = argument_length(wrapper, msg, space.length);
+    auto ref = device_->template svm_argument<value_type>(len);
+    if (!ref)
+      return std::move(ref.error());
+    std::get<OutPos>(result) = std::move(*ref);
+    return none;
+  }
+
+  template <long I, int InPos, int OutPos, class T>
+  error prepare_argument(const T&, out_tup&, message&, const index_space&) {
+    return none;
+  }
+
   void add_kernel_arguments(evnt_vec&, mem_vec&, mem_vec&, mem_vec&,
-                            out_tup&, len_vec&, message&,
+                            out_tup&, len_vec&, message&, const index_space&,
                             detail::int_list<>) {
     // nop
   }
@@ -213,14 +468,15 @@ public:
   template <long I, long... Is>
   void add_kernel_arguments(evnt_vec& events, mem_vec& inputs, mem_vec& outputs,
                             mem_vec& scratch, out_tup& result, len_vec& lengths,
-                            message& msg, detail::int_list<I, Is...>) {
+                            message& msg, const index_space& space,
+                            detail::int_list<I, Is...>) {
     using arg_type = typename detail::tl_at<processing_list,I>::type;
     create_buffer<I, arg_type::in_pos, arg_type::out_pos>(
       std::get<I>(kernel_signature_), events, lengths, inputs,
-      outputs, scratch, result, msg
+      outputs, scratch, result, msg, space
     );
     add_kernel_arguments(events, inputs, outputs, scratch, result, lengths, msg,
-                         detail::int_list<Is...>{});
+                         space, detail::int_list<Is...>{});
   }
 
   // Two functions to handle `in` arguments: val and mref
@@ -228,112 +484,167 @@ public:
   template <long I, int InPos, int OutPos, class T>
   void create_buffer(const in<T, val>&, evnt_vec& events, len_vec&,
                      mem_vec& inputs, mem_vec&, mem_vec&, out_tup&,
-                     message& msg) {
+                     message& msg, const index_space&) {
     using value_type = typename detail::tl_at<unpacked_types, I>::type;
     using container_type = std::vector<value_type>;
     auto& container = msg.get_as<container_type>(InPos);
-    auto len = container.size();
-    size_t num_bytes = sizeof(value_type) * len;
-    auto buffer = v2get(CAF_CLF(clCreateBuffer), context_.get(),
-                        size_t{CL_MEM_READ_WRITE}, num_bytes, nullptr);
-    auto event = v1get<cl_event>(CAF_CLF(clEnqueueWriteBuffer),
-                                 queue_.get(), buffer, 0u, // --> CL_FALSE,
-                                 0u, num_bytes, container.data());
-    v1callcl(CAF_CLF(clSetKernelArg), kernel_.get(), static_cast<unsigned>(I),
-             sizeof(cl_mem), static_cast<const void*>(&buffer));
-    events.push_back(event);
-    inputs.emplace_back(buffer, false);
+    upload_input<I>(container.data(), container.size(), events, inputs);
   }
 
   template <long I, int InPos, int OutPos, class T>
-  void create_buffer(const in<T, mref>&, evnt_vec& events, len_vec&, mem_vec&,
-                     mem_vec&, mem_vec&, out_tup&, message& msg) {
+  void create_buffer(const in<T, shared>&, evnt_vec& events, len_vec&,
+                     mem_vec& inputs, mem_vec&, mem_vec&, out_tup&,
+                     message& msg, const index_space&) {
+    using value_type = typename detail::tl_at<unpacked_types, I>::type;
+    // the message keeps the memory alive until the upload completes
+    auto& span = msg.get_as<shared_span<value_type>>(InPos);
+    upload_input<I>(span.data(), span.size(), events, inputs);
+  }
+
+  template <long I, int InPos, int OutPos, class T>
+  void create_buffer(const in<T, mref>&, evnt_vec& events, len_vec&,
+                     mem_vec& inputs, mem_vec&, mem_vec&, out_tup&,
+                     message& msg, const index_space&) {
     using value_type = typename detail::tl_at<unpacked_types, I>::type;
     using container_type = mem_ref<value_type>;
     auto container = msg.get_as<container_type>(InPos);
-    v1callcl(CAF_CLF(clSetKernelArg), kernel_.get(), static_cast<unsigned>(I),
-             sizeof(cl_mem), static_cast<const void*>(&container.get()));
+    auto buffer = container.acquire();
+    set_kernel_arg<I>(buffer);
     auto event = container.take_event();
     if (event)
       events.push_back(event);
+    inputs.push_back(std::move(buffer));
   }
 
-  // Four functions to handle `in_out` arguments:
-  //    val->val, val->mref, mref->val, mref->mref
+  template <long I, int InPos, int OutPos, class T>
+  void create_buffer(const in<T, svm>&, evnt_vec&, len_vec&, mem_vec&,
+                     mem_vec&, mem_vec&, out_tup&, message& msg,
+                     const index_space&) {
+    using value_type = typename detail::tl_at<unpacked_types, I>::type;
+    // the message keeps the allocation alive until the command completes
+    auto& ref = msg.get_as<svm_ref<value_type>>(InPos);
+    set_svm_arg<I>(ref.data());
+  }
+
+  // Six functions to handle `in_out` arguments:
+  //    val->val, val->mref, shared->val, shared->mref, mref->val, mref->mref
 
   template <long I, int InPos, int OutPos, class T>
   void create_buffer(const in_out<T,val,val>&, evnt_vec& events,
                      len_vec& lengths, mem_vec&, mem_vec& outputs,
-                     mem_vec&, out_tup&, message& msg) {
+                     mem_vec&, out_tup& result, message& msg,
+                     const index_space&) {
     using value_type = typename detail::tl_at<unpacked_types, I>::type;
     using container_type = std::vector<value_type>;
-    auto& container = msg.get_as<container_type>(InPos);
+    // Read the results back into the input vector if no one else shares the
+    // message. Moving the vector keeps its memory in place, i.e., the pending
+    // upload below still reads from valid memory.
+    auto& out_vec = std::get<OutPos>(result);
+    if (msg.cvals()->unique())
+      out_vec = std::move(msg.get_mutable_as<container_type>(InPos));
+    auto& container = out_vec.empty() ? msg.get_as<container_type>(InPos)
+                                      : out_vec;
     auto len = container.size();
     size_t num_bytes = sizeof(value_type) * len;
-    auto buffer = v2get(CAF_CLF(clCreateBuffer), context_.get(),
-                        size_t{CL_MEM_READ_WRITE}, num_bytes, nullptr);
+    auto buffer = allocate(num_bytes, CL_MEM_READ_WRITE, mem_kind::output);
     auto event = v1get<cl_event>(CAF_CLF(clEnqueueWriteBuffer),
-                                 queue_.get(), buffer, 0u, // --> CL_FALSE,
+                                 queue_.get(), buffer.get(), 0u, // --> CL_FALSE,
                                  0u, num_bytes, container.data());
-    v1callcl(CAF_CLF(clSetKernelArg), kernel_.get(), static_cast<unsigned>(I),
-             sizeof(cl_mem), static_cast<const void*>(&buffer));
+    set_kernel_arg<I>(buffer);
     lengths.push_back(len);
     events.push_back(event);
-    outputs.emplace_back(buffer, false);
+    outputs.push_back(std::move(buffer));
   }
 
   template <long I, int InPos, int OutPos, class T>
   void create_buffer(const in_out<T,val,mref>&, evnt_vec& events, len_vec&,
-                     mem_vec&, mem_vec&, mem_vec&, out_tup& result,
-                     message& msg) {
+                     mem_vec& inputs, mem_vec&, mem_vec&, out_tup& result,
+                     message& msg, const index_space&) {
     using value_type = typename detail::tl_at<unpacked_types, I>::type;
     using container_type = std::vector<value_type>;
     auto& container = msg.get_as<container_type>(InPos);
     auto len = container.size();
     size_t num_bytes = sizeof(value_type) * len;
-    auto buffer = v2get(CAF_CLF(clCreateBuffer), context_.get(),
-                        size_t{CL_MEM_READ_WRITE}, num_bytes, nullptr);
+    auto buffer = allocate(num_bytes, CL_MEM_READ_WRITE, mem_kind::reference);
     auto event = v1get<cl_event>(CAF_CLF(clEnqueueWriteBuffer),
-                                 queue_.get(), buffer, 0u, // --> CL_FALSE,
+                                 queue_.get(), buffer.get(), 0u, // --> CL_FALSE,
                                  0u, num_bytes, container.data());
-    v1callcl(CAF_CLF(clSetKernelArg), kernel_.get(), static_cast<unsigned>(I),
-             sizeof(cl_mem), static_cast<const void*>(&buffer));
+    set_kernel_arg<I>(buffer);
     events.push_back(event);
-    std::get<OutPos>(result) = mem_ref<value_type>{
-      len, queue_, detail::raw_mem_ptr{buffer, false},
-      size_t{CL_MEM_READ_WRITE | CL_MEM_HOST_READ_ONLY}, nullptr
-    };
+    std::get<OutPos>(result) = make_mem_ref<value_type>(
+      len, buffer, CL_MEM_READ_WRITE | CL_MEM_HOST_READ_ONLY
+    );
+    inputs.push_back(std::move(buffer));
+  }
+
+  template <long I, int InPos, int OutPos, class T>
+  void create_buffer(const in_out<T,shared,val>&, evnt_vec& events,
+                     len_vec& lengths, mem_vec&, mem_vec& outputs,
+                     mem_vec&, out_tup&, message& msg, const index_space&) {
+    using value_type = typename detail::tl_at<unpacked_types, I>::type;
+    auto& span = msg.get_as<shared_span<value_type>>(InPos);
+    auto len = span.size();
+    size_t num_bytes = sizeof(value_type) * len;
+    auto buffer = allocate(num_bytes, CL_MEM_READ_WRITE, mem_kind::output);
+    auto event = v1get<cl_event>(CAF_CLF(clEnqueueWriteBuffer),
+                                 queue_.get(), buffer.get(), 0u, // --> CL_FALSE,
+                                 0u, num_bytes, span.data());
+    set_kernel_arg<I>(buffer);
+    lengths.push_back(len);
+    events.push_back(event);
+    outputs.push_back(std::move(buffer));
+  }
+
+  template <long I, int InPos, int OutPos, class T>
+  void create_buffer(const in_out<T,shared,mref>&, evnt_vec& events, len_vec&,
+                     mem_vec& inputs, mem_vec&, mem_vec&, out_tup& result,
+                     message& msg, const index_space&) {
+    using value_type = typename detail::tl_at<unpacked_types, I>::type;
+    auto& span = msg.get_as<shared_span<value_type>>(InPos);
+    auto len = span.size();
+    size_t num_bytes = sizeof(value_type) * len;
+    auto buffer = allocate(num_bytes, CL_MEM_READ_WRITE, mem_kind::reference);
+    auto event = v1get<cl_event>(CAF_CLF(clEnqueueWriteBuffer),
+                                 queue_.get(), buffer.get(), 0u, // --> CL_FALSE,
+                                 0u, num_bytes, span.data());
+    set_kernel_arg<I>(buffer);
+    events.push_back(event);
+    std::get<OutPos>(result) = make_mem_ref<value_type>(
+      len, buffer, CL_MEM_READ_WRITE | CL_MEM_HOST_READ_ONLY
+    );
+    inputs.push_back(std::move(buffer));
   }
 
   template <long I, int InPos, int OutPos, class T>
   void create_buffer(const in_out<T,mref,val>&, evnt_vec& events,
                      len_vec& lengths, mem_vec&, mem_vec& outputs,
-                     mem_vec&, out_tup&, message& msg) {
+                     mem_vec&, out_tup&, message& msg, const index_space&) {
     using value_type = typename detail::tl_at<unpacked_types, I>::type;
     using container_type = mem_ref<value_type>;
     auto container = msg.get_as<container_type>(InPos);
-    v1callcl(CAF_CLF(clSetKernelArg), kernel_.get(), static_cast<unsigned>(I),
-             sizeof(cl_mem), static_cast<const void*>(&container.get()));
+    auto buffer = container.acquire();
+    set_kernel_arg<I>(buffer);
     auto event = container.take_event();
     if (event)
       events.push_back(event);
     lengths.push_back(container.size());
-    outputs.push_back(container.get());
+    outputs.push_back(std::move(buffer));
   }
 
   template <long I, int InPos, int OutPos, class T>
   void create_buffer(const in_out<T,mref,mref>&, evnt_vec& events, len_vec&,
-                     mem_vec&, mem_vec&, mem_vec&, out_tup& result,
-                     message& msg) {
+                     mem_vec& inputs, mem_vec&, mem_vec&, out_tup& result,
+                     message& msg, const index_space&) {
     using value_type = typename detail::tl_at<unpacked_types, I>::type;
     using container_type = mem_ref<value_type>;
     auto container = msg.get_as<container_type>(InPos);
-    v1callcl(CAF_CLF(clSetKernelArg), kernel_.get(), static_cast<unsigned>(I),
-                     sizeof(cl_mem), static_cast<const void*>(&container.get()));
+    auto buffer = container.acquire();
+    set_kernel_arg<I>(buffer);
     auto event = container.take_event();
     if (event)
       events.push_back(event);
     std::get<OutPos>(result) = container;
+    inputs.push_back(std::move(buffer));
   }
 
   // Two functions to handle `out` arguments: val and mref
@@ -341,35 +652,231 @@ public:
   template <long I, int InPos, int OutPos, class T>
   void create_buffer(const out<T,val>& wrapper, evnt_vec&, len_vec& lengths,
                      mem_vec&, mem_vec& outputs, mem_vec&, out_tup&,
-                     message& msg) {
+                     message& msg, const index_space& space) {
     using value_type = typename detail::tl_at<unpacked_types, I>::type;
-    auto len = argument_length(wrapper, msg, default_length_);
+    auto len = argument_length(wrapper, msg, space.length);
     auto num_bytes = sizeof(value_type) * len;
-    auto buffer = v2get(CAF_CLF(clCreateBuffer), context_.get(),
-                        size_t{CL_MEM_READ_WRITE | CL_MEM_HOST_READ_ONLY},
-                        num_bytes, nullptr);
-    v1callcl(CAF_CLF(clSetKernelArg), kernel_.get(), static_cast<unsigned>(I),
-             sizeof(cl_mem), static_cast<const void*>(&buffer));
-    outputs.emplace_back(buffer, false);
+    auto buffer = allocate(num_bytes,
+                           CL_MEM_READ_WRITE | CL_MEM_HOST_READ_ONLY,
+                           mem_kind::output);
+    set_kernel_arg<I>(buffer);
+    outputs.push_back(std::move(buffer));
     lengths.push_back(len);
   }
 
   template <long I, int InPos, int OutPos, class T>
   void create_buffer(const out<T,mref>& wrapper, evnt_vec&, len_vec&,
-                     mem_vec&, mem_vec&, mem_vec&, out_tup& result,
-                     message& msg) {
+                     mem_vec& inputs, mem_vec&, mem_vec&, out_tup& result,
+                     message& msg, const index_space& space) {
     using value_type = typename detail::tl_at<unpacked_types, I>::type;
-    auto len = argument_length(wrapper, msg, default_length_);
+    auto len = argument_length(wrapper, msg, space.length);
     auto num_bytes = sizeof(value_type) * len;
-    auto buffer = v2get(CAF_CLF(clCreateBuffer), context_.get(),
-                        size_t{CL_MEM_READ_WRITE | CL_MEM_HOST_READ_ONLY},
-                        num_bytes, nullptr);
-    v1callcl(CAF_CLF(clSetKernelArg), kernel_.get(), static_cast<unsigned>(I),
-             sizeof(cl_mem), static_cast<const void*>(&buffer));
-    std::get<OutPos>(result) = mem_ref<value_type>{
-      len, queue_, {buffer, false},
-      size_t{CL_MEM_READ_WRITE | CL_MEM_HOST_READ_ONLY}, nullptr
-    };
+    auto buffer = allocate(num_bytes,
+                           CL_MEM_READ_WRITE | CL_MEM_HOST_READ_ONLY,
+                           mem_kind::reference);
+    set_kernel_arg<I>(buffer);
+    std::get<OutPos>(result) = make_mem_ref<value_type>(
+      len, buffer, CL_MEM_READ_WRITE | CL_MEM_HOST_READ_ONLY
+    );
+    inputs.push_back(std::move(buffer));
+  }
+
+  template <long I, int InPos, int OutPos, class T>
+  void create_buffer(const out<T,svm>&, evnt_vec&, len_vec&,
+                     mem_vec&, mem_vec&, mem_vec&, out_tup& result,
+                     message&, const index_space&) {
+    // prepare_argument allocated the result
+    set_svm_arg<I>(std::get<OutPos>(result).data());
+  }
+
+  template <long I, int InPos, int OutPos, class T>
+  void create_buffer(const in_out<T,svm,svm>&, evnt_vec&, len_vec&,
+                     mem_vec&, mem_vec&, mem_vec&, out_tup& result,
+                     message& msg, const index_space&) {
+    using value_type = typename detail::tl_at<unpacked_types, I>::type;
+    // kernels update the allocation in place
+    auto& ref = msg.get_as<svm_ref<value_type>>(InPos);
+    set_svm_arg<I>(ref.data());
+    std::get<OutPos>(result) = ref;
+  }
+
+  // Three functions to handle structure of arrays arguments
+
+  template <long I, int InPos, int OutPos, class T>
+  void create_buffer(const soa_in<T>& wrapper, evnt_vec& events, len_vec&,
+                     mem_vec& inputs, mem_vec&, mem_vec&, out_tup&,
+                     message& msg, const index_space&) {
+    auto& container = msg.get_as<std::vector<T>>(InPos);
+    upload_fields<I>(wrapper.fields, container, mem_kind::input, events,
+                     inputs);
+  }
+
+  template <long I, int InPos, int OutPos, class T>
+  void create_buffer(const soa_in_out<T>& wrapper, evnt_vec& events,
+                     len_vec& lengths, mem_vec&, mem_vec& outputs,
+                     mem_vec&, out_tup& result, message& msg,
+                     const index_space&) {
+    using container_type = std::vector<T>;
+    // reads the fields back into the input vector, see in_out<T,val,val>
+    auto& out_vec = std::get<OutPos>(result);
+    if (msg.cvals()->unique())
+      out_vec = std::move(msg.get_mutable_as<container_type>(InPos));
+    else
+      out_vec = msg.get_as<container_type>(InPos);
+    upload_fields<I>(wrapper.fields, out_vec, mem_kind::output, events,
+                     outputs);
+    lengths.insert(lengths.end(), wrapper.fields.size(), out_vec.size());
+  }
+
+  template <long I, int InPos, int OutPos, class T>
+  void create_buffer(const soa_out<T>& wrapper, evnt_vec&, len_vec& lengths,
+                     mem_vec&, mem_vec& outputs, mem_vec&, out_tup&,
+                     message& msg, const index_space& space) {
+    auto len = argument_length(wrapper, msg, space.length);
+    for (size_t i = 0; i < wrapper.fields.size(); ++i) {
+      auto buffer = allocate(wrapper.fields[i].size * len,
+                             CL_MEM_READ_WRITE | CL_MEM_HOST_READ_ONLY,
+                             mem_kind::output);
+      set_kernel_arg(arg_index_[I] + static_cast<cl_uint>(i), buffer);
+      outputs.push_back(std::move(buffer));
+    }
+    lengths.insert(lengths.end(), wrapper.fields.size(), len);
+  }
+
+  // One function to handle `resident` arguments
+
+  template <long I, int InPos, int OutPos, class T>
+  void create_buffer(const resident<T>&, evnt_vec& events, len_vec&,
+                     mem_vec& inputs, mem_vec&, mem_vec&, out_tup&,
+                     message&, const index_space&) {
+    using value_type = typename detail::tl_at<unpacked_types, I>::type;
+    mem_ref<value_type> ref;
+    { // lifetime scope of guard
+      std::unique_lock<std::mutex> guard{resident_mtx_};
+      ref = resident_[I].get_as<mem_ref<value_type>>(0);
+    }
+    auto buffer = ref.acquire();
+    set_kernel_arg<I>(buffer);
+    // all kernels wait for the latest upload, the command releases its copy
+    auto event = ref.event();
+    if (event) {
+      v1callcl(CAF_CLF(clRetainEvent), event.get());
+      events.push_back(event.get());
+    }
+    inputs.push_back(std::move(buffer));
+  }
+
+  template <long I, int InPos, int OutPos, class T>
+  void create_buffer(const constant<T>& wrapper, evnt_vec& events, len_vec&,
+                     mem_vec& inputs, mem_vec&, mem_vec&, out_tup&,
+                     message& msg, const index_space&) {
+    using value_type = typename detail::tl_at<unpacked_types, I>::type;
+    using container_type = std::vector<value_type>;
+    auto& container = msg.get_as<container_type>(InPos);
+    auto version = wrapper.version(msg);
+    auto data = reinterpret_cast<const char*>(container.data());
+    size_t num_bytes = sizeof(value_type) * container.size();
+    detail::raw_mem_ptr buffer;
+    detail::raw_event_ptr event;
+    { // lifetime scope of guard
+      std::unique_lock<std::mutex> guard{constants_mtx_};
+      auto& st = constants_[I];
+      auto unchanged = version ? st.version && *st.version == *version
+                               : !st.version && st.content.size() == num_bytes
+                                 && std::memcmp(st.content.data(), data,
+                                                num_bytes) == 0;
+      if (!st.buffer || !unchanged) {
+        // running kernels may still read the previous buffer
+        st.buffer = allocate(num_bytes, CL_MEM_READ_ONLY, mem_kind::cached);
+        st.event.reset(v1get<cl_event>(CAF_CLF(clEnqueueWriteBuffer),
+                                       queue_.get(), st.buffer.get(), 0u,
+                                       0u, num_bytes, container.data()),
+                       false);
+        st.version = version;
+        if (version)
+          st.content.clear();
+        else
+          st.content.assign(data, data + num_bytes);
+      }
+      buffer = st.buffer;
+      event = st.event;
+    }
+    set_kernel_arg<I>(buffer);
+    // the command releases its own reference to the upload event
+    v1callcl(CAF_CLF(clRetainEvent), event.get());
+    events.push_back(event.get());
+    inputs.push_back(std::move(buffer));
+  }
+
+  // Four functions to handle image arguments: in and out, val and mref
+
+  template <long I, int InPos, int OutPos, class T>
+  void create_buffer(const image_in<T, val>& wrapper, evnt_vec& events,
+                     len_vec&, mem_vec& inputs, mem_vec&, mem_vec&, out_tup&,
+                     message& msg, const index_space&) {
+    using value_type = typename T::value_type;
+    auto& img = msg.get_as<T>(InPos);
+    auto buffer = allocate_image<T>(wrapper.format, img.width(), img.height(),
+                                    img.depth(), CL_MEM_READ_ONLY,
+                                    mem_kind::input);
+    // the pitches let the driver skip the padding of the host image
+    size_t origin[] = {0, 0, 0};
+    size_t region[] = {img.width(), img.height(), img.depth()};
+    size_t slice_pitch = T::num_dimensions == 3
+                         ? img.slice_pitch() * sizeof(value_type)
+                         : 0;
+    auto event = v1get<cl_event>(CAF_CLF(clEnqueueWriteImage),
+                                 queue_.get(), buffer.get(), cl_bool{0},
+                                 origin, region,
+                                 img.row_pitch() * sizeof(value_type),
+                                 slice_pitch, img.data().data());
+    set_kernel_arg<I>(buffer);
+    events.push_back(event);
+    inputs.push_back(std::move(buffer));
+  }
+
+  template <long I, int InPos, int OutPos, class T>
+  void create_buffer(const image_in<T, mref>&, evnt_vec& events, len_vec&,
+                     mem_vec& inputs, mem_vec&, mem_vec&, out_tup&,
+                     message& msg, const index_space&) {
+    auto ref = msg.get_as<image_ref<T>>(InPos);
+    auto buffer = ref.get();
+    set_kernel_arg<I>(buffer);
+    auto event = ref.take_event();
+    if (event)
+      events.push_back(event);
+    inputs.push_back(std::move(buffer));
+  }
+
+  template <long I, int InPos, int OutPos, class T>
+  void create_buffer(const image_out<T, val>& wrapper, evnt_vec&,
+                     len_vec& lengths, mem_vec&, mem_vec& outputs, mem_vec&,
+                     out_tup& result, message&,
+                     const index_space& space) {
+    auto extent = output_extent(wrapper, space);
+    auto buffer = allocate_image<T>(wrapper.format, extent[0], extent[1],
+                                    extent[2],
+                                    CL_MEM_WRITE_ONLY | CL_MEM_HOST_READ_ONLY,
+                                    mem_kind::output);
+    set_kernel_arg<I>(buffer);
+    // the command reads the image back into this host image
+    std::get<OutPos>(result) = T{extent[0], extent[1], extent[2]};
+    outputs.push_back(std::move(buffer));
+    lengths.push_back(extent[0] * extent[1] * extent[2]);
+  }
+
+  template <long I, int InPos, int OutPos, class T>
+  void create_buffer(const image_out<T, mref>& wrapper, evnt_vec&, len_vec&,
+                     mem_vec& inputs, mem_vec&, mem_vec&, out_tup& result,
+                     message&, const index_space& space) {
+    auto extent = output_extent(wrapper, space);
+    cl_mem_flags flags = CL_MEM_READ_WRITE | CL_MEM_HOST_READ_ONLY;
+    auto buffer = allocate_image<T>(wrapper.format, extent[0], extent[1],
+                                    extent[2], flags, mem_kind::reference);
+    set_kernel_arg<I>(buffer);
+    std::get<OutPos>(result) = image_ref<T>{extent[0], extent[1], extent[2],
+                                            queue_, buffer, flags, nullptr};
+    inputs.push_back(std::move(buffer));
   }
 
   // One function to handle `scratch` buffers
@@ -377,16 +884,15 @@ public:
   template <long I, int InPos, int OutPos, class T>
   void create_buffer(const scratch<T>& wrapper, evnt_vec&, len_vec&,
                      mem_vec&, mem_vec&, mem_vec& scratch,
-                     out_tup&, message& msg) {
+                     out_tup&, message& msg, const index_space& space) {
     using value_type = typename detail::tl_at<unpacked_types, I>::type;
-    auto len = argument_length(wrapper, msg, default_length_);
+    auto len = argument_length(wrapper, msg, space.length);
     auto num_bytes = sizeof(value_type) * len;
-    auto buffer = v2get(CAF_CLF(clCreateBuffer), context_.get(),
-                        size_t{CL_MEM_READ_WRITE | CL_MEM_HOST_NO_ACCESS},
-                        num_bytes, nullptr);
-    v1callcl(CAF_CLF(clSetKernelArg), kernel_.get(), static_cast<unsigned>(I),
-             sizeof(cl_mem), static_cast<const void*>(&buffer));
-    scratch.emplace_back(buffer, false);
+    auto buffer = allocate(num_bytes,
+                           CL_MEM_READ_WRITE | CL_MEM_HOST_NO_ACCESS,
+                           mem_kind::scratch);
+    set_kernel_arg<I>(buffer);
+    scratch.push_back(std::move(buffer));
   }
 
   // One functions to handle `local` arguments
@@ -394,35 +900,450 @@ public:
   template <long I, int InPos, int OutPos, class T>
   void create_buffer(const local<T>& wrapper, evnt_vec&, len_vec&,
                      mem_vec&, mem_vec&, mem_vec&, out_tup&,
-                     message& msg) {
+                     message& msg, const index_space&) {
     using value_type = typename detail::tl_at<unpacked_types, I>::type;
     auto len = wrapper(msg);
     auto num_bytes = sizeof(value_type) * len;
-    v1callcl(CAF_CLF(clSetKernelArg), kernel_.get(), static_cast<unsigned>(I),
+    v1callcl(CAF_CLF(clSetKernelArg), kernel_.get(), arg_index_[I],
              num_bytes, nullptr);
   }
 
-  // Two functions to handle `priv` arguments: val and hidden
+  // Three functions to handle `priv` arguments: val, hidden and elements
 
   template <long I, int InPos, int OutPos, class T>
   void create_buffer(const priv<T, val>&, evnt_vec&, len_vec&,
-                     mem_vec&, mem_vec&, mem_vec&, out_tup&, message& msg) {
+                     mem_vec&, mem_vec&, mem_vec&, out_tup&, message& msg,
+                     const index_space&) {
     using value_type = typename detail::tl_at<unpacked_types, I>::type;
     auto value_size = sizeof(value_type);
     auto& value = msg.get_as<value_type>(InPos);
-    v1callcl(CAF_CLF(clSetKernelArg), kernel_.get(), static_cast<unsigned>(I),
+    v1callcl(CAF_CLF(clSetKernelArg), kernel_.get(), arg_index_[I],
              value_size, static_cast<const void*>(&value));
   }
 
   template <long I, int InPos, int OutPos, class T>
   void create_buffer(const priv<T, hidden>& wrapper, evnt_vec&, len_vec&,
-                     mem_vec&, mem_vec&, mem_vec&, out_tup&, message& msg) {
+                     mem_vec&, mem_vec&, mem_vec&, out_tup&, message& msg,
+                     const index_space&) {
     auto value_size = sizeof(T);
     auto value = wrapper(msg);
-    v1callcl(CAF_CLF(clSetKernelArg), kernel_.get(), static_cast<unsigned>(I),
+    v1callcl(CAF_CLF(clSetKernelArg), kernel_.get(), arg_index_[I],
              value_size, static_cast<const void*>(&value));
   }
 
+  template <long I, int InPos, int OutPos, class T>
+  void create_buffer(const priv<T, elements>&, evnt_vec&, len_vec&,
+                     mem_vec&, mem_vec&, mem_vec&, out_tup&, message&,
+                     const index_space& space) {
+    auto value = static_cast<T>(space.length);
+    v1callcl(CAF_CLF(clSetKernelArg), kernel_.get(), arg_index_[I],
+             sizeof(T), static_cast<const void*>(&value));
+  }
+
+  /// Allocates a buffer on the device of this actor, accounted as `kind`.
+  detail::raw_mem_ptr allocate(size_t num_bytes, cl_mem_flags flags,
+                               mem_kind kind) {
+    return tracker_->allocate(context_.get(), flags, num_bytes, kind);
+  }
+
+  /// Allocates an image of pixels in `format` on the device of this actor,
+  /// accounted as `kind`.
+  template <class T>
+  detail::raw_mem_ptr allocate_image(const cl_image_format& format,
+                                     size_t width, size_t height, size_t depth,
+                                     cl_mem_flags flags, mem_kind kind) {
+    cl_image_desc desc;
+    std::memset(&desc, 0, sizeof(desc));
+    desc.image_type = T::num_dimensions == 2 ? CL_MEM_OBJECT_IMAGE2D
+                                             : CL_MEM_OBJECT_IMAGE3D;
+    desc.image_width = width;
+    desc.image_height = height;
+    desc.image_depth = depth;
+    auto bytes = detail::image_element_size(format) * width * height * depth;
+    return tracker_->allocate_image(context_.get(), flags, format, desc, bytes,
+                                    kind);
+  }
+
+  /// Returns width, height and depth of an output image, which defaults to
+  /// the global dimensions of the index space.
+  template <class T, class Tag>
+  std::array<size_t, 3> output_extent(const image_out<T, Tag>& wrapper,
+                                      const index_space& space) {
+    auto& dims = wrapper.extent.empty() ? space.range.dimensions()
+                                        : wrapper.extent;
+    std::array<size_t, 3> result{{1, 1, 1}};
+    auto n = std::min(dims.size(), T::num_dimensions);
+    std::copy(dims.begin(), dims.begin() + n, result.begin());
+    return result;
+  }
+
+  /// Wraps a buffer written by the kernel into a mem_ref that stays on the
+  /// device until the command recycles `buffer`.
+  template <class T>
+  mem_ref<T> make_mem_ref(size_t len, const detail::raw_mem_ptr& buffer,
+                          cl_mem_flags flags) {
+    return device_->make_mem_ref<T>(len, buffer, flags, nullptr, 1);
+  }
+
+  /// Binds `buffer` to the kernel argument of the argument wrapper `I`.
+  template <long I>
+  void set_kernel_arg(const detail::raw_mem_ptr& buffer) {
+    set_kernel_arg(arg_index_[I], buffer);
+  }
+
+  /// Binds an address in shared virtual memory to the kernel argument of the
+  /// argument wrapper `I`.
+  template <long I>
+  void set_svm_arg(const void* ptr) {
+#ifdef CL_VERSION_2_0
+    v1callcl(CAF_CLF(clSetKernelArgSVMPointer), kernel_.get(), arg_index_[I],
+             ptr);
+#else
+    static_cast<void>(ptr);
+    throw std::runtime_error("Shared virtual memory requires OpenCL 2.0.");
+#endif
+  }
+
+  /// Binds `buffer` to the kernel argument at `index`.
+  void set_kernel_arg(cl_uint index, const detail::raw_mem_ptr& buffer) {
+    auto mem = buffer.get();
+    v1callcl(CAF_CLF(clSetKernelArg), kernel_.get(), index,
+             sizeof(cl_mem), static_cast<const void*>(&mem));
+  }
+
+  /// Uploads `len` elements at `data` for the `in` argument of wrapper `I`,
+  /// using the upload cache if enabled. The memory must remain valid until
+  /// the command completes.
+  template <long I, class V>
+  void upload_input(const V* data, size_t len, evnt_vec& events,
+                    mem_vec& inputs) {
+    size_t num_bytes = sizeof(V) * len;
+    auto& cache = device_->upload_cache();
+    if (cache->admits(num_bytes)) {
+      upload_cached<I>(typeid(V).hash_code(), data, num_bytes, events,
+                       inputs);
+      return;
+    }
+    auto buffer = allocate(num_bytes, CL_MEM_READ_WRITE, mem_kind::input);
+    auto event = v1get<cl_event>(CAF_CLF(clEnqueueWriteBuffer),
+                                 queue_.get(), buffer.get(), 0u, // --> CL_FALSE,
+                                 0u, num_bytes, data);
+    set_kernel_arg<I>(buffer);
+    events.push_back(event);
+    inputs.push_back(std::move(buffer));
+  }
+
+  /// Binds the read-only buffer of the upload cache holding `bytes` of
+  /// `data` to the argument of wrapper `I`, uploading and caching a new
+  /// buffer on a miss.
+  template <long I>
+  void upload_cached(size_t type, const void* data, size_t bytes,
+                     evnt_vec& events, mem_vec& inputs) {
+    auto& cache = device_->upload_cache();
+    detail::raw_event_ptr event;
+    auto buffer = cache->lookup(type, data, bytes, event);
+    if (!buffer) {
+      buffer = allocate(bytes, CL_MEM_READ_ONLY, mem_kind::cached);
+      event.reset(v1get<cl_event>(CAF_CLF(clEnqueueWriteBuffer),
+                                  queue_.get(), buffer.get(), 0u,
+                                  0u, bytes, data),
+                  false);
+      cache->insert(type, data, bytes, buffer, event);
+    }
+    set_kernel_arg<I>(buffer);
+    // the command releases its own reference to the upload event
+    if (event) {
+      v1callcl(CAF_CLF(clRetainEvent), event.get());
+      events.push_back(event.get());
+    }
+    inputs.push_back(std::move(buffer));
+  }
+
+  /// Uploads the given fields of `xs` into one buffer per field, bound to
+  /// consecutive kernel arguments starting at the argument of wrapper `I`.
+  template <long I, class T>
+  void upload_fields(const std::vector<detail::soa_field>& fields,
+                     const std::vector<T>& xs, mem_kind kind,
+                     evnt_vec& events, mem_vec& buffers) {
+    size_t buffer_origin[] = {0, 0, 0};
+    for (size_t i = 0; i < fields.size(); ++i) {
+      auto& field = fields[i];
+      auto buffer = allocate(field.size * xs.size(), CL_MEM_READ_WRITE, kind);
+      if (!xs.empty()) {
+        // strided copy from the array of structs into a packed buffer
+        size_t host_origin[] = {field.offset, 0, 0};
+        size_t region[] = {field.size, xs.size(), 1};
+        auto event = v1get<cl_event>(CAF_CLF(clEnqueueWriteBufferRect),
+                                     queue_.get(), buffer.get(), cl_bool{0},
+                                     buffer_origin, host_origin, region,
+                                     field.size, size_t{0}, sizeof(T),
+                                     size_t{0}, xs.data());
+        events.push_back(event);
+      }
+      set_kernel_arg(arg_index_[I] + static_cast<cl_uint>(i), buffer);
+      buffers.push_back(std::move(buffer));
+    }
+  }
+
+  /// Uploads `xs` into a new buffer without blocking. The message `owner`
+  /// keeps `xs` alive until the transfer completes.
+  template <class T>
+  mem_ref<T> upload_resident(const std::vector<T>& xs, message owner) {
+    if (xs.empty())
+      throw std::runtime_error("Resident arguments require at least one "
+                               "element.");
+    auto ref = device_->global_argument(xs);
+    auto keep = new message(std::move(owner));
+    auto cb = [](cl_event, cl_int, void* data) {
+      delete reinterpret_cast<message*>(data);
+    };
+    auto err = clSetEventCallback(ref.event().get(), CL_COMPLETE, cb, keep);
+    if (err != CL_SUCCESS) {
+      delete keep;
+      throwcl("clSetEventCallback", err);
+    }
+    return ref;
+  }
+
+  // Uploads or binds the initial data of all resident arguments.
+
+  void init_resident(detail::int_list<>) {
+    // end of recursion
+  }
+
+  template <long I, long... Is>
+  void init_resident(detail::int_list<I, Is...>) {
+    init_resident_arg<I>(std::get<I>(kernel_signature_));
+    init_resident(detail::int_list<Is...>{});
+  }
+
+  template <long I, class T>
+  void init_resident_arg(resident<T>& wrapper) {
+    if (wrapper.values.empty()) {
+      if (wrapper.ref.size() == 0)
+        throw std::runtime_error("Resident arguments require data.");
+      resident_[I] = make_message(wrapper.ref);
+      return;
+    }
+    // the actor no longer needs the values once they reside on the device
+    auto owner = make_message(std::move(wrapper.values));
+    auto& xs = owner.get_as<std::vector<T>>(0);
+    resident_[I] = make_message(upload_resident(xs, owner));
+  }
+
+  template <long I, class T>
+  void init_resident_arg(T&) {
+    // not a resident argument
+  }
+
+  /// Checks the constant arguments against the limits of the device.
+  void init_constants() {
+    auto n = detail::tl_count<arg_types, is_constant_arg>::value;
+    if (n > device_->max_constant_args()) {
+      std::ostringstream oss;
+      oss << "kernel has " << n << " constant arguments, but the device"
+          << " supports only " << device_->max_constant_args();
+      CAF_LOG_ERROR(CAF_ARG(oss.str()));
+      throw std::runtime_error(oss.str());
+    }
+    init_constants(indices);
+  }
+
+  void init_constants(detail::int_list<>) {
+    // end of recursion
+  }
+
+  template <long I, long... Is>
+  void init_constants(detail::int_list<I, Is...>) {
+    init_constant(std::get<I>(kernel_signature_));
+    init_constants(detail::int_list<Is...>{});
+  }
+
+  /// Bounds the number of elements of a constant argument by the constant
+  /// buffer size of the device, which also applies to tables without a
+  /// declared maximum.
+  template <class T>
+  void init_constant(constant<T>& wrapper) {
+    auto limit = static_cast<size_t>(device_->max_constant_buffer_size())
+                 / sizeof(T);
+    if (wrapper.max_elements == 0) {
+      wrapper.max_elements = limit;
+    } else if (wrapper.max_elements > limit) {
+      std::ostringstream oss;
+      oss << "constant argument of " << sizeof(T) * wrapper.max_elements
+          << " bytes exceeds the constant buffer size of "
+          << device_->max_constant_buffer_size() << " bytes";
+      CAF_LOG_ERROR(CAF_ARG(oss.str()));
+      throw std::runtime_error(oss.str());
+    }
+  }
+
+  template <class T>
+  void init_constant(const T&) {
+    // not a constant argument
+  }
+
+  // Replaces the data of a resident argument and responds with `ok_atom`.
+
+  void update_resident(message& msg, response_promise& rp) {
+    size_t pos = 0;
+    if (msg.size() == 3 && msg.match_element<size_t>(1)
+        && update_resident(msg.get_as<size_t>(1), pos, msg, indices))
+      rp.deliver(ok_atom::value);
+    else
+      rp.deliver(make_error(sec::unexpected_message));
+  }
+
+  bool update_resident(size_t, size_t&, message&, detail::int_list<>) {
+    return false;
+  }
+
+  template <long I, long... Is>
+  bool update_resident(size_t n, size_t& pos, message& msg,
+                       detail::int_list<I, Is...>) {
+    return update_resident_arg<I>(std::get<I>(kernel_signature_), n, pos, msg)
+           || update_resident(n, pos, msg, detail::int_list<Is...>{});
+  }
+
+  template <long I, class T>
+  bool update_resident_arg(const resident<T>&, size_t n, size_t& pos,
+                           message& msg) {
+    using value_type = typename detail::tl_at<unpacked_types, I>::type;
+    if (pos++ != n)
+      return false;
+    mem_ref<value_type> ref;
+    if (msg.match_element<std::vector<value_type>>(2)) {
+      auto& xs = msg.get_as<std::vector<value_type>>(2);
+      if (xs.empty())
+        return false;
+      ref = upload_resident(xs, msg);
+    } else if (msg.match_element<mem_ref<value_type>>(2)) {
+      ref = msg.get_as<mem_ref<value_type>>(2);
+    } else {
+      return false;
+    }
+    std::unique_lock<std::mutex> guard{resident_mtx_};
+    resident_[I] = make_message(std::move(ref));
+    return true;
+  }
+
+  template <long I, class T>
+  bool update_resident_arg(const T&, size_t, size_t&, message&) {
+    return false;
+  }
+
+  /// Returns the fields of the output at `pos` if the kernel writes it as
+  /// structure of arrays, `nullptr` otherwise.
+  const std::vector<detail::soa_field>* output_fields(size_t pos) const {
+    return out_fields_[pos];
+  }
+
+  // Computes the index of the first kernel argument for each wrapper and
+  // collects the fields of outputs passed as structure of arrays.
+
+  void init_arguments(cl_uint, detail::int_list<>) {
+    // end of recursion
+  }
+
+  template <long I, long... Is>
+  void init_arguments(cl_uint pos, detail::int_list<I, Is...>) {
+    using arg_type = typename detail::tl_at<processing_list,I>::type;
+    auto& wrapper = std::get<I>(kernel_signature_);
+    arg_index_[I] = pos;
+    if (arg_type::out_pos >= 0)
+      out_fields_[static_cast<size_t>(arg_type::out_pos)] = fields_of(wrapper);
+    init_arguments(pos + static_cast<cl_uint>(kernel_args(wrapper)),
+                   detail::int_list<Is...>{});
+  }
+
+  template <class T>
+  static size_t kernel_args(const T& wrapper) {
+    auto fields = fields_of(wrapper);
+    return fields ? fields->size() : 1;
+  }
+
+  template <class T>
+  static const std::vector<detail::soa_field>* fields_of(const T& wrapper) {
+    return fields_of(wrapper, std::is_base_of<detail::soa_tag, T>{});
+  }
+
+  template <class T>
+  static const std::vector<detail::soa_field>* fields_of(const T& wrapper,
+                                                         std::true_type) {
+    return &wrapper.fields;
+  }
+
+  template <class T>
+  static const std::vector<detail::soa_field>* fields_of(const T&,
+                                                         std::false_type) {
+    return nullptr;
+  }
+
+  /// Returns the buffers of a finished command to the pool of idle buffers.
+  /// Buffers owned by `mem_ref`s become spillable again instead.
+  void recycle_buffers(mem_vec& buffers) {
+    for (auto& buf : buffers)
+      if (!tracker_->recycle(buf))
+        recycle_foreign(buf);
+    buffers.clear();
+  }
+
+  /// Returns a buffer allocated by another device of the context, e.g., for
+  /// a `mem_ref`, to the tracker of that device.
+  void recycle_foreign(detail::raw_mem_ptr& buf) {
+    for (auto& peer : device_->context_->trackers())
+      if (peer != tracker_ && peer->recycle(buf))
+        return;
+  }
+
+  /// Hands the host vectors of `val` inputs to the pool once a command no
+  /// longer needs them. Messages shared with other actors remain untouched.
+  void recycle_inputs(message& msg) {
+    if (!pool_ || msg.empty() || !msg.cvals()->unique())
+      return;
+    recycle_inputs(msg, indices);
+  }
+
+  void recycle_inputs(message&, detail::int_list<>) {
+    // end of recursion
+  }
+
+  template <long I, long... Is>
+  void recycle_inputs(message& msg, detail::int_list<I, Is...>) {
+    using arg_type = typename detail::tl_at<processing_list,I>::type;
+    recycle_input<I, arg_type::in_pos>(std::get<I>(kernel_signature_), msg);
+    recycle_inputs(msg, detail::int_list<Is...>{});
+  }
+
+  template <long I, int InPos, class T>
+  void recycle_input(const in<T, val>&, message& msg) {
+    using value_type = typename detail::tl_at<unpacked_types, I>::type;
+    using container_type = std::vector<value_type>;
+    pool_->give(std::move(msg.get_mutable_as<container_type>(InPos)));
+  }
+
+  template <long I, int InPos, class T, class TagOut>
+  void recycle_input(const in_out<T, val, TagOut>&, message& msg) {
+    using value_type = typename detail::tl_at<unpacked_types, I>::type;
+    using container_type = std::vector<value_type>;
+    pool_->give(std::move(msg.get_mutable_as<container_type>(InPos)));
+  }
+
+  template <long I, int InPos, class T>
+  void recycle_input(const constant<T>&, message& msg) {
+    pool_->give(std::move(msg.get_mutable_as<std::vector<T>>(InPos)));
+  }
+
+  template <long I, int InPos, class T>
+  void recycle_input(const soa_in<T>&, message& msg) {
+    pool_->give(std::move(msg.get_mutable_as<std::vector<T>>(InPos)));
+  }
+
+  template <long I, int InPos, class T>
+  void recycle_input(const T&, message&) {
+    // nothing to recycle
+  }
+
   /// Helper function to calculate the elements in a buffer from in and out
   /// argument wrappers.
   template <class Fun>
@@ -433,7 +1354,7 @@ public:
 
   // Map function requires only the message as argument
   template <bool Q = PassConfig>
-  detail::enable_if_t<!Q, bool> map_arguments(message& content) {
+  detail::enable_if_t<!Q, bool> map_arguments(message& content, nd_range&) {
     if (map_args_) {
       auto mapped = map_args_(content);
       if (!mapped) {
@@ -447,9 +1368,10 @@ public:
 
   // Map function requires reference to config as well as the message
   template <bool Q = PassConfig>
-  detail::enable_if_t<Q, bool> map_arguments(message& content) {
+  detail::enable_if_t<Q, bool> map_arguments(message& content,
+                                             nd_range& range) {
     if (map_args_) {
-      auto mapped = map_args_(range_, content);
+      auto mapped = map_args_(range, content);
       if (!mapped) {
         CAF_LOG_ERROR("Mapping argumentes failed.");
         return false;
@@ -468,6 +1390,20 @@ public:
   output_mapping map_results_;
   std::tuple<Ts...> kernel_signature_;
   size_t default_length_;
+  host_pool_ptr pool_;
+  device_ptr device_;
+  detail::mem_tracker_ptr tracker_;
+  std::vector<cl_uint> arg_index_;
+  std::vector<const std::vector<detail::soa_field>*> out_fields_;
+  bool derive_range_;
+  std::mutex launch_mtx_;
+  optional<size_t> size_input_; // input that defines the index space
+  size_t group_multiple_;
+  size_t group_limit_;
+  std::mutex resident_mtx_;
+  std::vector<message> resident_; // holds a mem_ref per resident argument
+  std::mutex constants_mtx_;
+  std::vector<constant_state> constants_;
 };
 
 } // namespace opencl
@@ -22,5 +22,18 @@
 #define CAF_OPENCL_ALL_HPP
 
 #include "caf/opencl/manager.hpp"
+#include "caf/opencl/compact.hpp"
+#include "caf/opencl/gemm.hpp"
+#include "caf/opencl/half.hpp"
+#include "caf/opencl/histogram.hpp"
+#include "caf/opencl/image.hpp"
+#include "caf/opencl/program_family.hpp"
+#include "caf/opencl/radix_sort.hpp"
+#include "caf/opencl/reduce.hpp"
+#include "caf/opencl/scan.hpp"
+#include "caf/opencl/shared_span.hpp"
+#include "caf/opencl/svm_ref.hpp"
+#include "caf/opencl/variant_facade.hpp"
+#include "caf/opencl/vector_types.hpp"
 
 #endif // CAF_OPENCL_ALL_HPP
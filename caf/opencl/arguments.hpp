@@ -21,13 +21,19 @@
 #ifndef CAF_OPENCL_ARGUMENTS
 #define CAF_OPENCL_ARGUMENTS
 
+#include <vector>
+#include <stdexcept>
 #include <functional>
 #include <type_traits>
 
+#include "caf/atom.hpp"
 #include "caf/message.hpp"
 #include "caf/optional.hpp"
 
+#include "caf/opencl/image.hpp"
 #include "caf/opencl/mem_ref.hpp"
+#include "caf/opencl/svm_ref.hpp"
+#include "caf/opencl/shared_span.hpp"
 #include "caf/opencl/detail/core.hpp"
 
 namespace caf {
@@ -58,6 +64,53 @@ T try_apply_fun(F& fun, message& msg, const T& fallback) {
   return fallback;
 }
 
+/// Location of a field within a struct, in bytes.
+struct soa_field {
+  size_t offset;
+  size_t size;
+};
+
+template <class Struct, class T>
+soa_field make_soa_field(T Struct::* member) {
+  Struct tmp;
+  auto first = reinterpret_cast<const char*>(&tmp);
+  auto field = reinterpret_cast<const char*>(&(tmp.*member));
+  return {static_cast<size_t>(field - first), sizeof(T)};
+}
+
+/// Tags arguments passed as structure of arrays.
+struct soa_tag {};
+
+/// Fields of an argument passed as structure of arrays.
+template <class Struct>
+struct soa_fields : soa_tag {
+  template <class... Ts>
+  soa_fields(Ts Struct::*... members)
+      : fields{detail::make_soa_field(members)...} {
+    static_assert(std::is_trivial<Struct>::value,
+                  "Structure of arrays arguments require trivial types.");
+    static_assert(sizeof...(Ts) > 0,
+                  "Structure of arrays arguments require at least one field.");
+  }
+  std::vector<soa_field> fields;
+};
+
+/// Tags image arguments.
+struct image_tag {};
+
+/// Format of an image argument with pixels of type `T`.
+template <class T>
+struct image_arg : image_tag {
+  image_arg() : format(make_image_format<T>()) {
+    // nop
+  }
+  image_arg(cl_image_format fmt) : format(fmt) {
+    if (image_element_size(format) != sizeof(T))
+      throw std::runtime_error("Image format does not match the pixel type.");
+  }
+  cl_image_format format;
+};
+
 } // namespace detail
 
 // Tag classes to mark arguments received in a messages as reference or value
@@ -69,10 +122,25 @@ struct val {};
 /// by other opencl actors.
 struct mref {};
 
+/// Arguments tagged as `svm` are expected as svm_ref, which shares its
+/// addresses between host and device. Requires an OpenCL 2.0 device.
+struct svm {};
+
+/// Arguments tagged as `shared` are expected as shared_span, an immutable
+/// host buffer that messages share without copying. Only available for
+/// inputs.
+struct shared {};
+
 /// Arguments tagged as `hidden` are created by the actor, using the config
 /// passed in the argument wrapper. Only available for local and priv arguments.
 struct hidden {};
 
+/// Arguments tagged as `elements` are hidden private arguments that the actor
+/// sets to the number of elements the index space covers, i.e., the length of
+/// the input selected by an `input_size` range. Only available for priv
+/// arguments.
+struct elements {};
+
 /// Use as a default way to calculate output size. 0 will be set to the number
 /// of work items at runtime.
 struct dummy_size_calculator {
@@ -103,8 +171,11 @@ struct is_ref_tag;
 /// Mark a spawn argument as input only
 template <class Arg, class Tag = val>
 struct in : arg_tag, input_tag {
-  static_assert(std::is_same<Tag, val>::value || std::is_same<Tag, mref>::value,
-                "Argument of type `in` must be passed as value or mem_ref.");
+  static_assert(std::is_same<Tag, val>::value || std::is_same<Tag, mref>::value
+                || std::is_same<Tag, svm>::value
+                || std::is_same<Tag, shared>::value,
+                "Argument of type `in` must be passed as value, mem_ref, "
+                "svm_ref or shared_span.");
   using tag_type = Tag;
   using arg_type = detail::decay_t<Arg>;
 };
@@ -113,12 +184,20 @@ struct in : arg_tag, input_tag {
 template <class Arg, class TagIn = val, class TagOut = val>
 struct in_out : arg_tag, input_tag, output_tag {
   static_assert(
-    std::is_same<TagIn, val>::value || std::is_same<TagIn, mref>::value,
-    "Argument of type `in_out` must be passed as value or mem_ref."
+    std::is_same<TagIn, val>::value || std::is_same<TagIn, mref>::value
+    || std::is_same<TagIn, svm>::value || std::is_same<TagIn, shared>::value,
+    "Argument of type `in_out` must be passed as value, mem_ref, svm_ref or "
+    "shared_span."
+  );
+  static_assert(
+    std::is_same<TagOut, val>::value || std::is_same<TagOut, mref>::value
+    || std::is_same<TagOut, svm>::value,
+    "Argument of type `in_out` must be returned as value, mem_ref or svm_ref."
   );
   static_assert(
-    std::is_same<TagOut, val>::value || std::is_same<TagOut, mref>::value,
-    "Argument of type `in_out` must be returned as value or mem_ref."
+    std::is_same<TagIn, svm>::value == std::is_same<TagOut, svm>::value,
+    "Argument of type `in_out` must be passed and returned as svm_ref if "
+    "either is an svm_ref."
   );
   using tag_in_type = TagIn;
   using tag_out_type = TagOut;
@@ -128,8 +207,10 @@ struct in_out : arg_tag, input_tag, output_tag {
 /// Mark a spawn argument as output only
 template <class Arg, class Tag = val>
 struct out : arg_tag, output_tag, requires_size_tag {
-  static_assert(std::is_same<Tag, val>::value || std::is_same<Tag, mref>::value,
-               "Argument of type `out` must be returned as value or mem_ref.");
+  static_assert(std::is_same<Tag, val>::value || std::is_same<Tag, mref>::value
+                || std::is_same<Tag, svm>::value,
+                "Argument of type `out` must be returned as value, mem_ref or "
+                "svm_ref.");
   using tag_type = Tag;
   using arg_type = detail::decay_t<Arg>;
   out() = default;
@@ -186,8 +267,10 @@ template <class Arg, class Tag = hidden>
 struct priv : arg_tag, std::conditional<std::is_same<Tag, val>::value,
                                         input_tag, empty_tag>::type {
   static_assert(std::is_same<Tag, val>::value ||
-                std::is_same<Tag, hidden>::value,
-               "Argument of type `priv` must be either a value or hidden.");
+                std::is_same<Tag, hidden>::value ||
+                std::is_same<Tag, elements>::value,
+               "Argument of type `priv` must be either a value, hidden or "
+               "elements.");
   using tag_type = Tag;
   using arg_type = detail::decay_t<Arg>;
   priv() = default;
@@ -209,6 +292,164 @@ struct priv : arg_tag, std::conditional<std::is_same<Tag, val>::value,
   std::function<optional<Arg> (message&)> fun_;
 };
 
+/// Mark a spawn argument as input that arrives as `std::vector<Struct>` and
+/// is passed as structure of arrays, i.e., each of the given fields binds one
+/// buffer to consecutive kernel arguments. Unlisted fields are not uploaded.
+template <class Struct>
+struct soa_in : arg_tag, input_tag, detail::soa_fields<Struct> {
+  using arg_type = Struct;
+  template <class... Ts>
+  soa_in(Ts Struct::*... members) : detail::soa_fields<Struct>(members...) {
+    // nop
+  }
+};
+
+/// Mark a spawn argument as input and output passed as structure of arrays.
+/// The results overwrite the given fields of the input vector and leave all
+/// other fields untouched.
+template <class Struct>
+struct soa_in_out : arg_tag, input_tag, output_tag,
+                    detail::soa_fields<Struct> {
+  using arg_type = Struct;
+  template <class... Ts>
+  soa_in_out(Ts Struct::*... members)
+      : detail::soa_fields<Struct>(members...) {
+    // nop
+  }
+};
+
+/// Mark a spawn argument as output passed as structure of arrays, i.e., the
+/// kernel writes one buffer per field and the actor assembles them into a
+/// `std::vector<Struct>`. Unlisted fields are value-initialized.
+template <class Struct>
+struct soa_out : arg_tag, output_tag, requires_size_tag,
+                 detail::soa_fields<Struct> {
+  using arg_type = Struct;
+  template <class... Ts>
+  soa_out(Ts Struct::*... members) : detail::soa_fields<Struct>(members...) {
+    // nop
+  }
+  template <class F, class... Ts,
+            class = detail::enable_if_t<!std::is_member_pointer<F>::value
+                                        && !std::is_same<F, soa_out>::value>>
+  soa_out(F fun, Ts Struct::*... members)
+      : detail::soa_fields<Struct>(members...),
+        fun_{detail::res_or_none<size_t>(fun)} {
+    // nop
+  }
+  optional<size_t> operator()(message& msg) const {
+    return detail::try_apply_fun(fun_, msg, 0UL);
+  }
+  std::function<optional<size_t> (message&)> fun_;
+};
+
+/// Replaces the data of a resident argument, see `resident`.
+using resident_atom = atom_constant<atom("resident")>;
+
+/// Mark a spawn argument as resident on the device. The actor uploads the
+/// values once when it is spawned, or uses the buffer of an existing
+/// `mem_ref`, and binds it for every message. Hence, resident arguments are
+/// not part of the expected message. The message
+/// `(resident_atom, n, std::vector<Arg>)` or `(resident_atom, n, mem_ref<Arg>)`
+/// replaces the data of the `n`-th resident argument and responds with
+/// `ok_atom`. Uploads do not block and subsequent kernels wait for them.
+template <class Arg>
+struct resident : arg_tag {
+  using arg_type = detail::decay_t<Arg>;
+  resident(std::vector<arg_type> xs) : values(std::move(xs)) {
+    // nop
+  }
+  resident(mem_ref<arg_type> x) : ref(std::move(x)) {
+    // nop
+  }
+  std::vector<arg_type> values;
+  mem_ref<arg_type> ref;
+};
+
+/// Mark a spawn argument as a small read-only table in constant memory,
+/// i.e., a `constant Arg*` kernel parameter. The table arrives as
+/// `std::vector<Arg>` with at most `max_elements` elements, which the actor
+/// checks against the limits of the device when it is spawned. A maximum of
+/// 0 selects the constant buffer size of the device. Larger tables receive
+/// `sec::invalid_argument`. The actor keeps the buffer of the last message
+/// and skips the upload if the content did not change. An optional function computes a version from the message
+/// instead, in which case the actor uploads only if the version changes.
+template <class Arg>
+struct constant : arg_tag, input_tag {
+  using arg_type = detail::decay_t<Arg>;
+  constant(size_t max_elements = 0) : max_elements(max_elements) {
+    // nop
+  }
+  template <class F>
+  constant(size_t max_elements, F fun)
+      : max_elements(max_elements),
+        fun_{detail::res_or_none<size_t>(fun)} {
+    // nop
+  }
+  optional<size_t> version(message& msg) const {
+    if (fun_)
+      return fun_(msg);
+    return none;
+  }
+  size_t max_elements;
+  std::function<optional<size_t> (message&)> fun_;
+};
+
+/// Mark a spawn argument as an image the kernel reads, i.e., a `read_only`
+/// `image2d_t` or `image3d_t`. Images use the texture path of the device,
+/// which caches 2D and 3D neighborhoods. The argument arrives as `Image` or
+/// as `image_ref<Image>` if tagged as `mref`. An optional format overrides
+/// the default channel order and type of the pixel type.
+template <class Image, class Tag = val>
+struct image_in : arg_tag, input_tag,
+                  detail::image_arg<typename Image::value_type> {
+  static_assert(std::is_same<Tag, val>::value || std::is_same<Tag, mref>::value,
+                "Argument of type `image_in` must be passed as value or "
+                "image_ref.");
+  using tag_type = Tag;
+  using arg_type = Image;
+  image_in() = default;
+  image_in(cl_image_format fmt)
+      : detail::image_arg<typename Image::value_type>(fmt) {
+    // nop
+  }
+};
+
+/// Mark a spawn argument as an image the kernel writes, i.e., a `write_only`
+/// `image2d_t` or `image3d_t`. Without explicit extent, the image has the
+/// global dimensions of the index space. The result is sent as `Image` or as
+/// `image_ref<Image>` if tagged as `mref`.
+template <class Image, class Tag = val>
+struct image_out : arg_tag, output_tag,
+                   detail::image_arg<typename Image::value_type> {
+  static_assert(std::is_same<Tag, val>::value || std::is_same<Tag, mref>::value,
+                "Argument of type `image_out` must be returned as value or "
+                "image_ref.");
+  using tag_type = Tag;
+  using arg_type = Image;
+  image_out() = default;
+  image_out(cl_image_format fmt)
+      : detail::image_arg<typename Image::value_type>(fmt) {
+    // nop
+  }
+  image_out(size_t width, size_t height, size_t depth = 1)
+      : extent(make_extent(width, height, depth)) {
+    // nop
+  }
+  image_out(cl_image_format fmt, size_t width, size_t height,
+            size_t depth = 1)
+      : detail::image_arg<typename Image::value_type>(fmt),
+        extent(make_extent(width, height, depth)) {
+    // nop
+  }
+  static dim_vec make_extent(size_t width, size_t height, size_t depth) {
+    if (Image::num_dimensions == 2)
+      return {width, height};
+    return {width, height, depth};
+  }
+  dim_vec extent;
+};
+
 ///Cconverts C arrays, i.e., pointers, to vectors.
 template <class T>
 struct carr_to_vec {
@@ -236,6 +477,17 @@ struct is_output_arg : std::is_base_of<output_tag, T> {};
 template <class T>
 struct requires_size_arg : std::is_base_of<requires_size_tag, T> {};
 
+/// Filter type lists for constant memory arguments
+template <class T>
+struct is_constant_arg : std::false_type {};
+
+template <class T>
+struct is_constant_arg<constant<T>> : std::true_type {};
+
+/// Filter type lists for image arguments
+template <class T>
+struct is_image_arg : std::is_base_of<detail::image_tag, T> {};
+
 /// Filter mem_refs
 template <class T>
 struct is_ref_type : std::is_base_of<is_ref_tag, T> {};
@@ -278,6 +530,41 @@ struct extract_type<priv<T, Tag>> {
   using type = detail::decay_t<typename carr_to_vec<T>::type>;
 };
 
+template <class T>
+struct extract_type<soa_in<T>> {
+  using type = T;
+};
+
+template <class T>
+struct extract_type<soa_in_out<T>> {
+  using type = T;
+};
+
+template <class T>
+struct extract_type<soa_out<T>> {
+  using type = T;
+};
+
+template <class T>
+struct extract_type<resident<T>> {
+  using type = detail::decay_t<T>;
+};
+
+template <class T>
+struct extract_type<constant<T>> {
+  using type = detail::decay_t<T>;
+};
+
+template <class T, class Tag>
+struct extract_type<image_in<T, Tag>> {
+  using type = T;
+};
+
+template <class T, class Tag>
+struct extract_type<image_out<T, Tag>> {
+  using type = T;
+};
+
 /// extract type expected in an incoming message
 template <class T>
 struct extract_input_type { };
@@ -292,6 +579,16 @@ struct extract_input_type<in<Arg, mref>> {
   using type = opencl::mem_ref<Arg>;
 };
 
+template <class Arg>
+struct extract_input_type<in<Arg, svm>> {
+  using type = opencl::svm_ref<Arg>;
+};
+
+template <class Arg>
+struct extract_input_type<in<Arg, shared>> {
+  using type = opencl::shared_span<Arg>;
+};
+
 template <class Arg, class TagOut>
 struct extract_input_type<in_out<Arg, val, TagOut>> {
   using type = std::vector<Arg>;
@@ -302,11 +599,46 @@ struct extract_input_type<in_out<Arg, mref, TagOut>> {
   using type = opencl::mem_ref<Arg>;
 };
 
+template <class Arg, class TagOut>
+struct extract_input_type<in_out<Arg, svm, TagOut>> {
+  using type = opencl::svm_ref<Arg>;
+};
+
+template <class Arg, class TagOut>
+struct extract_input_type<in_out<Arg, shared, TagOut>> {
+  using type = opencl::shared_span<Arg>;
+};
+
 template <class Arg>
 struct extract_input_type<priv<Arg,val>> {
   using type = Arg;
 };
 
+template <class Arg>
+struct extract_input_type<soa_in<Arg>> {
+  using type = std::vector<Arg>;
+};
+
+template <class Arg>
+struct extract_input_type<soa_in_out<Arg>> {
+  using type = std::vector<Arg>;
+};
+
+template <class Arg>
+struct extract_input_type<constant<Arg>> {
+  using type = std::vector<Arg>;
+};
+
+template <class Arg>
+struct extract_input_type<image_in<Arg, val>> {
+  using type = Arg;
+};
+
+template <class Arg>
+struct extract_input_type<image_in<Arg, mref>> {
+  using type = opencl::image_ref<Arg>;
+};
+
 /// extract type sent in an outgoing message
 template <class T>
 struct extract_output_type { };
@@ -321,6 +653,11 @@ struct extract_output_type<out<Arg, mref>> {
   using type = opencl::mem_ref<Arg>;
 };
 
+template <class Arg>
+struct extract_output_type<out<Arg, svm>> {
+  using type = opencl::svm_ref<Arg>;
+};
+
 template <class Arg, class TagIn>
 struct extract_output_type<in_out<Arg, TagIn, val>> {
   using type = std::vector<Arg>;
@@ -331,6 +668,31 @@ struct extract_output_type<in_out<Arg, TagIn, mref>> {
   using type = opencl::mem_ref<Arg>;
 };
 
+template <class Arg, class TagIn>
+struct extract_output_type<in_out<Arg, TagIn, svm>> {
+  using type = opencl::svm_ref<Arg>;
+};
+
+template <class Arg>
+struct extract_output_type<soa_in_out<Arg>> {
+  using type = std::vector<Arg>;
+};
+
+template <class Arg>
+struct extract_output_type<soa_out<Arg>> {
+  using type = std::vector<Arg>;
+};
+
+template <class Arg>
+struct extract_output_type<image_out<Arg, val>> {
+  using type = Arg;
+};
+
+template <class Arg>
+struct extract_output_type<image_out<Arg, mref>> {
+  using type = opencl::image_ref<Arg>;
+};
+
 /// extract input tag
 template <class T>
 struct extract_input_tag { };
@@ -350,6 +712,26 @@ struct extract_input_tag<priv<Arg,val>> {
   using tag = val;
 };
 
+template <class Arg>
+struct extract_input_tag<soa_in<Arg>> {
+  using tag = val;
+};
+
+template <class Arg>
+struct extract_input_tag<soa_in_out<Arg>> {
+  using tag = val;
+};
+
+template <class Arg>
+struct extract_input_tag<constant<Arg>> {
+  using tag = val;
+};
+
+template <class Arg, class Tag>
+struct extract_input_tag<image_in<Arg, Tag>> {
+  using tag = Tag;
+};
+
 /// extract output tag
 template <class T>
 struct extract_output_tag { };
@@ -364,6 +746,20 @@ struct extract_output_tag<in_out<Arg, TagIn, TagOut>> {
   using tag = TagOut;
 };
 
+template <class Arg>
+struct extract_output_tag<soa_in_out<Arg>> {
+  using tag = val;
+};
+
+template <class Arg>
+struct extract_output_tag<soa_out<Arg>> {
+  using tag = val;
+};
+
+template <class Arg, class Tag>
+struct extract_output_tag<image_out<Arg, Tag>> {
+  using tag = Tag;
+};
 
 /// Create the return message from tuple arumgent
 struct message_from_results {
@@ -398,6 +794,24 @@ struct out_index_of<Counter, out<Arg,Tag>> {
   static constexpr int next = Counter + 1;
 };
 
+template <int Counter, class Arg>
+struct out_index_of<Counter, soa_in_out<Arg>> {
+  static constexpr int value = Counter;
+  static constexpr int next = Counter + 1;
+};
+
+template <int Counter, class Arg>
+struct out_index_of<Counter, soa_out<Arg>> {
+  static constexpr int value = Counter;
+  static constexpr int next = Counter + 1;
+};
+
+template <int Counter, class Arg, class Tag>
+struct out_index_of<Counter, image_out<Arg,Tag>> {
+  static constexpr int value = Counter;
+  static constexpr int next = Counter + 1;
+};
+
 // index in input message
 template <int Counter, class Arg>
 struct in_index_of {
@@ -423,6 +837,29 @@ struct in_index_of<Counter, priv<Arg,val>> {
   static constexpr int next = Counter + 1;
 };
 
+template <int Counter, class Arg>
+struct in_index_of<Counter, soa_in<Arg>> {
+  static constexpr int value = Counter;
+  static constexpr int next = Counter + 1;
+};
+
+template <int Counter, class Arg>
+struct in_index_of<Counter, soa_in_out<Arg>> {
+  static constexpr int value = Counter;
+  static constexpr int next = Counter + 1;
+};
+
+template <int Counter, class Arg>
+struct in_index_of<Counter, constant<Arg>> {
+  static constexpr int value = Counter;
+  static constexpr int next = Counter + 1;
+};
+
+template <int Counter, class Arg, class Tag>
+struct in_index_of<Counter, image_in<Arg,Tag>> {
+  static constexpr int value = Counter;
+  static constexpr int next = Counter + 1;
+};
 
 template <int In, int Out, class T>
 struct cl_arg_info {
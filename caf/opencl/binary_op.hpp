@@ -0,0 +1,70 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_BINARY_OP_HPP
+#define CAF_OPENCL_BINARY_OP_HPP
+
+#include <string>
+
+#include "caf/opencl/detail/cl_type.hpp"
+
+namespace caf {
+namespace opencl {
+
+/// An associative operator for device-side algorithms, given as OpenCL C
+/// expression over the operands `a` and `b` together with its identity.
+struct binary_op {
+  std::string expression;
+  std::string identity;
+
+  static binary_op plus() {
+    return {"a + b", "0"};
+  }
+
+  static binary_op multiplies() {
+    return {"a * b", "1"};
+  }
+
+  template <class T>
+  static binary_op minimum() {
+    return {"min(a, b)", detail::cl_type<T>::highest()};
+  }
+
+  template <class T>
+  static binary_op maximum() {
+    return {"max(a, b)", detail::cl_type<T>::lowest()};
+  }
+};
+
+namespace detail {
+
+/// Returns OpenCL C code defining `IDENTITY` and a function `op` combining
+/// two values of type `T`, which the including source must define.
+inline std::string op_source(const binary_op& op) {
+  std::string result = "#define IDENTITY (" + op.identity + ")\n";
+  result += "T op(T a, T b) {\n  return " + op.expression + ";\n}\n";
+  return result;
+}
+
+} // namespace detail
+
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_BINARY_OP_HPP
@@ -33,6 +33,7 @@
 
 #include "caf/detail/scope_guard.hpp"
 
+#include "caf/opencl/image.hpp"
 #include "caf/opencl/global.hpp"
 #include "caf/opencl/nd_range.hpp"
 #include "caf/opencl/arguments.hpp"
@@ -77,6 +78,13 @@ public:
   }
 
   ~command() override {
+    auto parent = static_cast<Actor*>(actor_cast<abstract_actor*>(cl_actor_));
+    if (parent) {
+      parent->recycle_inputs(msg_);
+      parent->recycle_buffers(input_buffers_);
+      parent->recycle_buffers(output_buffers_);
+      parent->recycle_buffers(scratch_buffers_);
+    }
     for (auto& e : mem_in_events_) {
       if (e)
         v1callcl(CAF_CLF(clReleaseEvent), e);
@@ -191,13 +199,27 @@ private:
   void enqueue_read(std::vector<T>&, std::vector<cl_event>& events,
                     size_t& pos) {
     auto p = static_cast<Actor*>(actor_cast<abstract_actor*>(cl_actor_));
-    events.emplace_back();
     auto size = lengths_[pos];
     auto buffer_size = sizeof(T) * size;
-    std::get<I>(results_).resize(size);
+    // `in_out` arguments may already carry their input vector as storage
+    auto& result = std::get<I>(results_);
+    auto fields = p->output_fields(I);
+    if (result.size() != size) {
+      if (p->pool_)
+        result = p->pool_->template take<T>(size);
+      else
+        result.resize(size);
+      if (fields)
+        std::fill(result.begin(), result.end(), T{});
+    }
+    if (fields) {
+      enqueue_read_fields(*fields, result, events, pos);
+      return;
+    }
+    events.emplace_back();
     auto err = clEnqueueReadBuffer(p->queue_.get(), output_buffers_[pos].get(),
                                    CL_FALSE, 0, buffer_size,
-                                   std::get<I>(results_).data(), 1,
+                                   result.data(), 1,
                                    events.data(), &events.back());
     if (err != CL_SUCCESS) {
       this->deref(); // failed to enqueue command
@@ -206,11 +228,70 @@ private:
     pos += 1;
   }
 
+  // scatters one buffer per field into the array of structs `result`
+  template <class T>
+  void enqueue_read_fields(const std::vector<detail::soa_field>& fields,
+                           std::vector<T>& result,
+                           std::vector<cl_event>& events, size_t& pos) {
+    auto p = static_cast<Actor*>(actor_cast<abstract_actor*>(cl_actor_));
+    size_t buffer_origin[] = {0, 0, 0};
+    for (auto& field : fields) {
+      if (result.empty()) {
+        pos += 1;
+        continue;
+      }
+      events.emplace_back();
+      size_t host_origin[] = {field.offset, 0, 0};
+      size_t region[] = {field.size, result.size(), 1};
+      auto err = clEnqueueReadBufferRect(p->queue_.get(),
+                                         output_buffers_[pos].get(), CL_FALSE,
+                                         buffer_origin, host_origin, region,
+                                         field.size, 0, sizeof(T), 0,
+                                         result.data(), 1, events.data(),
+                                         &events.back());
+      if (err != CL_SUCCESS) {
+        this->deref(); // failed to enqueue command
+        throw std::runtime_error("clEnqueueReadBufferRect: "
+                                 + opencl_error(err));
+      }
+      pos += 1;
+    }
+  }
+
+  template <long I, class T, size_t Dims>
+  void enqueue_read(image<T, Dims>& result, std::vector<cl_event>& events,
+                    size_t& pos) {
+    auto p = static_cast<Actor*>(actor_cast<abstract_actor*>(cl_actor_));
+    // the actor allocates the result with the extent of the image
+    size_t origin[] = {0, 0, 0};
+    size_t region[] = {result.width(), result.height(), result.depth()};
+    events.emplace_back();
+    auto err = clEnqueueReadImage(p->queue_.get(), output_buffers_[pos].get(),
+                                  CL_FALSE, origin, region, 0, 0,
+                                  result.data().data(), 1, events.data(),
+                                  &events.back());
+    if (err != CL_SUCCESS) {
+      this->deref(); // failed to enqueue command
+      throw std::runtime_error("clEnqueueReadImage: " + opencl_error(err));
+    }
+    pos += 1;
+  }
+
   template <long I, class T>
   void enqueue_read(mem_ref<T>&, std::vector<cl_event>&, size_t&) {
     // Nothing to read back if we return references.
   }
 
+  template <long I, class Image>
+  void enqueue_read(image_ref<Image>&, std::vector<cl_event>&, size_t&) {
+    // Nothing to read back if we return references.
+  }
+
+  template <long I, class T>
+  void enqueue_read(svm_ref<T>&, std::vector<cl_event>&, size_t&) {
+    // The host shares the memory with the device.
+  }
+
   void enqueue_read_buffers(size_t&, std::vector<cl_event>&,
                             detail::int_list<>) {
     // end of recursion
@@ -0,0 +1,223 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+
+#ifndef CAF_OPENCL_COMPACT_HPP
+#define CAF_OPENCL_COMPACT_HPP
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <type_traits>
+
+#include "caf/actor_system.hpp"
+#include "caf/event_based_actor.hpp"
+
+#include "caf/opencl/scan.hpp"
+#include "caf/opencl/device.hpp"
+#include "caf/opencl/manager.hpp"
+#include "caf/opencl/mem_ref.hpp"
+#include "caf/opencl/nd_range.hpp"
+#include "caf/opencl/arguments.hpp"
+
+#include "caf/opencl/detail/cl_type.hpp"
+#include "caf/opencl/detail/group_size.hpp"
+
+namespace caf {
+namespace opencl {
+
+namespace detail {
+
+/// Returns the source of the compaction kernels for the type `T` defined in
+/// the `prelude`, keeping elements `x` for which `predicate` holds.
+std::string compact_source(const std::string& prelude,
+                           const std::string& predicate);
+
+/// Coordinates the kernels of a compaction. The first kernel flags the
+/// elements to keep, an inclusive scan of the flags yields the position of
+/// each kept element and its last element the number of kept elements. The
+/// last kernel moves the kept elements to an output of exactly this size.
+template <class T, class TagIn, class TagOut>
+class compact_actor : public event_based_actor {
+public:
+  using ref = mem_ref<T>;
+  using uref = mem_ref<cl_uint>;
+  using vec = std::vector<T>;
+  using input_type = typename std::conditional<
+    std::is_same<TagIn, val>::value, vec, ref
+  >::type;
+  using output_type = typename std::conditional<
+    std::is_same<TagOut, val>::value, vec, ref
+  >::type;
+
+  compact_actor(actor_config& cfg, device_ptr dev, actor flags, actor scan,
+                actor count, actor scatter)
+      : event_based_actor(cfg),
+        dev_(std::move(dev)),
+        flags_(std::move(flags)),
+        scan_(std::move(scan)),
+        count_(std::move(count)),
+        scatter_(std::move(scatter)) {
+    // nop
+  }
+
+  const char* name() const override {
+    return "OpenCL compaction";
+  }
+
+  behavior make_behavior() override {
+    return {
+      [=](input_type& xs) {
+        auto rp = this->make_response_promise();
+        auto n = static_cast<cl_uint>(xs.size());
+        if (n == 0) {
+          rp.deliver(output_type{});
+          return;
+        }
+        compact(upload(xs), n, rp);
+      }
+    };
+  }
+
+private:
+  ref upload(vec& xs) {
+    return dev_->global_argument(xs);
+  }
+
+  ref upload(ref& xs) {
+    return std::move(xs);
+  }
+
+  void compact(ref data, cl_uint n, response_promise rp) {
+    auto on_error = [=](error& err) mutable {
+      rp.deliver(std::move(err));
+    };
+    this->request(flags_, infinite, data, n).then(
+      [=](uref& flags) mutable {
+        this->request(scan_, infinite, std::move(flags)).then(
+          [=](uref& positions) mutable {
+            this->request(count_, infinite, positions, n).then(
+              [=](cl_uint count) mutable {
+                if (count == 0) {
+                  rp.deliver(output_type{});
+                  return;
+                }
+                this->request(scatter_, infinite, std::move(data),
+                              std::move(positions), n, count).then(
+                  [=](output_type& result) mutable {
+                    rp.deliver(std::move(result));
+                  },
+                  on_error
+                );
+              },
+              on_error
+            );
+          },
+          on_error
+        );
+      },
+      on_error
+    );
+  }
+
+  device_ptr dev_;
+  actor flags_;
+  actor scan_;
+  actor count_;
+  actor scatter_;
+};
+
+} // namespace detail
+
+/// Spawns an actor that keeps the elements `x` of a `std::vector<T>` or
+/// `mem_ref<T>`, depending on `TagIn`, for which the OpenCL C expression
+/// `predicate` holds, e.g., `"x > 0"`. The actor responds with the kept
+/// elements in their original order as `std::vector<T>` or `mem_ref<T>`,
+/// depending on `TagOut`, sized to the number of kept elements. Only the
+/// number of kept elements and, for `out<T, val>`, the kept elements are
+/// read back to the host.
+/// @throws std::runtime_error if compiling the kernels fails.
+template <class T, class TagIn, class TagOut>
+actor spawn_compact(actor_system& sys, const device_ptr& dev, in<T, TagIn>,
+                    out<T, TagOut>, const std::string& predicate) {
+  using ref = mem_ref<T>;
+  using uref = mem_ref<cl_uint>;
+  using map_fun = std::function<optional<message> (nd_range&, message&)>;
+  auto& mngr = sys.opencl_manager();
+  auto source = detail::compact_source(detail::cl_type_prelude<T>("T"),
+                                       predicate);
+  auto prog = mngr.create_program(source.c_str(), "", dev);
+  auto group_size = detail::group_size(dev, 0);
+  auto range_for = [=](cl_uint n) {
+    auto groups = (n + group_size - 1) / group_size;
+    return nd_range{dim_vec{groups * group_size}, {}, dim_vec{group_size}};
+  };
+  map_fun map_flags = [=](nd_range& range, message& msg) {
+    msg.apply([&](ref&, cl_uint n) {
+      range = range_for(n);
+    });
+    return optional<message>{std::move(msg)};
+  };
+  map_fun map_scatter = [=](nd_range& range, message& msg) {
+    msg.apply([&](ref&, uref&, cl_uint n, cl_uint) {
+      range = range_for(n);
+    });
+    return optional<message>{std::move(msg)};
+  };
+  auto flags = mngr.spawn(
+    prog, "compact_flags", range_for(1), map_flags,
+    in<T, mref>{},
+    out<cl_uint, mref>{[](ref&, cl_uint n) { return size_t{n}; }},
+    priv<cl_uint, val>{}
+  );
+  auto scan = spawn_scan(sys, dev, in_out<cl_uint, mref, mref>{},
+                         scan_mode::inclusive);
+  std::function<message (std::vector<cl_uint>&)> unbox =
+    [](std::vector<cl_uint>& xs) {
+      return make_message(xs.front());
+    };
+  map_fun map_count = [](nd_range&, message& msg) {
+    return optional<message>{std::move(msg)};
+  };
+  auto count = mngr.spawn(
+    prog, "compact_count", nd_range{dim_vec{1}}, map_count, unbox,
+    in<cl_uint, mref>{},
+    out<cl_uint, val>{[](uref&, cl_uint) { return size_t{1}; }},
+    priv<cl_uint, val>{}
+  );
+  auto scatter = mngr.spawn(
+    prog, "compact_scatter", range_for(1), map_scatter,
+    in<T, mref>{},
+    in<cl_uint, mref>{},
+    out<T, TagOut>{[](ref&, uref&, cl_uint, cl_uint count) {
+      return size_t{count};
+    }},
+    priv<cl_uint, val>{},
+    priv<cl_uint, val>{}
+  );
+  return sys.spawn<detail::compact_actor<T, TagIn, TagOut>>(
+    dev, std::move(flags), std::move(scan), std::move(count),
+    std::move(scatter)
+  );
+}
+
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_COMPACT_HPP
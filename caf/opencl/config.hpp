@@ -0,0 +1,78 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_CONFIG_HPP
+#define CAF_OPENCL_CONFIG_HPP
+
+#include <string>
+
+#include "caf/actor_system_config.hpp"
+
+namespace caf {
+namespace opencl {
+
+/// Options of the OpenCL module. Empty filters accept everything.
+struct options {
+  /// Only use platforms with a name containing this string.
+  std::string platform_name;
+  /// Only use platforms with a vendor containing this string.
+  std::string platform_vendor;
+  /// Comma-separated list of device types to discover, any of
+  /// `gpu`, `accelerator`, `cpu` or `all`.
+  std::string device_types = "gpu,accelerator,cpu";
+  /// Only use devices with a name matching this ECMAScript regex.
+  std::string device_name;
+  /// Maximum number of idle host vectors per element type, 0 disables
+  /// recycling of host vectors.
+  size_t host_pool_size = 0;
+  /// Maximum number of bytes allocated per device, 0 selects the global
+  /// memory size of the device.
+  size_t memory_budget = 0;
+  /// Maximum number of bytes per device kept in idle buffers for reuse,
+  /// 0 disables pooling of device buffers.
+  size_t max_pooled_bytes = 0;
+  /// Moves the buffers of least recently used mem_refs to host memory when
+  /// allocations exceed the memory budget.
+  bool spill_mem_refs = false;
+  /// Maximum number of bytes per device kept in read-only buffers for `in`
+  /// arguments with content seen before, 0 disables the upload cache.
+  size_t upload_cache_bytes = 0;
+  /// Directory for storing compiled variants of program families across
+  /// runs, empty disables the disk cache.
+  std::string program_cache_dir;
+  /// Maximum number of programs kept for deduplicating `create_program`
+  /// calls, 0 disables the deduplication of completed builds.
+  size_t max_cached_programs = 32;
+};
+
+/// An actor system config that makes the options of the OpenCL module
+/// available in the group `opencl` of INI files and command line arguments.
+/// The manager falls back to default options for other configs. Also adds
+/// `half` and the OpenCL vector types as message types.
+class config : public actor_system_config {
+public:
+  config();
+
+  options opencl_options;
+};
+
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_CONFIG_HPP
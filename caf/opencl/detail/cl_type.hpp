@@ -0,0 +1,176 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_DETAIL_CL_TYPE_HPP
+#define CAF_OPENCL_DETAIL_CL_TYPE_HPP
+
+#include <string>
+
+#include "caf/opencl/half.hpp"
+#include "caf/opencl/global.hpp"
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+/// Maps a host type to its OpenCL C counterpart for generating kernels.
+template <class T>
+struct cl_type;
+
+template <>
+struct cl_type<cl_char> {
+  static const char* name() { return "char"; }
+  static const char* lowest() { return "CHAR_MIN"; }
+  static const char* highest() { return "CHAR_MAX"; }
+  static const char* pragma() { return ""; }
+};
+
+template <>
+struct cl_type<cl_uchar> {
+  static const char* name() { return "uchar"; }
+  static const char* lowest() { return "0"; }
+  static const char* highest() { return "UCHAR_MAX"; }
+  static const char* pragma() { return ""; }
+};
+
+template <>
+struct cl_type<cl_short> {
+  static const char* name() { return "short"; }
+  static const char* lowest() { return "SHRT_MIN"; }
+  static const char* highest() { return "SHRT_MAX"; }
+  static const char* pragma() { return ""; }
+};
+
+template <>
+struct cl_type<cl_ushort> {
+  static const char* name() { return "ushort"; }
+  static const char* lowest() { return "0"; }
+  static const char* highest() { return "USHRT_MAX"; }
+  static const char* pragma() { return ""; }
+};
+
+template <>
+struct cl_type<cl_int> {
+  static const char* name() { return "int"; }
+  static const char* lowest() { return "INT_MIN"; }
+  static const char* highest() { return "INT_MAX"; }
+  static const char* pragma() { return ""; }
+};
+
+template <>
+struct cl_type<cl_uint> {
+  static const char* name() { return "uint"; }
+  static const char* lowest() { return "0"; }
+  static const char* highest() { return "UINT_MAX"; }
+  static const char* pragma() { return ""; }
+};
+
+template <>
+struct cl_type<cl_long> {
+  static const char* name() { return "long"; }
+  static const char* lowest() { return "LONG_MIN"; }
+  static const char* highest() { return "LONG_MAX"; }
+  static const char* pragma() { return ""; }
+};
+
+template <>
+struct cl_type<cl_ulong> {
+  static const char* name() { return "ulong"; }
+  static const char* lowest() { return "0"; }
+  static const char* highest() { return "ULONG_MAX"; }
+  static const char* pragma() { return ""; }
+};
+
+template <>
+struct cl_type<cl_float> {
+  static const char* name() { return "float"; }
+  static const char* lowest() { return "-INFINITY"; }
+  static const char* highest() { return "INFINITY"; }
+  static const char* pragma() { return ""; }
+};
+
+template <>
+struct cl_type<cl_double> {
+  static const char* name() { return "double"; }
+  static const char* lowest() { return "-INFINITY"; }
+  static const char* highest() { return "INFINITY"; }
+  static const char* pragma() {
+    return "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n";
+  }
+};
+
+template <>
+struct cl_type<half> {
+  static const char* name() { return "half"; }
+  static const char* lowest() { return "-INFINITY"; }
+  static const char* highest() { return "INFINITY"; }
+  static const char* pragma() {
+    return "#pragma OPENCL EXTENSION cl_khr_fp16 : enable\n";
+  }
+};
+
+// Vector types broadcast the limits of their element type to all components.
+#define CAF_OPENCL_CL_VECTOR_TYPE(type, n, min, max, ext)                      \
+  template <>                                                                  \
+  struct cl_type<cl_##type##n> {                                               \
+    static const char* name() { return #type #n; }                             \
+    static const char* lowest() { return "((" #type #n ")(" min "))"; }        \
+    static const char* highest() { return "((" #type #n ")(" max "))"; }       \
+    static const char* pragma() { return ext; }                                \
+  };
+
+#define CAF_OPENCL_CL_VECTOR_TYPES(type, min, max, ext)                        \
+  CAF_OPENCL_CL_VECTOR_TYPE(type, 2, min, max, ext)                            \
+  CAF_OPENCL_CL_VECTOR_TYPE(type, 4, min, max, ext)                            \
+  CAF_OPENCL_CL_VECTOR_TYPE(type, 8, min, max, ext)                            \
+  CAF_OPENCL_CL_VECTOR_TYPE(type, 16, min, max, ext)
+
+CAF_OPENCL_CL_VECTOR_TYPES(char, "CHAR_MIN", "CHAR_MAX", "")
+CAF_OPENCL_CL_VECTOR_TYPES(uchar, "0", "UCHAR_MAX", "")
+CAF_OPENCL_CL_VECTOR_TYPES(short, "SHRT_MIN", "SHRT_MAX", "")
+CAF_OPENCL_CL_VECTOR_TYPES(ushort, "0", "USHRT_MAX", "")
+CAF_OPENCL_CL_VECTOR_TYPES(int, "INT_MIN", "INT_MAX", "")
+CAF_OPENCL_CL_VECTOR_TYPES(uint, "0", "UINT_MAX", "")
+CAF_OPENCL_CL_VECTOR_TYPES(long, "LONG_MIN", "LONG_MAX", "")
+CAF_OPENCL_CL_VECTOR_TYPES(ulong, "0", "ULONG_MAX", "")
+CAF_OPENCL_CL_VECTOR_TYPES(float, "-INFINITY", "INFINITY", "")
+CAF_OPENCL_CL_VECTOR_TYPES(double, "-INFINITY", "INFINITY",
+                           "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n")
+
+#undef CAF_OPENCL_CL_VECTOR_TYPES
+#undef CAF_OPENCL_CL_VECTOR_TYPE
+
+/// Returns the OpenCL C prelude for kernels operating on `T`, i.e., the
+/// required pragmas and a define for the type named `alias`.
+template <class T>
+std::string cl_type_prelude(const char* alias) {
+  std::string result = cl_type<T>::pragma();
+  result += "#define ";
+  result += alias;
+  result += ' ';
+  result += cl_type<T>::name();
+  result += '\n';
+  return result;
+}
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_DETAIL_CL_TYPE_HPP
@@ -0,0 +1,50 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_DETAIL_GROUP_SIZE_HPP
+#define CAF_OPENCL_DETAIL_GROUP_SIZE_HPP
+
+#include <algorithm>
+
+#include "caf/opencl/device.hpp"
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+/// Returns the largest power of two up to `limit` that fits the work group
+/// limits of `dev` if each work item uses `local_bytes` of local memory.
+inline size_t group_size(const device_ptr& dev, size_t local_bytes,
+                         size_t limit = 256) {
+  limit = std::min(limit, dev->max_work_group_size());
+  limit = std::min(limit, dev->max_work_item_sizes()[0]);
+  if (local_bytes > 0)
+    limit = std::min(limit, static_cast<size_t>(dev->local_mem_size()
+                                                / local_bytes));
+  size_t result = 1;
+  while (result * 2 <= limit)
+    result *= 2;
+  return result;
+}
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_DETAIL_GROUP_SIZE_HPP
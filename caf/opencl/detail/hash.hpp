@@ -0,0 +1,46 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_DETAIL_HASH_HPP
+#define CAF_OPENCL_DETAIL_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+/// Scrambles the bits of `x`, i.e., similar inputs yield distant outputs.
+inline uint64_t hash_mix(uint64_t x) {
+  x ^= x >> 31;
+  x *= 0xbf58476d1ce4e5b9ull;
+  x ^= x >> 29;
+  return x;
+}
+
+/// Computes a 64-bit hash of `bytes` at `data`. The result only depends on
+/// the content, i.e., it is stable across runs of the same build.
+uint64_t hash(const void* data, size_t bytes);
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_DETAIL_HASH_HPP
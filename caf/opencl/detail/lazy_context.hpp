@@ -0,0 +1,93 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_DETAIL_LAZY_CONTEXT_HPP
+#define CAF_OPENCL_DETAIL_LAZY_CONTEXT_HPP
+
+#include <mutex>
+#include <vector>
+
+#include "caf/ref_counted.hpp"
+#include "caf/intrusive_ptr.hpp"
+
+#include "caf/opencl/global.hpp"
+#include "caf/opencl/opencl_err.hpp"
+
+#include "caf/opencl/detail/raw_ptr.hpp"
+#include "caf/opencl/detail/mem_tracker.hpp"
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+class lazy_context;
+using lazy_context_ptr = intrusive_ptr<lazy_context>;
+
+/// Creates the OpenCL context shared by all devices of a platform on first
+/// access. Platforms no one uses never pay for context creation. Also knows
+/// the memory trackers of its devices, because buffers of one device are
+/// valid on all devices of the context.
+class lazy_context : public ref_counted {
+public:
+  explicit lazy_context(std::vector<cl_device_id> ids) : ids_(std::move(ids)) {
+    // nop
+  }
+
+  /// Returns the context, creating it if necessary.
+  /// @throws std::runtime_error if `clCreateContext` fails.
+  const raw_context_ptr& get() {
+    std::call_once(once_, [&] {
+      context_.reset(v2get(CAF_CLF(clCreateContext), nullptr,
+                           static_cast<cl_uint>(ids_.size()), ids_.data(),
+                           pfn_notify, nullptr),
+                     false);
+    });
+    return context_;
+  }
+
+  /// Returns all devices included in the context.
+  inline const std::vector<cl_device_id>& device_ids() const {
+    return ids_;
+  }
+
+  /// Registers the memory tracker of a device.
+  void add_tracker(mem_tracker_ptr tracker) {
+    std::unique_lock<std::mutex> guard{trackers_mtx_};
+    trackers_.push_back(std::move(tracker));
+  }
+
+  /// Returns the memory trackers of all devices that allocated memory.
+  std::vector<mem_tracker_ptr> trackers() const {
+    std::unique_lock<std::mutex> guard{trackers_mtx_};
+    return trackers_;
+  }
+
+private:
+  std::once_flag once_;
+  std::vector<cl_device_id> ids_;
+  raw_context_ptr context_;
+  mutable std::mutex trackers_mtx_;
+  std::vector<mem_tracker_ptr> trackers_;
+};
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_DETAIL_LAZY_CONTEXT_HPP
@@ -0,0 +1,62 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_DETAIL_MAPPED_FILE_HPP
+#define CAF_OPENCL_DETAIL_MAPPED_FILE_HPP
+
+#include <string>
+#include <cstddef>
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+/// Read-only view on the content of a file. Maps the file into memory where
+/// supported and reads it into a buffer otherwise.
+class mapped_file {
+public:
+  /// Opens and maps the file at `path`.
+  /// @throws std::runtime_error if the file cannot be opened.
+  explicit mapped_file(const char* path);
+
+  ~mapped_file();
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  inline const char* data() const {
+    return data_;
+  }
+
+  inline size_t size() const {
+    return size_;
+  }
+
+private:
+  const char* data_;
+  size_t size_;
+  bool mapped_;
+  std::string buf_; // content if the file is not mapped
+};
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_DETAIL_MAPPED_FILE_HPP
@@ -0,0 +1,176 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_DETAIL_MEM_TRACKER_HPP
+#define CAF_OPENCL_DETAIL_MEM_TRACKER_HPP
+
+#include <list>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <condition_variable>
+
+#include "caf/ref_counted.hpp"
+#include "caf/intrusive_ptr.hpp"
+
+#include "caf/opencl/global.hpp"
+#include "caf/opencl/memory_usage.hpp"
+
+#include "caf/opencl/detail/raw_ptr.hpp"
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+class mem_tracker;
+using mem_tracker_ptr = intrusive_ptr<mem_tracker>;
+
+class spill_slot;
+
+/// Accounts the memory allocated on a single device, enforces a budget and
+/// keeps idle buffers for reuse. Buffers report their release through
+/// `clSetMemObjectDestructorCallback`, hence the accounting includes buffers
+/// that outlive the actor or command that created them. Each buffer keeps
+/// its tracker alive, i.e., the owner must `evict` all idle buffers before
+/// releasing the tracker. With spilling enabled, the tracker additionally
+/// moves the least recently used `mem_ref` buffers to host memory.
+class mem_tracker : public ref_counted {
+public:
+  friend class spill_slot;
+
+  /// Creates a tracker that allocates at most `budget` bytes and keeps at
+  /// most `max_pooled` bytes in idle buffers.
+  mem_tracker(size_t budget, size_t max_pooled);
+
+  ~mem_tracker() override;
+
+  /// Allocates a buffer of `bytes` accounted as `kind`, reusing an idle
+  /// buffer with matching size and flags if available. Evicts idle buffers
+  /// (and spills `mem_ref` buffers if enabled) if the allocation would exceed
+  /// the budget or if `clCreateBuffer` fails with
+  /// `CL_MEM_OBJECT_ALLOCATION_FAILURE`.
+  /// @throws std::runtime_error if the allocation fails nonetheless.
+  raw_mem_ptr allocate(cl_context context, cl_mem_flags flags, size_t bytes,
+                       mem_kind kind);
+
+  /// Allocates an image object of `bytes` accounted as `kind`, see
+  /// `allocate`. Images never enter the pool of idle buffers.
+  /// @throws std::runtime_error if the allocation fails.
+  raw_mem_ptr allocate_image(cl_context context, cl_mem_flags flags,
+                             const cl_image_format& format,
+                             const cl_image_desc& desc, size_t bytes,
+                             mem_kind kind);
+
+  /// Moves a buffer that no one references anymore into the pool of idle
+  /// buffers. Leaves dropped buffers in `buf` if the pool is full. For
+  /// buffers owned by `mem_ref`s, releases the pin acquired for a command
+  /// instead. Returns `false` for buffers of other trackers.
+  bool recycle(raw_mem_ptr& buf);
+
+  /// Releases idle buffers, oldest first, until at least `bytes` are freed.
+  /// @returns the number of freed bytes.
+  size_t evict(size_t bytes);
+
+  /// Returns a snapshot of the current memory usage.
+  memory_usage usage() const;
+
+  /// Sets the maximum number of bytes allocated on the device.
+  void budget(size_t bytes);
+
+  /// Enables or disables spilling of `mem_ref` buffers to host memory.
+  /// Affects only `mem_ref`s created afterwards.
+  void spilling(bool enabled);
+
+  /// Returns whether new `mem_ref`s are spillable.
+  bool spilling() const;
+
+private:
+  struct record {
+    mem_tracker_ptr tracker;
+    size_t bytes;
+    cl_mem_flags flags;
+    mem_kind kind;
+    spill_slot* slot;
+    bool image;
+  };
+
+  using create_fun = std::function<cl_mem (cl_int&)>;
+
+  // accounts `bytes` and creates the memory object via `create`
+  raw_mem_ptr allocate(cl_mem_flags flags, size_t bytes, mem_kind kind,
+                       bool image, const char* fname, const create_fun& create);
+
+  static void destructor_callback(cl_mem buf, void* data);
+
+  void released(cl_mem buf, record* rec);
+
+  size_t total() const;
+
+  // moves idle buffers to `out` until `bytes` are freed, requires lock
+  size_t take_idle(size_t bytes, std::vector<raw_mem_ptr>& out);
+
+  // marks the least recently used slots that hold at least `bytes` as busy,
+  // requires lock
+  size_t take_victims(size_t bytes, std::vector<spill_slot*>& out);
+
+  // spills all victims and clears their busy flag
+  void spill(std::vector<spill_slot*>& victims);
+
+  // registers the device buffer of a slot as most recently used
+  void attach(spill_slot* slot, cl_mem buf, bool restored);
+
+  // removes the accounting for the buffer of a slot before spilling it
+  void detach(spill_slot* slot, cl_mem buf);
+
+  // marks a slot as most recently used
+  void touch(spill_slot* slot);
+
+  // removes a slot that is about to be destroyed
+  void forget(spill_slot* slot);
+
+  inline size_t& counter(mem_kind kind) {
+    return counters_[static_cast<size_t>(kind)];
+  }
+
+  mutable std::mutex mtx_;
+  std::condition_variable cv_;
+  size_t budget_;
+  size_t max_pooled_;
+  size_t evictions_;
+  size_t failed_allocations_;
+  bool spilling_;
+  size_t spilled_;
+  size_t spills_;
+  size_t restores_;
+  size_t bytes_spilled_;
+  size_t bytes_restored_;
+  std::list<spill_slot*> lru_;
+  std::array<size_t, num_mem_kinds> counters_;
+  std::unordered_map<cl_mem, record*> live_;
+  std::deque<raw_mem_ptr> idle_;
+};
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_DETAIL_MEM_TRACKER_HPP
@@ -0,0 +1,48 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+
+#ifndef CAF_OPENCL_DETAIL_PAD_EMPTY_HPP
+#define CAF_OPENCL_DETAIL_PAD_EMPTY_HPP
+
+#include <vector>
+
+#include "caf/opencl/mem_ref.hpp"
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+// OpenCL does not support empty buffers, kernels ignore the padding
+template <class T>
+void pad_empty(std::vector<T>& xs) {
+  if (xs.empty())
+    xs.resize(1);
+}
+
+template <class T>
+void pad_empty(mem_ref<T>&) {
+  // nop
+}
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_DETAIL_PAD_EMPTY_HPP
@@ -0,0 +1,108 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_DETAIL_SPILL_SLOT_HPP
+#define CAF_OPENCL_DETAIL_SPILL_SLOT_HPP
+
+#include <list>
+#include <mutex>
+#include <atomic>
+
+#include "caf/ref_counted.hpp"
+#include "caf/intrusive_ptr.hpp"
+
+#include "caf/opencl/global.hpp"
+
+#include "caf/opencl/detail/raw_ptr.hpp"
+#include "caf/opencl/detail/mem_tracker.hpp"
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+class spill_slot;
+using spill_slot_ptr = intrusive_ptr<spill_slot>;
+
+/// The device buffer of a `mem_ref` that its tracker may move to pinned host
+/// memory under memory pressure. All copies of a `mem_ref` share one slot.
+/// The tracker never spills a slot while a command uses it, i.e., between
+/// `acquire` and recycling the returned buffer at the tracker.
+class spill_slot : public ref_counted {
+public:
+  friend class mem_tracker;
+
+  /// Takes ownership of `buffer`, which must be allocated by `tracker`. The
+  /// slot starts with `pins` references by running commands and waits for
+  /// `event` before spilling the buffer for the first time.
+  spill_slot(mem_tracker_ptr tracker, raw_context_ptr context,
+             raw_command_queue_ptr queue, raw_mem_ptr buffer,
+             cl_mem_flags flags, size_t bytes, raw_event_ptr event,
+             size_t pins);
+
+  ~spill_slot() override;
+
+  /// Returns the device buffer, restoring it from host memory if necessary.
+  /// Unless pinned, the tracker may spill the buffer again at any time.
+  raw_mem_ptr get();
+
+  /// Returns the device buffer and pins it until the tracker recycles it.
+  raw_mem_ptr acquire();
+
+  /// Copies `bytes` of the spilled content to `dst` without restoring the
+  /// buffer on the device.
+  /// @returns `false` if the buffer currently resides on the device.
+  bool read_spilled(void* dst, size_t bytes, cl_int& err);
+
+  inline size_t size() const {
+    return bytes_;
+  }
+
+private:
+  // copies the buffer to host memory and releases it on the device
+  void spill();
+
+  // allocates a new device buffer for the spilled content, requires lock
+  void restore();
+
+  inline void unpin() {
+    --pins_;
+  }
+
+  mem_tracker_ptr tracker_;
+  raw_context_ptr context_;
+  raw_command_queue_ptr queue_;
+  cl_mem_flags flags_;
+  size_t bytes_;
+  std::atomic<size_t> pins_;
+  std::mutex mtx_;
+  raw_mem_ptr device_;
+  raw_mem_ptr host_;
+  raw_event_ptr event_;
+  bool spilled_;
+  // guarded by the mutex of the tracker
+  std::list<spill_slot*>::iterator lru_pos_;
+  bool in_lru_;
+  bool busy_;
+};
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_DETAIL_SPILL_SLOT_HPP
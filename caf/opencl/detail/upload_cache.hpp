@@ -0,0 +1,112 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_DETAIL_UPLOAD_CACHE_HPP
+#define CAF_OPENCL_DETAIL_UPLOAD_CACHE_HPP
+
+#include <list>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+#include "caf/ref_counted.hpp"
+#include "caf/intrusive_ptr.hpp"
+
+#include "caf/opencl/global.hpp"
+#include "caf/opencl/memory_usage.hpp"
+
+#include "caf/opencl/detail/raw_ptr.hpp"
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+class upload_cache;
+using upload_cache_ptr = intrusive_ptr<upload_cache>;
+
+/// Keeps read-only device buffers for the content of `in` arguments, keyed
+/// by a hash of the content, its size and its element type. Each entry keeps
+/// a host copy of its content to rule out false hits on hash collisions.
+/// Evicts the least recently used entries to stay within its budget.
+class upload_cache : public ref_counted {
+public:
+  /// Creates a cache that keeps at most `budget` bytes, 0 disables it.
+  explicit upload_cache(size_t budget);
+
+  ~upload_cache() override;
+
+  /// Returns whether the cache accepts entries of `bytes`.
+  bool admits(size_t bytes) const;
+
+  /// Returns the buffer holding `bytes` of `data` with elements of `type` and
+  /// stores the event of its upload in `event`, or `nullptr` on a miss.
+  raw_mem_ptr lookup(size_t type, const void* data, size_t bytes,
+                     raw_event_ptr& event);
+
+  /// Adds `buffer`, which receives `bytes` of `data` once `event` completes.
+  /// Evicts the least recently used entries to make room for the new one.
+  void insert(size_t type, const void* data, size_t bytes, raw_mem_ptr buffer,
+              raw_event_ptr event);
+
+  /// Sets the maximum number of bytes kept and evicts entries if necessary.
+  void budget(size_t bytes);
+
+  /// Releases all entries.
+  void clear();
+
+  /// Adds the hit and miss counters to `usage`.
+  void stats(memory_usage& usage) const;
+
+private:
+  struct entry {
+    uint64_t key;
+    size_t type;
+    std::vector<char> content;
+    raw_mem_ptr buffer;
+    raw_event_ptr event;
+  };
+
+  using entry_list = std::list<entry>;
+
+  static uint64_t make_key(size_t type, const void* data, size_t bytes);
+
+  // returns the entry matching the arguments or `lru_.end()`, requires lock
+  entry_list::iterator find(uint64_t key, size_t type, const void* data,
+                            size_t bytes);
+
+  // drops the least recently used entries until `bytes` fit, requires lock
+  void shrink(size_t bytes, std::vector<raw_mem_ptr>& out);
+
+  mutable std::mutex mtx_;
+  size_t budget_;
+  size_t size_;
+  size_t hits_;
+  size_t misses_;
+  size_t bytes_saved_;
+  // most recently used entry first
+  entry_list lru_;
+  std::unordered_multimap<uint64_t, entry_list::iterator> index_;
+};
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_DETAIL_UPLOAD_CACHE_HPP
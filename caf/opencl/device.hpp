@@ -20,21 +20,33 @@
 #ifndef CAF_OPENCL_DEVICE_HPP
 #define CAF_OPENCL_DEVICE_HPP
 
+#include <mutex>
 #include <vector>
+#include <functional>
 
 #include "caf/sec.hpp"
 
+#include "caf/opencl/config.hpp"
 #include "caf/opencl/global.hpp"
 #include "caf/opencl/opencl_err.hpp"
+#include "caf/opencl/svm_ref.hpp"
+#include "caf/opencl/shared_span.hpp"
+#include "caf/opencl/memory_usage.hpp"
 
 #include "caf/opencl/detail/raw_ptr.hpp"
+#include "caf/opencl/detail/mem_tracker.hpp"
+#include "caf/opencl/detail/upload_cache.hpp"
+#include "caf/opencl/detail/spill_slot.hpp"
+#include "caf/opencl/detail/lazy_context.hpp"
 
 namespace caf {
 namespace opencl {
 
 class program;
 class manager;
+class platform;
 template <class T> class mem_ref;
+template <bool PassConfig, class... Ts> class actor_facade;
 
 class device;
 using device_ptr = intrusive_ptr<device>;
@@ -43,7 +55,11 @@ class device : public ref_counted {
 public:
   friend class program;
   friend class manager;
+  friend class program_family;
+  friend class platform;
   template <class T> friend class mem_ref;
+  template <bool PassConfig, class... Ts>
+  friend class actor_facade;
   template <class T, class... Ts>
   friend intrusive_ptr<T> caf::make_counted(Ts&&...);
 
@@ -57,39 +73,41 @@ public:
                              cl_bool blocking = CL_FALSE) {
     size_t num_elements = size ? *size : data.size();
     size_t buffer_size = sizeof(T) * num_elements;
-    auto buffer = v2get(CAF_CLF(clCreateBuffer), context_.get(), flags,
-                        buffer_size, nullptr);
+    auto buffer = tracker()->allocate(context().get(), flags, buffer_size,
+                                      mem_kind::reference);
     detail::raw_event_ptr event{v1get<cl_event>(CAF_CLF(clEnqueueWriteBuffer),
-                                                queue_.get(), buffer, blocking,
+                                                queue().get(), buffer.get(),
+                                                blocking,
                                                 cl_uint{0}, buffer_size,
                                                 data.data()),
                                 false};
-    return mem_ref<T>{num_elements, queue_, std::move(buffer), flags,
-                      std::move(event)};
+    return make_mem_ref<T>(num_elements, std::move(buffer), flags,
+                           std::move(event));
   }
 
   /// Create an argument for an OpenCL kernel in global memory without data.
   template <class T>
   mem_ref<T> scratch_argument(size_t size,
                               cl_mem_flags flags = buffer_type::scratch_space) {
-    auto buffer = v2get(CAF_CLF(clCreateBuffer), context_.get(), flags,
-                        sizeof(T) * size, nullptr);
-    return mem_ref<T>{size, queue_, std::move(buffer), flags, nullptr};
+    auto buffer = tracker()->allocate(context().get(), flags, sizeof(T) * size,
+                                      mem_kind::reference);
+    return make_mem_ref<T>(size, std::move(buffer), flags, nullptr);
   }
 
   template <class T>
   expected<mem_ref<T>> copy(mem_ref<T>& mem) {
-    if (!mem.get())
+    auto source = mem.get();
+    if (!source)
       return make_error(sec::runtime_error, "No memory assigned.");
     auto buffer_size = sizeof(T) * mem.size();
     cl_event event;
-    auto buffer = v2get(CAF_CLF(clCreateBuffer), context_.get(), mem.access(),
-                        buffer_size, nullptr);
+    auto buffer = tracker()->allocate(context().get(), mem.access(),
+                                      buffer_size, mem_kind::reference);
     std::vector<cl_event> prev_events;
     cl_event e = mem.take_event();
     if (e)
       prev_events.push_back(e);
-    auto err = clEnqueueCopyBuffer(queue_.get(), mem.get().get(), buffer,
+    auto err = clEnqueueCopyBuffer(queue().get(), source.get(), buffer.get(),
                                    0, 0, // no offset for now
                                    buffer_size, prev_events.size(),
                                    prev_events.data(), &event);
@@ -108,16 +126,73 @@ public:
         return make_error(sec::runtime_error, opencl_error(err));
     }
     // decrements the previous event we used for waiting above
-    return mem_ref<T>(mem.size(), queue_, std::move(buffer),
-                      mem.access(), {event, false});
+    return make_mem_ref<T>(mem.size(), std::move(buffer), mem.access(),
+                           {event, false});
+  }
+
+  /// Allocates `size` elements in pinned host memory, lets `init` fill them
+  /// via `init(T* data, size_t size)` and returns them as immutable span.
+  /// Uploads read pinned memory without an intermediate copy by the driver.
+  template <class T, class F>
+  shared_span<T> pinned_span(size_t size, F init) {
+    void* ptr = nullptr;
+    auto release = pinned_allocate(sizeof(T) * size, ptr);
+    auto data = static_cast<T*>(ptr);
+    init(data, size);
+    return {data, size, std::move(release)};
+  }
+
+  /// Allocates `size` elements in shared virtual memory. The allocation is
+  /// fine-grained if requested and supported by the device.
+  template <class T>
+  expected<svm_ref<T>> svm_argument(size_t size, bool fine_grained = true) {
+    auto block = svm_allocate(sizeof(T) * size, fine_grained);
+    if (!block)
+      return std::move(block.error());
+    return svm_ref<T>{size, queue(), std::move(*block)};
+  }
+
+  /// Allocates shared virtual memory initialized with `data`.
+  template <class T>
+  expected<svm_ref<T>> svm_argument(const std::vector<T>& data,
+                                    bool fine_grained = true) {
+    auto ref = svm_argument<T>(data.size(), fine_grained);
+    if (!ref)
+      return ref;
+    auto err = ref->map(CL_MAP_WRITE);
+    if (err)
+      return err;
+    std::copy(data.begin(), data.end(), ref->begin());
+    err = ref->unmap();
+    if (err)
+      return err;
+    return ref;
   }
 
-  /// Initialize a new device in a context using a specific device_id
-  static device_ptr create(const detail::raw_context_ptr& context,
+  /// Initialize a new device using a specific device_id. Neither the context
+  /// nor the command queue are created before the device is used for the
+  /// first time. Device properties are queried on first access as well.
+  static device_ptr create(detail::lazy_context_ptr context,
                            const detail::raw_device_ptr& device_id,
-                           unsigned id);
+                           unsigned id, const options& opts);
   /// Synchronizes all commands in its queue, waiting for them to finish.
   void synchronize();
+  /// Returns a snapshot of the memory allocated on this device.
+  memory_usage mem_usage();
+  /// Sets the maximum number of bytes allocated on this device. Defaults to
+  /// the option `memory-budget` or `global_mem_size()` if it is 0.
+  void memory_budget(size_t bytes);
+  /// Releases all idle buffers kept for reuse, including the buffers of the
+  /// upload cache.
+  void release_idle_buffers();
+  /// Sets the maximum number of bytes kept for repeated `in` arguments.
+  /// Defaults to the option `upload-cache-bytes`, 0 disables the cache.
+  /// Kernels must not write to `in` arguments while the cache is enabled.
+  void upload_cache_budget(size_t bytes);
+  /// Enables moving the buffers of least recently used mem_refs to host
+  /// memory when allocations exceed the memory budget. Defaults to the option
+  /// `spill-mem-refs` and affects only mem_refs created afterwards.
+  void spilling(bool enabled);
   /// Get the id assigned by caf
   inline unsigned id() const;
   /// Returns device info on CL_DEVICE_ADDRESS_BITS
@@ -170,10 +245,18 @@ public:
   inline const std::string& driver_version() const;
   /// Returns device info on CL_DEVICE_NAME
   inline const std::string& name() const;
+  /// Returns device info on CL_DEVICE_SVM_CAPABILITIES or 0 if the device
+  /// does not support shared virtual memory.
+  inline cl_bitfield svm_capabilities() const;
+  /// Checks whether this device and `other` share an OpenCL context, i.e.,
+  /// can use the programs and buffers of each other.
+  inline bool shares_context(const device& other) const {
+    return context_ == other.context_;
+  }
 
 private:
-  device(detail::raw_device_ptr device_id, detail::raw_command_queue_ptr queue,
-         detail::raw_context_ptr context, unsigned id);
+  device(detail::raw_device_ptr device_id, detail::lazy_context_ptr context,
+         unsigned id, const options& opts);
 
   template <class T>
   static T info(const detail::raw_device_ptr& device_id, unsigned info_flag) {
@@ -184,39 +267,96 @@ private:
 
   static std::string info_string(const detail::raw_device_ptr& device_id,
                                  unsigned info_flag);
+
+  /// Returns the context, creating it on first use.
+  inline const detail::raw_context_ptr& context();
+
+  /// Returns the command queue, creating it on first use.
+  const detail::raw_command_queue_ptr& queue();
+
+  /// Returns the memory tracker, creating it on first use.
+  const detail::mem_tracker_ptr& tracker();
+
+  /// Allocates and maps `bytes` of pinned host memory, storing its address in
+  /// `ptr`. Returns a function that unmaps and releases the memory.
+  std::function<void ()> pinned_allocate(size_t bytes, void*& ptr);
+
+  /// Allocates `bytes` of shared virtual memory.
+  expected<detail::svm_block_ptr> svm_allocate(size_t bytes,
+                                               bool fine_grained);
+
+  /// Returns the cache for the buffers of repeated `in` arguments.
+  inline const detail::upload_cache_ptr& upload_cache() const {
+    return upload_cache_;
+  }
+
+  /// Wraps `buffer` into a mem_ref, which is spillable if enabled.
+  template <class T>
+  mem_ref<T> make_mem_ref(size_t num_elements, detail::raw_mem_ptr buffer,
+                          cl_mem_flags flags, detail::raw_event_ptr event,
+                          size_t pins = 0) {
+    if (!tracker()->spilling())
+      return mem_ref<T>{num_elements, queue(), std::move(buffer), flags,
+                        std::move(event)};
+    auto slot = make_counted<detail::spill_slot>(tracker(), context(), queue(),
+                                                 std::move(buffer), flags,
+                                                 sizeof(T) * num_elements,
+                                                 event, pins);
+    return mem_ref<T>{num_elements, queue(), std::move(slot), flags,
+                      std::move(event)};
+  }
+
+  /// Device properties, queried all at once on first access.
+  struct properties {
+    cl_uint address_bits;                // CL_DEVICE_ADDRESS_BITS
+    cl_bool little_endian;               // CL_DEVICE_ENDIAN_LITTLE
+    cl_ulong global_mem_cache_size;      // CL_DEVICE_GLOBAL_MEM_CACHE_SIZE
+    cl_uint global_mem_cacheline_size;   // CL_DEVICE_GLOBAL_MEM_CACHELINE_SIZE
+    cl_ulong global_mem_size;            // CL_DEVICE_GLOBAL_MEM_SIZE
+    cl_bool host_unified_memory;         // CL_DEVICE_HOST_UNIFIED_MEMORY
+    cl_ulong local_mem_size;             // CL_DEVICE_LOCAL_MEM_SIZE
+    cl_uint local_mem_type;              // CL_DEVICE_LOCAL_MEM_TYPE
+    cl_uint max_clock_frequency;         // CL_DEVICE_MAX_CLOCK_FREQUENCY
+    cl_uint max_compute_units;           // CL_DEVICE_MAX_COMPUTE_UNITS
+    cl_uint max_constant_args;           // CL_DEVICE_MAX_CONSTANT_ARGS
+    cl_ulong max_constant_buffer_size;   // CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE
+    cl_ulong max_mem_alloc_size;         // CL_DEVICE_MAX_MEM_ALLOC_SIZE
+    size_t max_parameter_size;           // CL_DEVICE_MAX_PARAMETER_SIZE
+    size_t max_work_group_size;          // CL_DEVICE_MAX_WORK_GROUP_SIZE
+    cl_uint max_work_item_dimensions;    // CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS
+    size_t profiling_timer_resolution;   // CL_DEVICE_PROFILING_TIMER_RESOLUTION
+    dim_vec max_work_item_sizes;         // CL_DEVICE_MAX_WORK_ITEM_SIZES
+    device_type type;                    // CL_DEVICE_TYPE
+    std::vector<std::string> extensions; // CL_DEVICE_EXTENSIONS
+    std::string opencl_c_version;        // CL_DEVICE_OPENCL_C_VERSION
+    std::string device_vendor;           // CL_DEVICE_VENDOR
+    std::string device_version;          // CL_DEVICE_VERSION
+    std::string driver_version;          // CL_DRIVER_VERSION
+    std::string name;                    // CL_DEVICE_NAME
+    cl_bitfield svm_capabilities;        // CL_DEVICE_SVM_CAPABILITIES
+  };
+
+  /// Returns the device properties, querying them on first use.
+  const properties& props() const;
+
   detail::raw_device_ptr device_id_;
+  detail::lazy_context_ptr context_;
+  std::once_flag queue_once_;
   detail::raw_command_queue_ptr queue_;
-  detail::raw_context_ptr context_;
   unsigned id_;
 
   bool profiling_enabled_;              // CL_DEVICE_QUEUE_PROPERTIES
   bool out_of_order_execution_;         // CL_DEVICE_QUEUE_PROPERTIES
 
-  cl_uint address_bits_;                // CL_DEVICE_ADDRESS_BITS
-  cl_bool little_endian_;               // CL_DEVICE_ENDIAN_LITTLE
-  cl_ulong global_mem_cache_size_;      // CL_DEVICE_GLOBAL_MEM_CACHE_SIZE
-  cl_uint global_mem_cacheline_size_;   // CL_DEVICE_GLOBAL_MEM_CACHELINE_SIZE
-  cl_ulong global_mem_size_;            // CL_DEVICE_GLOBAL_MEM_SIZE
-  cl_bool host_unified_memory_;         // CL_DEVICE_HOST_UNIFIED_MEMORY
-  cl_ulong local_mem_size_;             // CL_DEVICE_LOCAL_MEM_SIZE
-  cl_uint local_mem_type_;              // CL_DEVICE_LOCAL_MEM_TYPE
-  cl_uint max_clock_frequency_;         // CL_DEVICE_MAX_CLOCK_FREQUENCY
-  cl_uint max_compute_units_;           // CL_DEVICE_MAX_COMPUTE_UNITS
-  cl_uint max_constant_args_;           // CL_DEVICE_MAX_CONSTANT_ARGS
-  cl_ulong max_constant_buffer_size_;   // CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE
-  cl_ulong max_mem_alloc_size_;         // CL_DEVICE_MAX_MEM_ALLOC_SIZE
-  size_t max_parameter_size_;           // CL_DEVICE_MAX_PARAMETER_SIZE
-  size_t max_work_group_size_;          // CL_DEVICE_MAX_WORK_GROUP_SIZE
-  cl_uint max_work_item_dimensions_;    // CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS
-  size_t profiling_timer_resolution_;   // CL_DEVICE_PROFILING_TIMER_RESOLUTION
-  dim_vec max_work_item_sizes_;         // CL_DEVICE_MAX_WORK_ITEM_SIZES
-  device_type device_type_;             // CL_DEVICE_TYPE
-  std::vector<std::string> extensions_; // CL_DEVICE_EXTENSIONS
-  std::string opencl_c_version_;        // CL_DEVICE_OPENCL_C_VERSION
-  std::string device_vendor_;           // CL_DEVICE_VENDOR
-  std::string device_version_;          // CL_DEVICE_VERSION
-  std::string driver_version_;          // CL_DRIVER_VERSION
-  std::string name_;                    // CL_DEVICE_NAME
+  size_t memory_budget_;
+  size_t max_pooled_bytes_;
+  bool spill_mem_refs_;
+  std::once_flag tracker_once_;
+  detail::mem_tracker_ptr tracker_;
+  detail::upload_cache_ptr upload_cache_;
+
+  mutable std::once_flag props_once_;
+  mutable properties props_;
 };
 
 /******************************************************************************\
@@ -227,104 +367,112 @@ inline unsigned device::id() const {
   return id_;
 }
 
+inline const detail::raw_context_ptr& device::context() {
+  return context_->get();
+}
+
 inline cl_uint device::address_bits() const {
-  return address_bits_;
+  return props().address_bits;
 }
 
 inline cl_bool device::little_endian() const {
-  return little_endian_;
+  return props().little_endian;
 }
 
 inline cl_ulong device::global_mem_cache_size() const {
-  return global_mem_cache_size_;
+  return props().global_mem_cache_size;
 }
 
 inline cl_uint device::global_mem_cacheline_size() const {
-  return global_mem_cacheline_size_;
+  return props().global_mem_cacheline_size;
 }
 
 inline cl_ulong device::global_mem_size() const {
-  return global_mem_size_;
+  return props().global_mem_size;
 }
 
 inline cl_bool device::host_unified_memory() const {
-  return host_unified_memory_;
+  return props().host_unified_memory;
 }
 
 inline cl_ulong device::local_mem_size() const {
-  return local_mem_size_;
+  return props().local_mem_size;
 }
 
 inline cl_ulong device::local_mem_type() const {
-  return local_mem_size_;
+  return props().local_mem_type;
 }
 
 inline cl_uint device::max_clock_frequency() const {
-  return max_clock_frequency_;
+  return props().max_clock_frequency;
 }
 
 inline cl_uint device::max_compute_units() const {
-  return max_compute_units_;
+  return props().max_compute_units;
 }
 
 inline cl_uint device::max_constant_args() const {
-  return max_constant_args_;
+  return props().max_constant_args;
 }
 
 inline cl_ulong device::max_constant_buffer_size() const {
-  return max_constant_buffer_size_;
+  return props().max_constant_buffer_size;
 }
 
 inline cl_ulong device::max_mem_alloc_size() const {
-  return max_mem_alloc_size_;
+  return props().max_mem_alloc_size;
 }
 
 inline size_t device::max_parameter_size() const {
-  return max_parameter_size_;
+  return props().max_parameter_size;
 }
 
 inline size_t device::max_work_group_size() const {
-  return max_work_group_size_;
+  return props().max_work_group_size;
 }
 
 inline cl_uint device::max_work_item_dimensions() const {
-  return max_work_item_dimensions_;
+  return props().max_work_item_dimensions;
 }
 
 inline size_t device::profiling_timer_resolution() const {
-  return profiling_timer_resolution_;
+  return props().profiling_timer_resolution;
 }
 
 inline const dim_vec& device::max_work_item_sizes() const {
-  return max_work_item_sizes_;
+  return props().max_work_item_sizes;
 }
 
 inline device_type device::type() const {
-  return device_type_;
+  return props().type;
 }
 
 inline const std::vector<std::string>& device::extensions() const {
-  return extensions_;
+  return props().extensions;
 }
 
 inline const std::string& device::opencl_c_version() const {
-  return opencl_c_version_;
+  return props().opencl_c_version;
 }
 
 inline const std::string& device::device_vendor() const {
-  return device_vendor_;
+  return props().device_vendor;
 }
 
 inline const std::string& device::device_version() const {
-  return device_version_;
+  return props().device_version;
 }
 
 inline const std::string& device::driver_version() const {
-  return driver_version_;
+  return props().driver_version;
 }
 
 inline const std::string& device::name() const {
-  return name_;
+  return props().name;
+}
+
+inline cl_bitfield device::svm_capabilities() const {
+  return props().svm_capabilities;
 }
 
 } // namespace opencl
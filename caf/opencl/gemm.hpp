@@ -0,0 +1,309 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+
+#ifndef CAF_OPENCL_GEMM_HPP
+#define CAF_OPENCL_GEMM_HPP
+
+#include <limits>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <type_traits>
+
+#include "caf/sec.hpp"
+#include "caf/optional.hpp"
+#include "caf/actor_system.hpp"
+#include "caf/scoped_actor.hpp"
+
+#include "caf/opencl/device.hpp"
+#include "caf/opencl/manager.hpp"
+#include "caf/opencl/mem_ref.hpp"
+#include "caf/opencl/nd_range.hpp"
+#include "caf/opencl/arguments.hpp"
+
+#include "caf/opencl/detail/cl_type.hpp"
+
+namespace caf {
+namespace opencl {
+
+/// Storage order of a matrix.
+enum class matrix_order {
+  row_major,
+  column_major
+};
+
+/// Dimensions and storage orders of `C = A * B`, where `A` is an `m` x `k`,
+/// `B` a `k` x `n` and `C` an `m` x `n` matrix.
+struct gemm_shape {
+  gemm_shape(size_t rows, size_t columns, size_t depth,
+             matrix_order a = matrix_order::row_major,
+             matrix_order b = matrix_order::row_major,
+             matrix_order c = matrix_order::row_major)
+      : m(rows), n(columns), k(depth), a_order(a), b_order(b), c_order(c) {
+    // nop
+  }
+
+  size_t m;
+  size_t n;
+  size_t k;
+  matrix_order a_order;
+  matrix_order b_order;
+  matrix_order c_order;
+};
+
+/// Blocking of a matrix multiplication. Each work group computes a block of
+/// `tile_m` x `tile_n` elements of `C`, stepping through `A` and `B` in
+/// blocks of depth `tile_k` in local memory, and each work item computes
+/// `work_m` x `work_n` of these elements in registers. A default constructed
+/// tiling selects the fastest candidate for the device.
+struct gemm_tiling {
+  gemm_tiling() : tile_m(0), tile_n(0), tile_k(0), work_m(0), work_n(0) {
+    // nop
+  }
+
+  gemm_tiling(size_t tm, size_t tn, size_t tk, size_t wm, size_t wn)
+      : tile_m(tm), tile_n(tn), tile_k(tk), work_m(wm), work_n(wn) {
+    // nop
+  }
+
+  size_t tile_m;
+  size_t tile_n;
+  size_t tile_k;
+  size_t work_m;
+  size_t work_n;
+
+  /// Returns whether all sizes are set.
+  bool valid() const {
+    return tile_m > 0 && tile_n > 0 && tile_k > 0 && work_m > 0 && work_n > 0;
+  }
+};
+
+namespace detail {
+
+/// Returns the source of the matrix multiplication kernel for the type `T`
+/// defined in the `prelude`.
+std::string gemm_source(const std::string& prelude, const gemm_shape& shape,
+                        const gemm_tiling& tiling);
+
+/// Returns the tilings worth timing on `dev` for elements of `element_size`
+/// bytes.
+std::vector<gemm_tiling> gemm_candidates(const device_ptr& dev,
+                                         size_t element_size);
+
+/// Returns the key for caching the tiling of `shape` on `dev`.
+std::string gemm_tuning_key(const device_ptr& dev, const char* type,
+                            const gemm_shape& shape);
+
+/// Returns the tiling stored for `key`, if any.
+optional<gemm_tiling> find_gemm_tiling(const std::string& key);
+
+/// Stores `tiling` for `key`.
+void store_gemm_tiling(const std::string& key, const gemm_tiling& tiling);
+
+/// Returns the index space for `shape` blocked by `tiling`.
+inline nd_range gemm_range(const gemm_shape& shape,
+                           const gemm_tiling& tiling) {
+  auto blocks = [](size_t n, size_t tile) { return (n + tile - 1) / tile; };
+  auto x = tiling.tile_n / tiling.work_n;
+  auto y = tiling.tile_m / tiling.work_m;
+  return nd_range{dim_vec{blocks(shape.n, tiling.tile_n) * x,
+                          blocks(shape.m, tiling.tile_m) * y},
+                  {}, dim_vec{x, y}};
+}
+
+using gemm_map_fun = std::function<optional<message> (nd_range&, message&)>;
+
+// rejects operands that do not match the shape with an error
+template <class Container>
+gemm_map_fun gemm_check_args(const gemm_shape& shape) {
+  auto a_size = shape.m * shape.k;
+  auto b_size = shape.k * shape.n;
+  return [=](nd_range&, message& msg) -> optional<message> {
+    auto matches = false;
+    msg.apply([&](const Container& a, const Container& b) {
+      matches = a.size() == a_size && b.size() == b_size;
+    });
+    if (!matches)
+      return make_message(make_error(sec::invalid_argument,
+                                     "gemm: operands do not match the shape"));
+    return std::move(msg);
+  };
+}
+
+template <class T>
+actor spawn_gemm_kernel(actor_system& sys, const device_ptr& dev,
+                        const gemm_shape& shape, const gemm_tiling& tiling,
+                        gemm_map_fun map_args, in<T, mref>, out<T, mref>) {
+  auto& mngr = sys.opencl_manager();
+  auto source = gemm_source(cl_type_prelude<T>("T"), shape, tiling);
+  auto prog = mngr.create_program(source.c_str(), "", dev);
+  auto c_size = shape.m * shape.n;
+  return mngr.spawn(prog, "gemm", gemm_range(shape, tiling),
+                    std::move(map_args), in<T, mref>{}, in<T, mref>{},
+                    out<T, mref>{[=](mem_ref<T>&, mem_ref<T>&) {
+                      return c_size;
+                    }});
+}
+
+// waits for the kernel that computes `x`
+template <class T>
+void await_result(mem_ref<T>& x) {
+  auto event = x.event();
+  if (event) {
+    auto e = event.get();
+    clWaitForEvents(1, &e);
+  }
+}
+
+} // namespace detail
+
+/// Returns the fastest tiling for multiplying matrices of type `T` with the
+/// orders in `shape` on `dev`. Candidates run on matrices of up to 1024 x
+/// 1024 elements and the result is cached per device, type and shape, i.e.,
+/// only the first call blocks to time the candidates.
+/// @throws std::runtime_error if no candidate runs on the device.
+template <class T>
+gemm_tiling tune_gemm(actor_system& sys, const device_ptr& dev,
+                      const gemm_shape& shape) {
+  using ref = mem_ref<T>;
+  constexpr size_t max_dim = 1024;
+  gemm_shape proxy{std::min(shape.m, max_dim), std::min(shape.n, max_dim),
+                   std::min(shape.k, max_dim), shape.a_order, shape.b_order,
+                   shape.c_order};
+  auto key = detail::gemm_tuning_key(dev, detail::cl_type<T>::name(), proxy);
+  auto cached = detail::find_gemm_tiling(key);
+  if (cached)
+    return *cached;
+  std::vector<T> a(proxy.m * proxy.k, T{1});
+  std::vector<T> b(proxy.k * proxy.n, T{1});
+  auto a_ref = dev->global_argument(a);
+  auto b_ref = dev->global_argument(b);
+  scoped_actor self{sys};
+  gemm_tiling best;
+  auto best_time = std::numeric_limits<double>::max();
+  for (auto& tiling : detail::gemm_candidates(dev, sizeof(T))) {
+    actor worker;
+    try {
+      worker = detail::spawn_gemm_kernel(sys, dev, proxy, tiling,
+                                         detail::gemm_check_args<ref>(proxy),
+                                         in<T, mref>{}, out<T, mref>{});
+    } catch (std::runtime_error&) {
+      continue; // e.g., exceeds the registers of the device
+    }
+    // the first run includes building the kernel and allocating buffers
+    auto elapsed = std::numeric_limits<double>::max();
+    auto failed = false;
+    for (int i = 0; i < 3 && !failed; ++i) {
+      auto start = std::chrono::steady_clock::now();
+      self->request(worker, infinite, a_ref, b_ref).receive(
+        [&](ref& c) {
+          detail::await_result(c);
+        },
+        [&](error&) {
+          failed = true;
+        }
+      );
+      std::chrono::duration<double> d = std::chrono::steady_clock::now()
+                                        - start;
+      if (i > 0)
+        elapsed = std::min(elapsed, d.count());
+    }
+    if (!failed && elapsed < best_time) {
+      best_time = elapsed;
+      best = tiling;
+    }
+  }
+  if (!best.valid())
+    throw std::runtime_error("gemm: no tiling runs on device " + dev->name());
+  detail::store_gemm_tiling(key, best);
+  return best;
+}
+
+/// Spawns an actor that multiplies two matrices `A` and `B` passed as
+/// `std::vector<T>` or `mem_ref<T>`, depending on `TagIn`, and responds with
+/// `C = A * B` as `std::vector<T>` or `mem_ref<T>`, depending on `TagOut`.
+/// Operands that do not match `shape` are answered with an error. If `tiling`
+/// is not set, this function calls `tune_gemm`, which blocks the calling
+/// thread on the first call for a device, type and shape. Hence, event-based
+/// actors should pass a tiling.
+/// @throws std::runtime_error if compiling the kernel fails.
+template <class T, class TagIn, class TagOut>
+actor spawn_gemm(actor_system& sys, const device_ptr& dev,
+                 const gemm_shape& shape, in<T, TagIn>, out<T, TagOut>,
+                 gemm_tiling tiling = {}) {
+  using input_type = typename std::conditional<
+    std::is_same<TagIn, val>::value, std::vector<T>, mem_ref<T>
+  >::type;
+  if (!tiling.valid())
+    tiling = tune_gemm<T>(sys, dev, shape);
+  auto& mngr = sys.opencl_manager();
+  auto source = detail::gemm_source(detail::cl_type_prelude<T>("T"), shape,
+                                    tiling);
+  auto prog = mngr.create_program(source.c_str(), "", dev);
+  auto c_size = shape.m * shape.n;
+  return mngr.spawn(prog, "gemm", detail::gemm_range(shape, tiling),
+                    detail::gemm_check_args<input_type>(shape),
+                    in<T, TagIn>{}, in<T, TagIn>{},
+                    out<T, TagOut>{[=](input_type&, input_type&) {
+                      return c_size;
+                    }});
+}
+
+/// Spawns an actor that multiplies two matrices in custom message types.
+/// `map_args` converts a message to the operands `A` and `B` as
+/// `std::vector<T>` and `map_result` converts `C` to the response, e.g.,
+/// for wrapping matrices in user-defined types. Blocks like the overload
+/// above if `tiling` is not set.
+/// @throws std::runtime_error if compiling the kernel fails.
+template <class T, class Fun>
+actor spawn_gemm(actor_system& sys, const device_ptr& dev,
+                 const gemm_shape& shape,
+                 std::function<optional<message> (message&)> map_args,
+                 Fun map_result, in<T, val>, out<T, val>,
+                 gemm_tiling tiling = {}) {
+  using vec = std::vector<T>;
+  if (!tiling.valid())
+    tiling = tune_gemm<T>(sys, dev, shape);
+  auto& mngr = sys.opencl_manager();
+  auto source = detail::gemm_source(detail::cl_type_prelude<T>("T"), shape,
+                                    tiling);
+  auto prog = mngr.create_program(source.c_str(), "", dev);
+  auto check = detail::gemm_check_args<vec>(shape);
+  detail::gemm_map_fun map_all = [=](nd_range& range, message& msg) {
+    auto operands = map_args(msg);
+    if (!operands)
+      return operands;
+    return check(range, *operands);
+  };
+  std::function<message (vec&)> map_res = std::move(map_result);
+  auto c_size = shape.m * shape.n;
+  return mngr.spawn(prog, "gemm", detail::gemm_range(shape, tiling),
+                    std::move(map_all), std::move(map_res),
+                    in<T>{}, in<T>{},
+                    out<T>{[=](vec&, vec&) { return c_size; }});
+}
+
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_GEMM_HPP
@@ -0,0 +1,97 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_HALF_HPP
+#define CAF_OPENCL_HALF_HPP
+
+#include <vector>
+#include <cstddef>
+
+#include "caf/meta/type_name.hpp"
+
+#include "caf/opencl/global.hpp"
+
+namespace caf {
+namespace opencl {
+
+/// A half precision floating point value in its binary representation. Unlike
+/// `cl_half`, which is an alias for `cl_ushort`, this type is distinct from
+/// integers and maps to `half` in kernels. Kernels without `cl_khr_fp16` can
+/// still access buffers of `half` via `vload_half` and `vstore_half`.
+struct half {
+  half() = default;
+
+  /// Converts `x` to the nearest half precision value.
+  explicit half(float x);
+
+  /// Converts this value to single precision without loss.
+  explicit operator float() const;
+
+  /// Creates a half precision value from its binary representation.
+  static half from_bits(cl_half x) {
+    half result;
+    result.bits = x;
+    return result;
+  }
+
+  cl_half bits;
+};
+
+/// @relates half
+inline bool operator==(half x, half y) {
+  return x.bits == y.bits;
+}
+
+/// @relates half
+inline bool operator!=(half x, half y) {
+  return x.bits != y.bits;
+}
+
+/// @relates half
+template <class Inspector>
+typename Inspector::result_type inspect(Inspector& f, half& x) {
+  return f(meta::type_name("half"), x.bits);
+}
+
+/// Converts `n` single precision values to half precision, rounding to the
+/// nearest value. Uses SIMD instructions if the target supports them.
+void to_half(const float* first, size_t n, half* out);
+
+/// Converts `n` half precision values to single precision. Uses SIMD
+/// instructions if the target supports them.
+void to_float(const half* first, size_t n, float* out);
+
+/// Converts all elements of `xs` to half precision.
+inline std::vector<half> to_half(const std::vector<float>& xs) {
+  std::vector<half> result(xs.size());
+  to_half(xs.data(), xs.size(), result.data());
+  return result;
+}
+
+/// Converts all elements of `xs` to single precision.
+inline std::vector<float> to_float(const std::vector<half>& xs) {
+  std::vector<float> result(xs.size());
+  to_float(xs.data(), xs.size(), result.data());
+  return result;
+}
+
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_HALF_HPP
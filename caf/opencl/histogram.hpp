@@ -0,0 +1,156 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+
+#ifndef CAF_OPENCL_HISTOGRAM_HPP
+#define CAF_OPENCL_HISTOGRAM_HPP
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <type_traits>
+
+#include "caf/actor_system.hpp"
+
+#include "caf/opencl/device.hpp"
+#include "caf/opencl/manager.hpp"
+#include "caf/opencl/mem_ref.hpp"
+#include "caf/opencl/nd_range.hpp"
+#include "caf/opencl/arguments.hpp"
+
+#include "caf/opencl/detail/cl_type.hpp"
+#include "caf/opencl/detail/pad_empty.hpp"
+#include "caf/opencl/detail/group_size.hpp"
+
+namespace caf {
+namespace opencl {
+
+/// Maps elements to bins, given as OpenCL C expression over the element `x`
+/// and the number of bins `BINS`. Elements mapped outside of `[0, BINS)` are
+/// not counted.
+struct bin_index {
+  std::string expression;
+
+  /// Declarations preceding `expression`, e.g., for constants.
+  std::string declarations;
+
+  /// Uses the element itself as index.
+  static bin_index identity() {
+    return {"(uint) x"};
+  }
+
+  /// Splits `[lo, hi)` into bins of equal width.
+  static bin_index uniform(double lo, double hi) {
+    std::ostringstream bounds;
+    bounds.precision(9);
+    bounds << std::showpoint
+           << "  const float lo = " << lo << "f;\n"
+           << "  const float hi = " << hi << "f;\n";
+    return {"x < lo || x >= hi ? BINS : "
+            "min((uint) ((x - lo) * (BINS / (hi - lo))), BINS - 1)",
+            bounds.str()};
+  }
+};
+
+namespace detail {
+
+/// Returns the source of the histogram kernels for the type `T` defined in
+/// the `prelude` with `bins` bins.
+std::string histogram_source(const std::string& prelude, size_t bins,
+                             const bin_index& index);
+
+} // namespace detail
+
+/// Spawns an actor that counts the elements of a `std::vector<T>` or
+/// `mem_ref<T>`, depending on `TagIn`, per bin and responds with the counts
+/// as `std::vector<cl_uint>` or `mem_ref<cl_uint>`, depending on `TagOut`.
+/// Each work group counts into private bins in local memory, a second pass
+/// sums the bins of all groups.
+/// @throws std::runtime_error if the bins exceed the local memory of the
+///                            device or compiling the kernels fails.
+template <class T, class TagIn, class TagOut>
+actor spawn_histogram(actor_system& sys, const device_ptr& dev, in<T, TagIn>,
+                      out<cl_uint, TagOut>, size_t bins,
+                      const bin_index& index = bin_index::identity()) {
+  using uref = mem_ref<cl_uint>;
+  using input_type = typename std::conditional<
+    std::is_same<TagIn, val>::value, std::vector<T>, mem_ref<T>
+  >::type;
+  using map_fun = std::function<optional<message> (nd_range&, message&)>;
+  // more groups only add partial results to the second pass
+  constexpr size_t max_groups = 256;
+  if (bins == 0 || bins * sizeof(cl_uint) > dev->local_mem_size()) {
+    std::ostringstream oss;
+    oss << "histogram: " << bins << " bins do not fit the local memory of "
+        << "device " << dev->name();
+    throw std::runtime_error(oss.str());
+  }
+  auto& mngr = sys.opencl_manager();
+  auto source = detail::histogram_source(detail::cl_type_prelude<T>("T"),
+                                         bins, index);
+  auto prog = mngr.create_program(source.c_str(), "", dev);
+  auto group_size = detail::group_size(dev, 0);
+  auto groups = [=](cl_uint n) -> size_t {
+    auto required = (n + group_size - 1) / group_size;
+    return std::max(size_t{1}, std::min(required, max_groups));
+  };
+  auto merge_range = nd_range{
+    dim_vec{(bins + group_size - 1) / group_size * group_size}, {},
+    dim_vec{group_size}
+  };
+  map_fun map_count = [=](nd_range& range, message& msg) {
+    return msg.apply([&](input_type& xs) {
+      auto n = static_cast<cl_uint>(xs.size());
+      range = nd_range{dim_vec{groups(n) * group_size}, {},
+                       dim_vec{group_size}};
+      detail::pad_empty(xs);
+      return make_message(std::move(xs), n);
+    });
+  };
+  map_fun map_merge = [=](nd_range&, message& msg) {
+    return msg.apply([&](uref& partials) {
+      auto n = static_cast<cl_uint>(partials.size() / bins);
+      return make_message(std::move(partials), n);
+    });
+  };
+  auto count = mngr.spawn(
+    prog, "histogram", merge_range, map_count,
+    in<T, TagIn>{},
+    out<cl_uint, mref>{[=](input_type&, cl_uint n) {
+      return groups(n) * bins;
+    }},
+    local<cl_uint>{bins},
+    priv<cl_uint, val>{}
+  );
+  auto merge = mngr.spawn(
+    prog, "histogram_merge", merge_range, map_merge,
+    in<cl_uint, mref>{},
+    out<cl_uint, TagOut>{[=](uref&, cl_uint) { return bins; }},
+    priv<cl_uint, val>{}
+  );
+  return merge * count;
+}
+
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_HISTOGRAM_HPP
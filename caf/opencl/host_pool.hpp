@@ -0,0 +1,127 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_HOST_POOL_HPP
+#define CAF_OPENCL_HOST_POOL_HPP
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <typeinfo>
+#include <typeindex>
+
+#include "caf/ref_counted.hpp"
+#include "caf/intrusive_ptr.hpp"
+
+namespace caf {
+namespace opencl {
+
+class host_pool;
+using host_pool_ptr = intrusive_ptr<host_pool>;
+
+/// A thread-safe pool of host vectors used for reading results back from a
+/// device. Vectors keep their size while pooled. Hence, taking a vector that
+/// is at least as large as requested neither allocates nor initializes any
+/// element. Vectors enter the pool when OpenCL actors are done with their
+/// `val` inputs or when users explicitly `give` them back.
+class host_pool : public ref_counted {
+public:
+  /// Creates a pool keeping up to `max_buffers` idle vectors per element type.
+  explicit host_pool(size_t max_buffers)
+      : max_buffers_(max_buffers),
+        hits_(0),
+        misses_(0) {
+    // nop
+  }
+
+  /// Returns a vector with `n` elements, reusing a pooled one if possible.
+  template <class T>
+  std::vector<T> take(size_t n) {
+    std::vector<T> result;
+    { // lifetime scope of guard
+      std::unique_lock<std::mutex> guard{mtx_};
+      auto& xs = free_list<T>();
+      // pick the smallest vector that is large enough
+      auto best = xs.end();
+      for (auto i = xs.begin(); i != xs.end(); ++i)
+        if (i->capacity() >= n
+            && (best == xs.end() || i->capacity() < best->capacity()))
+          best = i;
+      if (best != xs.end()) {
+        result = std::move(*best);
+        xs.erase(best);
+        ++hits_;
+      } else {
+        ++misses_;
+      }
+    }
+    result.resize(n);
+    return result;
+  }
+
+  /// Returns `x` to the pool. Drops `x` if the pool is full.
+  template <class T>
+  void give(std::vector<T>&& x) {
+    if (x.capacity() == 0)
+      return;
+    std::unique_lock<std::mutex> guard{mtx_};
+    auto& xs = free_list<T>();
+    if (xs.size() < max_buffers_)
+      xs.push_back(std::move(x));
+  }
+
+  /// Returns how many calls to `take` were served from the pool.
+  size_t hits() const {
+    std::unique_lock<std::mutex> guard{mtx_};
+    return hits_;
+  }
+
+  /// Returns how many calls to `take` required a new allocation.
+  size_t misses() const {
+    std::unique_lock<std::mutex> guard{mtx_};
+    return misses_;
+  }
+
+  /// Returns the maximum number of idle vectors per element type.
+  inline size_t max_buffers() const {
+    return max_buffers_;
+  }
+
+private:
+  template <class T>
+  std::vector<std::vector<T>>& free_list() {
+    using list_type = std::vector<std::vector<T>>;
+    auto& ptr = lists_[std::type_index{typeid(T)}];
+    if (!ptr)
+      ptr = std::make_shared<list_type>();
+    return *std::static_pointer_cast<list_type>(ptr);
+  }
+
+  mutable std::mutex mtx_;
+  size_t max_buffers_;
+  size_t hits_;
+  size_t misses_;
+  std::map<std::type_index, std::shared_ptr<void>> lists_;
+};
+
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_HOST_POOL_HPP
@@ -0,0 +1,390 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_IMAGE_HPP
+#define CAF_OPENCL_IMAGE_HPP
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+
+#include "caf/sec.hpp"
+#include "caf/expected.hpp"
+
+#include "caf/meta/type_name.hpp"
+
+#include "caf/opencl/half.hpp"
+#include "caf/opencl/global.hpp"
+#include "caf/opencl/mem_ref.hpp"
+
+#include "caf/opencl/detail/raw_ptr.hpp"
+
+namespace caf {
+namespace opencl {
+
+namespace detail {
+
+/// Maps a pixel type to its default image format, i.e., scalars to `CL_R`,
+/// 2-component vectors to `CL_RG` and 4-component vectors to `CL_RGBA`, with
+/// unnormalized channels of the element type.
+template <class T>
+struct image_format_of;
+
+#define CAF_OPENCL_IMAGE_FORMAT(type, order, channel_type)                     \
+  template <>                                                                  \
+  struct image_format_of<type> {                                               \
+    static constexpr cl_channel_order channel_order = order;                   \
+    static constexpr cl_channel_type data_type = channel_type;                 \
+  };
+
+#define CAF_OPENCL_IMAGE_FORMATS(type, channel_type)                           \
+  CAF_OPENCL_IMAGE_FORMAT(cl_##type, CL_R, channel_type)                       \
+  CAF_OPENCL_IMAGE_FORMAT(cl_##type##2, CL_RG, channel_type)                   \
+  CAF_OPENCL_IMAGE_FORMAT(cl_##type##4, CL_RGBA, channel_type)
+
+CAF_OPENCL_IMAGE_FORMATS(char, CL_SIGNED_INT8)
+CAF_OPENCL_IMAGE_FORMATS(uchar, CL_UNSIGNED_INT8)
+CAF_OPENCL_IMAGE_FORMATS(short, CL_SIGNED_INT16)
+CAF_OPENCL_IMAGE_FORMATS(ushort, CL_UNSIGNED_INT16)
+CAF_OPENCL_IMAGE_FORMATS(int, CL_SIGNED_INT32)
+CAF_OPENCL_IMAGE_FORMATS(uint, CL_UNSIGNED_INT32)
+CAF_OPENCL_IMAGE_FORMATS(float, CL_FLOAT)
+CAF_OPENCL_IMAGE_FORMAT(half, CL_R, CL_HALF_FLOAT)
+
+#undef CAF_OPENCL_IMAGE_FORMATS
+#undef CAF_OPENCL_IMAGE_FORMAT
+
+/// Returns the size of a single pixel in `format` in bytes or 0 for unknown
+/// channel orders and types.
+size_t image_element_size(const cl_image_format& format);
+
+} // namespace detail
+
+/// Returns the default image format for pixels of type `T`.
+template <class T>
+cl_image_format make_image_format() {
+  cl_image_format result;
+  result.image_channel_order = detail::image_format_of<T>::channel_order;
+  result.image_channel_data_type = detail::image_format_of<T>::data_type;
+  return result;
+}
+
+/// Returns a format with the given channel order and type, e.g., to access
+/// `cl_uchar4` pixels as normalized floats with `CL_RGBA` and `CL_UNORM_INT8`.
+inline cl_image_format make_image_format(cl_channel_order order,
+                                         cl_channel_type type) {
+  cl_image_format result;
+  result.image_channel_order = order;
+  result.image_channel_data_type = type;
+  return result;
+}
+
+/// The pixels of a 2D or 3D image in host memory. Rows start every
+/// `row_pitch` elements and slices every `slice_pitch` elements, i.e., padded
+/// images upload without repacking.
+template <class T, size_t Dims>
+class image {
+public:
+  static_assert(Dims == 2 || Dims == 3, "Images have two or three dimensions.");
+
+  using value_type = T;
+
+  static constexpr size_t num_dimensions = Dims;
+
+  image() : width_(0), height_(0), depth_(0), row_pitch_(0), slice_pitch_(0) {
+    // nop
+  }
+
+  /// Creates a tightly packed image of value-initialized pixels.
+  image(size_t width, size_t height, size_t depth = 1)
+      : width_(width),
+        height_(height),
+        depth_(depth),
+        row_pitch_(width),
+        slice_pitch_(width * height),
+        data_(width * height * depth) {
+    check();
+  }
+
+  /// Creates an image from `data`. A pitch of 0 selects tight packing.
+  /// @throws std::runtime_error if `data` is too small or a pitch is smaller
+  ///                            than a row or slice.
+  image(size_t width, size_t height, size_t depth, std::vector<T> data,
+        size_t row_pitch = 0, size_t slice_pitch = 0)
+      : width_(width),
+        height_(height),
+        depth_(depth),
+        row_pitch_(row_pitch == 0 ? width : row_pitch),
+        slice_pitch_(slice_pitch == 0 ? row_pitch_ * height : slice_pitch),
+        data_(std::move(data)) {
+    check();
+  }
+
+  image(image&&) = default;
+  image(const image&) = default;
+  image& operator=(image&&) = default;
+  image& operator=(const image&) = default;
+
+  inline size_t width() const {
+    return width_;
+  }
+
+  inline size_t height() const {
+    return height_;
+  }
+
+  inline size_t depth() const {
+    return depth_;
+  }
+
+  /// Returns the distance between two rows in elements.
+  inline size_t row_pitch() const {
+    return row_pitch_;
+  }
+
+  /// Returns the distance between two slices in elements.
+  inline size_t slice_pitch() const {
+    return slice_pitch_;
+  }
+
+  /// Returns whether the rows and slices have no padding.
+  inline bool tight() const {
+    return row_pitch_ == width_ && slice_pitch_ == width_ * height_;
+  }
+
+  /// Returns the width, height and, for 3D images, depth.
+  dim_vec dimensions() const {
+    if (Dims == 2)
+      return {width_, height_};
+    return {width_, height_, depth_};
+  }
+
+  inline std::vector<T>& data() {
+    return data_;
+  }
+
+  inline const std::vector<T>& data() const {
+    return data_;
+  }
+
+  inline T& operator()(size_t x, size_t y, size_t z = 0) {
+    return data_[z * slice_pitch_ + y * row_pitch_ + x];
+  }
+
+  inline const T& operator()(size_t x, size_t y, size_t z = 0) const {
+    return data_[z * slice_pitch_ + y * row_pitch_ + x];
+  }
+
+  template <class Inspector>
+  friend typename Inspector::result_type inspect(Inspector& f, image& x) {
+    return f(meta::type_name("image"), x.width_, x.height_, x.depth_,
+             x.row_pitch_, x.slice_pitch_, x.data_);
+  }
+
+private:
+  void check() const {
+    if (Dims == 2 && depth_ != 1)
+      throw std::runtime_error("2D images require a depth of 1.");
+    if (row_pitch_ < width_ || slice_pitch_ < row_pitch_ * height_)
+      throw std::runtime_error("Image pitch is smaller than its extent.");
+    if (width_ > 0 && height_ > 0 && depth_ > 0
+        && data_.size() < (depth_ - 1) * slice_pitch_
+                          + (height_ - 1) * row_pitch_ + width_)
+      throw std::runtime_error("Image data is smaller than its extent.");
+  }
+
+  size_t width_;
+  size_t height_;
+  size_t depth_;
+  size_t row_pitch_;
+  size_t slice_pitch_;
+  std::vector<T> data_;
+};
+
+template <class T, size_t Dims>
+constexpr size_t image<T, Dims>::num_dimensions;
+
+template <class T>
+using image2d = image<T, 2>;
+
+template <class T>
+using image3d = image<T, 3>;
+
+/// @relates image
+template <class T, size_t Dims>
+bool operator==(const image<T, Dims>& x, const image<T, Dims>& y) {
+  if (x.width() != y.width() || x.height() != y.height()
+      || x.depth() != y.depth())
+    return false;
+  if (x.width() == 0)
+    return true;
+  for (size_t z = 0; z < x.depth(); ++z)
+    for (size_t r = 0; r < x.height(); ++r)
+      if (!std::equal(&x(0, r, z), &x(0, r, z) + x.width(), &y(0, r, z)))
+        return false;
+  return true;
+}
+
+/// @relates image
+template <class T, size_t Dims>
+bool operator!=(const image<T, Dims>& x, const image<T, Dims>& y) {
+  return !(x == y);
+}
+
+/// Creates a 2D image from `data` with rows that start every `row_pitch`
+/// elements, 0 selects tight packing.
+template <class T>
+image2d<T> make_image2d(size_t width, size_t height, std::vector<T> data,
+                        size_t row_pitch = 0) {
+  return {width, height, 1, std::move(data), row_pitch};
+}
+
+/// Creates a 3D image from `data`, see `make_image2d`.
+template <class T>
+image3d<T> make_image3d(size_t width, size_t height, size_t depth,
+                        std::vector<T> data, size_t row_pitch = 0,
+                        size_t slice_pitch = 0) {
+  return {width, height, depth, std::move(data), row_pitch, slice_pitch};
+}
+
+/// A reference to an image object on an OpenCL device, the image counterpart
+/// to `mem_ref`. Access is not thread safe. Image objects are neither pooled
+/// nor spilled.
+template <class Image>
+class image_ref : ref_tag {
+public:
+  using value_type = Image;
+
+  friend struct msg_adding_event;
+  template <bool PassConfig, class... Ts>
+  friend class actor_facade;
+
+  /// Reads the image back into a tightly packed host image.
+  expected<Image> data() {
+    if (!memory_)
+      return make_error(sec::runtime_error, "No memory assigned.");
+    if (0 != (access_ & CL_MEM_HOST_NO_ACCESS))
+      return make_error(sec::runtime_error, "No memory access.");
+    Image result{width_, height_, depth_};
+    size_t origin[] = {0, 0, 0};
+    size_t region[] = {width_, height_, depth_};
+    std::vector<cl_event> prev_events;
+    if (event_)
+      prev_events.push_back(event_.get());
+    cl_event event;
+    auto err = clEnqueueReadImage(queue_.get(), memory_.get(), CL_TRUE,
+                                  origin, region, 0, 0, result.data().data(),
+                                  static_cast<cl_uint>(prev_events.size()),
+                                  prev_events.data(), &event);
+    if (err != CL_SUCCESS)
+      return make_error(sec::runtime_error, opencl_error(err));
+    // decrements the previous event we used for waiting above
+    event_.reset(event, false);
+    return result;
+  }
+
+  void reset() {
+    width_ = 0;
+    height_ = 0;
+    depth_ = 0;
+    access_ = CL_MEM_HOST_NO_ACCESS;
+    memory_.reset();
+    event_.reset();
+  }
+
+  inline const detail::raw_mem_ptr& get() const {
+    return memory_;
+  }
+
+  inline size_t width() const {
+    return width_;
+  }
+
+  inline size_t height() const {
+    return height_;
+  }
+
+  inline size_t depth() const {
+    return depth_;
+  }
+
+  /// Returns the width, height and, for 3D images, depth.
+  dim_vec dimensions() const {
+    if (Image::num_dimensions == 2)
+      return {width_, height_};
+    return {width_, height_, depth_};
+  }
+
+  inline cl_mem_flags access() const {
+    return access_;
+  }
+
+  image_ref()
+    : width_{0},
+      height_{0},
+      depth_{0},
+      access_{CL_MEM_HOST_NO_ACCESS} {
+    // nop
+  }
+
+  image_ref(size_t width, size_t height, size_t depth,
+            detail::raw_command_queue_ptr queue, detail::raw_mem_ptr memory,
+            cl_mem_flags access, detail::raw_event_ptr event)
+    : width_{width},
+      height_{height},
+      depth_{depth},
+      access_{access},
+      queue_{std::move(queue)},
+      event_{std::move(event)},
+      memory_{std::move(memory)} {
+    // nop
+  }
+
+  image_ref(image_ref&& other) = default;
+  image_ref& operator=(image_ref&& other) = default;
+  image_ref(const image_ref& other) = default;
+  image_ref& operator=(const image_ref& other) = default;
+
+private:
+  inline void set_event(detail::raw_event_ptr e) {
+    event_ = std::move(e);
+  }
+
+  inline cl_event take_event() {
+    return event_.release();
+  }
+
+  size_t width_;
+  size_t height_;
+  size_t depth_;
+  cl_mem_flags access_;
+  detail::raw_command_queue_ptr queue_;
+  detail::raw_event_ptr event_;
+  detail::raw_mem_ptr memory_;
+};
+
+} // namespace opencl
+
+template <class Image>
+struct allowed_unsafe_message_type<opencl::image_ref<Image>> : std::true_type {};
+
+} // namespace caf
+
+#endif // CAF_OPENCL_IMAGE_HPP
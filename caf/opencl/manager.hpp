@@ -20,20 +20,29 @@
 #ifndef CAF_OPENCL_MANAGER_HPP
 #define CAF_OPENCL_MANAGER_HPP
 
+#include <list>
+#include <mutex>
 #include <atomic>
+#include <future>
+#include <string>
 #include <vector>
 #include <algorithm>
 #include <functional>
+#include <unordered_map>
 
 #include "caf/optional.hpp"
 #include "caf/config.hpp"
 #include "caf/actor_system.hpp"
 
+#include "caf/opencl/config.hpp"
 #include "caf/opencl/device.hpp"
 #include "caf/opencl/global.hpp"
 #include "caf/opencl/program.hpp"
+#include "caf/opencl/host_pool.hpp"
 #include "caf/opencl/platform.hpp"
 #include "caf/opencl/actor_facade.hpp"
+#include "caf/opencl/program_family.hpp"
+#include "caf/opencl/variant_facade.hpp"
 
 #include "caf/opencl/detail/core.hpp"
 #include "caf/opencl/detail/raw_ptr.hpp"
@@ -45,6 +54,7 @@ namespace opencl {
 class manager : public actor_system::module {
 public:
   friend class program;
+  friend class program_family;
   friend class actor_system;
   friend detail::raw_command_queue_ptr command_queue(uint32_t id);
   manager(const manager&) = delete;
@@ -66,7 +76,14 @@ public:
 
   void start() override;
   void stop() override;
-  void init(actor_system_config&) override;
+  /// Discovers platforms and devices. Reads the options of the module from
+  /// `cfg` if it is an `opencl::config`.
+  void init(actor_system_config& cfg) override;
+
+  /// Returns the options of the module.
+  inline const options& module_options() const {
+    return options_;
+  }
 
   id_t id() const override;
 
@@ -77,6 +94,30 @@ public:
 
   // OpenCL functionality
 
+  /// Enables recycling of host vectors for `val` results, keeping up to
+  /// `max_buffers` idle vectors per element type. Only affects programs
+  /// created afterwards.
+  void enable_host_pool(size_t max_buffers);
+
+  /// Returns the pool for host vectors or `nullptr` if recycling is disabled.
+  inline const host_pool_ptr& host_vector_pool() const {
+    return host_pool_;
+  }
+
+  /// Drops all programs kept for deduplicating `create_program` calls.
+  /// Actors keep the programs they use alive.
+  void clear_program_cache();
+
+  /// Returns the maximum number of programs kept for deduplicating
+  /// `create_program` calls. Least recently used programs leave first.
+  inline size_t max_cached_programs() const {
+    return options_.max_cached_programs;
+  }
+
+  /// Returns the number of programs kept for deduplicating `create_program`
+  /// calls.
+  size_t cached_programs() const;
+
   /// @brief Factory method, that creates a caf::opencl::program
   ///        reading the source from given @p path.
   /// @returns A program object.
@@ -99,11 +140,121 @@ public:
                                        const device_ptr dev);
 
   /// @brief Factory method, that creates a caf::opencl::program
-  ///        from a given @p kernel_source.
+  ///        from a given @p kernel_source. Returns the existing program
+  ///        for a source, options and device seen recently, concurrent
+  ///        calls with the same arguments build the program only once.
   /// @returns A program object.
   program_ptr create_program(const char* kernel_source,
                              const char* options, const device_ptr dev);
 
+  /// Compiles `kernel_source` with a single build for all `devs`, which
+  /// need to share a context, i.e., belong to the same platform. Actors
+  /// spawned from the result run on the first device, see
+  /// `program::for_device` for running on the others. Buffers of `mem_ref`s
+  /// are usable on all devices of the context.
+  /// @throws std::runtime_error if `devs` is empty, the devices belong to
+  ///                            different contexts, or the build fails.
+  /// @returns A program object.
+  program_ptr create_program(const char* kernel_source, const char* options,
+                             const std::vector<device_ptr>& devs);
+
+  /// Creates a program from `size` bytes of intermediate language, e.g.,
+  /// SPIR-V, which skips compiling OpenCL C at runtime.
+  /// @throws std::runtime_error if the device rejects the IL, the build
+  ///                            fails, or OpenCL 2.1 is not available.
+  /// @returns A program object.
+  program_ptr create_program_from_il(const void* il, size_t size,
+                                     const char* options = nullptr,
+                                     uint32_t device_id = 0);
+
+  /// Creates a program from `size` bytes of intermediate language, e.g.,
+  /// SPIR-V, which skips compiling OpenCL C at runtime.
+  /// @throws std::runtime_error if the device rejects the IL, the build
+  ///                            fails, or OpenCL 2.1 is not available.
+  /// @returns A program object.
+  program_ptr create_program_from_il(const void* il, size_t size,
+                                     const char* options,
+                                     const device_ptr dev);
+
+  /// Creates a program from the intermediate language in the file at `path`,
+  /// which gets mapped into memory instead of copied.
+  /// @returns A program object.
+  program_ptr create_program_from_il_file(const char* path,
+                                          const char* options = nullptr,
+                                          uint32_t device_id = 0);
+
+  /// Creates a program from the intermediate language in the file at `path`,
+  /// which gets mapped into memory instead of copied.
+  /// @returns A program object.
+  program_ptr create_program_from_il_file(const char* path,
+                                          const char* options,
+                                          const device_ptr dev);
+
+  /// Creates a program from `size` bytes of a binary previously compiled
+  /// for the same device and driver, e.g., read via `CL_PROGRAM_BINARIES`.
+  /// @throws std::runtime_error if the device rejects the binary or the
+  ///                            build fails.
+  /// @returns A program object.
+  program_ptr create_program_from_binary(const void* binary, size_t size,
+                                         const char* options = nullptr,
+                                         uint32_t device_id = 0);
+
+  /// Creates a program from `size` bytes of a binary previously compiled
+  /// for the same device and driver, e.g., read via `CL_PROGRAM_BINARIES`.
+  /// @throws std::runtime_error if the device rejects the binary or the
+  ///                            build fails.
+  /// @returns A program object.
+  program_ptr create_program_from_binary(const void* binary, size_t size,
+                                         const char* options,
+                                         const device_ptr dev);
+
+  /// Creates a program from the binary in the file at `path`, which gets
+  /// mapped into memory instead of copied.
+  /// @returns A program object.
+  program_ptr create_program_from_binary_file(const char* path,
+                                              const char* options = nullptr,
+                                              uint32_t device_id = 0);
+
+  /// Creates a program from the binary in the file at `path`, which gets
+  /// mapped into memory instead of copied.
+  /// @returns A program object.
+  program_ptr create_program_from_binary_file(const char* path,
+                                              const char* options,
+                                              const device_ptr dev);
+
+  /// Creates a family of programs that compiles `kernel_source` with
+  /// additional preprocessor definitions on demand, keeping up to
+  /// `max_variants` compiled variants.
+  /// @returns A program family object.
+  program_family_ptr create_program_family(const char* kernel_source,
+                                           const char* options,
+                                           const device_ptr dev,
+                                           size_t max_variants = 8);
+
+  /// Creates a family of programs that compiles `kernel_source` with
+  /// additional preprocessor definitions on demand, keeping up to
+  /// `max_variants` compiled variants.
+  /// @returns A program family object.
+  program_family_ptr create_program_family(const char* kernel_source,
+                                           const char* options = nullptr,
+                                           uint32_t device_id = 0,
+                                           size_t max_variants = 8);
+
+  /// Creates a new actor that runs the function named `fname` from the
+  /// variant of `family` that `select` picks for each message. Variants
+  /// are compiled on first use.
+  /// @throws std::runtime_error if `family` or `select` are empty.
+  template <class T, class... Ts>
+  detail::enable_if_t<opencl::is_opencl_arg<T>::value, actor>
+  spawn(const opencl::program_family_ptr family, const char* fname,
+        const opencl::nd_range& range,
+        std::function<defines (const message&)> select, T&& x, Ts&&... xs) {
+    using impl = opencl::variant_facade<T, Ts...>;
+    return impl::create(actor_config{system_.dummy_execution_unit()}, family,
+                        fname, range, std::move(select), std::forward<T>(x),
+                        std::forward<Ts>(xs)...);
+  }
+
   /// Creates a new actor facade for an OpenCL kernel that invokes
   /// the function named `fname` from `prog`.
   /// @throws std::runtime_error if more than three dimensions are set,
@@ -271,9 +422,37 @@ protected:
   manager(actor_system& sys);
   ~manager() override;
 
+  /// Returns the device with `device_id`.
+  /// @throws std::runtime_error if no such device exists.
+  device_ptr device_by_id(uint32_t device_id) const;
+
+  /// Compiles `kernel_source_length` bytes of `kernel_source`, returning
+  /// the cached program if available.
+  program_ptr create_program(const char* kernel_source,
+                             size_t kernel_source_length, const char* options,
+                             const std::vector<device_ptr>& devs);
+
+  /// Builds `pptr` for all `devs` at once and creates its kernels. The
+  /// program binds to the queue of the first device.
+  /// @throws std::runtime_error if building the program fails.
+  static program_ptr build_program(detail::raw_program_ptr pptr,
+                                   const char* options,
+                                   std::vector<device_ptr> devs,
+                                   host_pool_ptr pool);
+
 private:
   actor_system& system_;
   std::vector<platform_ptr> platforms_;
+  host_pool_ptr host_pool_;
+  options options_;
+  using program_entry = std::pair<std::string, program_ptr>;
+  mutable std::mutex programs_mtx_;
+  // programs by device ID, options and source, most recently used first
+  std::list<program_entry> programs_;
+  std::unordered_map<std::string,
+                     std::list<program_entry>::iterator> program_index_;
+  // programs in progress, completed once built
+  std::unordered_map<std::string, std::shared_future<program_ptr>> building_;
 };
 
 } // namespace opencl
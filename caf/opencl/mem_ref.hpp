@@ -29,10 +29,17 @@
 
 #include "caf/opencl/detail/core.hpp"
 #include "caf/opencl/detail/raw_ptr.hpp"
+#include "caf/opencl/detail/spill_slot.hpp"
 
 namespace caf {
 namespace opencl {
 
+template <class Image>
+class image_ref;
+
+template <class T>
+class svm_ref;
+
 /// Updates the reference types in a message with a given event.
 struct msg_adding_event {
   msg_adding_event(detail::raw_event_ptr event) : event_(event) {
@@ -51,6 +58,16 @@ struct msg_adding_event {
     ref.set_event(event_);
     return std::move(ref);
   }
+  template <class Image>
+  image_ref<Image> add_event(image_ref<Image> ref) {
+    ref.set_event(event_);
+    return std::move(ref);
+  }
+  template <class T>
+  svm_ref<T> add_event(svm_ref<T> ref) {
+    // kernels access shared virtual memory directly
+    return ref;
+  }
   detail::raw_event_ptr event_;
 };
 
@@ -60,7 +77,9 @@ struct ref_tag {};
 class device;
 
 /// A reference type for buffers on a OpenCL devive. Access is not thread safe.
-/// Hence, a mem_ref should only be passed to actors sequentially.
+/// Hence, a mem_ref should only be passed to actors sequentially. If the device
+/// spills buffers under memory pressure, the buffer of a mem_ref may reside in
+/// host memory until an actor uses it again.
 template <class T>
 class mem_ref : ref_tag {
 public:
@@ -72,7 +91,7 @@ public:
   friend class device;
 
   expected<std::vector<T>> data(optional<size_t> result_size = none) {
-    if (!memory_)
+    if (!memory_ && !slot_)
       return make_error(sec::runtime_error, "No memory assigned.");
     if (0 != (access_ & CL_MEM_HOST_NO_ACCESS))
       return make_error(sec::runtime_error, "No memory access.");
@@ -81,11 +100,18 @@ public:
     auto num_elements = (result_size ? *result_size : num_elements_);
     auto buffer_size = sizeof(T) * num_elements;
     std::vector<T> buffer(num_elements);
+    cl_int err;
+    if (slot_ && slot_->read_spilled(buffer.data(), buffer_size, err)) {
+      if (err != CL_SUCCESS)
+        return make_error(sec::runtime_error, opencl_error(err));
+      return buffer;
+    }
     std::vector<cl_event> prev_events;
     if (event_)
       prev_events.push_back(event_.get());
     cl_event event;
-    auto err = clEnqueueReadBuffer(queue_.get(), memory_.get(), CL_TRUE,
+    auto mem = get();
+    err = clEnqueueReadBuffer(queue_.get(), mem.get(), CL_TRUE,
                                    0, buffer_size, buffer.data(),
                                    static_cast<cl_uint>(prev_events.size()),
                                    prev_events.data(), &event);
@@ -100,12 +126,15 @@ public:
     num_elements_ = 0;
     access_ = CL_MEM_HOST_NO_ACCESS;
     memory_.reset();
+    slot_.reset();
     access_ = 0;
     event_.reset();
   }
 
-  inline const detail::raw_mem_ptr& get() const {
-    return memory_;
+  /// Returns the buffer on the device, moving it back from host memory first
+  /// if it has been spilled.
+  inline detail::raw_mem_ptr get() const {
+    return slot_ ? slot_->get() : memory_;
   }
 
   inline size_t size() const {
@@ -136,6 +165,17 @@ public:
     // nop
   }
 
+  mem_ref(size_t num_elements, detail::raw_command_queue_ptr queue,
+          detail::spill_slot_ptr slot, cl_mem_flags access,
+          detail::raw_event_ptr event)
+    : num_elements_{num_elements},
+      access_{access},
+      queue_{queue},
+      event_{event},
+      slot_{std::move(slot)} {
+    // nop
+  }
+
   mem_ref(size_t num_elements, detail::raw_command_queue_ptr queue,
           cl_mem memory, cl_mem_flags access, detail::raw_event_ptr event)
     : num_elements_{num_elements},
@@ -171,11 +211,18 @@ private:
     return event_.release();
   }
 
+  // returns the buffer on the device and keeps it there until the buffer
+  // gets recycled at the memory tracker of the device
+  inline detail::raw_mem_ptr acquire() {
+    return slot_ ? slot_->acquire() : memory_;
+  }
+
   size_t num_elements_;
   cl_mem_flags access_;
   detail::raw_command_queue_ptr queue_;
   detail::raw_event_ptr event_;
   detail::raw_mem_ptr memory_;
+  detail::spill_slot_ptr slot_;
 };
 
 } // namespace opencl
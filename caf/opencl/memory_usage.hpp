@@ -0,0 +1,104 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_MEMORY_USAGE_HPP
+#define CAF_OPENCL_MEMORY_USAGE_HPP
+
+#include <cstddef>
+
+#include "caf/meta/type_name.hpp"
+
+namespace caf {
+namespace opencl {
+
+/// Categories for accounting device memory.
+enum class mem_kind : int {
+  /// Per-command buffers for `in` arguments.
+  input,
+  /// Per-command buffers for results read back to the host.
+  output,
+  /// Per-command buffers for `scratch` arguments.
+  scratch,
+  /// Idle buffers kept for reuse.
+  pooled,
+  /// Buffers owned by `mem_ref`s.
+  reference,
+  /// Read-only buffers kept across commands, e.g., by the upload cache.
+  cached
+};
+
+/// Number of categories in `mem_kind`.
+constexpr size_t num_mem_kinds = 6;
+
+/// A snapshot of the memory allocated on a device, in bytes.
+struct memory_usage {
+  size_t input = 0;
+  size_t output = 0;
+  size_t scratch = 0;
+  size_t pooled = 0;
+  size_t reference = 0;
+  size_t cached = 0;
+  /// Maximum number of bytes the runtime allocates on the device.
+  size_t budget = 0;
+  /// Number of idle buffers released to make room for new allocations.
+  size_t evictions = 0;
+  /// Number of allocations that failed despite evicting idle buffers.
+  size_t failed_allocations = 0;
+  /// Bytes of `mem_ref` buffers currently moved to host memory.
+  size_t spilled = 0;
+  /// Number of `mem_ref` buffers moved to host memory.
+  size_t spills = 0;
+  /// Number of spilled `mem_ref` buffers moved back to the device.
+  size_t restores = 0;
+  /// Total bytes moved to host memory.
+  size_t bytes_spilled = 0;
+  /// Total bytes moved back to the device.
+  size_t bytes_restored = 0;
+  /// Number of `in` arguments bound to a buffer of the upload cache.
+  size_t upload_hits = 0;
+  /// Number of `in` arguments uploaded while the upload cache is enabled.
+  size_t upload_misses = 0;
+  /// Total bytes not transferred to the device due to upload cache hits.
+  size_t upload_bytes_saved = 0;
+
+  inline size_t total() const {
+    return input + output + scratch + pooled + reference + cached;
+  }
+
+  /// Returns the fraction of cache lookups that avoided an upload.
+  inline double upload_hit_rate() const {
+    auto lookups = upload_hits + upload_misses;
+    return lookups > 0 ? static_cast<double>(upload_hits) / lookups : 0.;
+  }
+};
+
+/// @relates memory_usage
+template <class Inspector>
+typename Inspector::result_type inspect(Inspector& f, memory_usage& x) {
+  return f(meta::type_name("memory_usage"), x.input, x.output, x.scratch,
+           x.pooled, x.reference, x.cached, x.budget, x.evictions,
+           x.failed_allocations, x.spilled, x.spills, x.restores,
+           x.bytes_spilled, x.bytes_restored, x.upload_hits, x.upload_misses,
+           x.upload_bytes_saved);
+}
+
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_MEMORY_USAGE_HPP
@@ -20,13 +20,32 @@
 #ifndef CAF_OPENCL_ND_RANGE_HPP
 #define CAF_OPENCL_ND_RANGE_HPP
 
+#include "caf/optional.hpp"
+
 #include "caf/opencl/global.hpp"
 
 namespace caf {
 namespace opencl {
 
+/// Range policy that derives a one-dimensional index space per message from
+/// the number of elements of an input argument. The global size is rounded
+/// up to the preferred work group size multiple of the kernel, the local size
+/// follows from kernel and device limits. Kernels learn the actual number of
+/// elements from a `priv<T, elements>` argument.
+struct input_size {
+  /// Position of the input argument among the message elements.
+  explicit input_size(size_t pos = 0) : position(pos) {
+    // nop
+  }
+  size_t position;
+};
+
 class nd_range {
 public:
+  /// Creates an empty index space. Actors with image arguments derive the
+  /// global dimensions from the extent of the first image per message.
+  nd_range() = default;
+
   nd_range(const opencl::dim_vec& dimensions,
            const opencl::dim_vec& offsets = {},
            const opencl::dim_vec& local_dimensions = {})
@@ -45,6 +64,12 @@ public:
     // nop
   }
 
+  /// Creates an index space that each actor derives per message from the
+  /// input argument selected by `policy`.
+  nd_range(input_size policy) : input_{policy.position} {
+    // nop
+  }
+
   nd_range(const nd_range&) = default;
   nd_range(nd_range&&) = default;
 
@@ -63,10 +88,17 @@ public:
     return local_dims_;
   }
 
+  /// Returns the position of the input argument that defines the index space
+  /// or `none` if the dimensions are fixed.
+  const optional<size_t>& input() const {
+    return input_;
+  }
+
 private:
   opencl::dim_vec dims_;
   opencl::dim_vec offset_;
   opencl::dim_vec local_dims_;
+  optional<size_t> input_;
 };
 
 } // namespace opencl
@@ -20,10 +20,15 @@
 #ifndef CAF_OPENCL_PLATFORM_HPP
 #define CAF_OPENCL_PLATFORM_HPP
 
+#include <chrono>
+
 #include "caf/ref_counted.hpp"
 
+#include "caf/opencl/config.hpp"
 #include "caf/opencl/device.hpp"
 
+#include "caf/opencl/detail/lazy_context.hpp"
+
 namespace caf {
 namespace opencl {
 
@@ -40,23 +45,31 @@ public:
   inline const std::string& name() const;
   inline const std::string& vendor() const;
   inline const std::string& version() const;
-  static platform_ptr create(cl_platform_id platform_id, unsigned start_id);
+  /// Returns the time spent discovering this platform and its devices.
+  inline std::chrono::microseconds discovery_time() const;
+  /// Discovers all devices of a platform that pass the filters in `opts`.
+  /// Returns `nullptr` if the platform itself or all of its devices are
+  /// filtered out.
+  static platform_ptr create(cl_platform_id platform_id, unsigned start_id,
+                             const options& opts);
 
 private:
-  platform(cl_platform_id platform_id, detail::raw_context_ptr context,
+  platform(cl_platform_id platform_id, detail::lazy_context_ptr context,
            std::string name, std::string vendor, std::string version,
-           std::vector<device_ptr> devices);
+           std::vector<device_ptr> devices,
+           std::chrono::microseconds discovery_time);
 
   ~platform();
 
   static std::string platform_info(cl_platform_id platform_id,
                                    unsigned info_flag);
   cl_platform_id platform_id_;
-  detail::raw_context_ptr context_;
+  detail::lazy_context_ptr context_;
   std::string name_;
   std::string vendor_;
   std::string version_;
   std::vector<device_ptr> devices_;
+  std::chrono::microseconds discovery_time_;
 };
 
 /******************************************************************************\
@@ -79,6 +92,10 @@ inline const std::string& platform::version() const {
   return version_;
 }
 
+inline std::chrono::microseconds platform::discovery_time() const {
+  return discovery_time_;
+}
+
 
 } // namespace opencl
 } // namespace caf
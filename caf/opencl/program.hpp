@@ -21,12 +21,15 @@
 #define CAF_OPENCL_PROGRAM_HPP
 
 #include <map>
+#include <mutex>
 #include <memory>
+#include <vector>
 
 #include "caf/ref_counted.hpp"
 
 #include "caf/opencl/device.hpp"
 #include "caf/opencl/global.hpp"
+#include "caf/opencl/host_pool.hpp"
 
 #include "caf/opencl/detail/raw_ptr.hpp"
 
@@ -40,22 +43,54 @@ using program_ptr = intrusive_ptr<program>;
 class program : public ref_counted {
 public:
   friend class manager;
+  friend class program_family;
   template <bool PassConfig, class... Ts>
   friend class actor_facade;
   template <class T, class... Ts>
   friend intrusive_ptr<T> caf::make_counted(Ts&&...);
 
+  /// Returns the device that actors spawned from this program run on.
+  inline const device_ptr& get_device() const {
+    return device_;
+  }
+
+  /// Returns all devices the program has been built for.
+  inline const std::vector<device_ptr>& devices() const {
+    return devices_;
+  }
+
+  /// Returns a program that shares the build of this program, but spawns
+  /// actors on `dev`.
+  /// @throws std::runtime_error if the program was not built for `dev`.
+  program_ptr for_device(const device_ptr& dev);
+
+  /// Returns the compiled binary of the program for its device, which
+  /// `manager::create_program_from_binary` accepts on the same device and
+  /// driver.
+  /// @throws std::runtime_error if querying the binary fails.
+  std::vector<unsigned char> binary() const;
+
 private:
-  program(detail::raw_context_ptr context, detail::raw_command_queue_ptr queue,
-          detail::raw_program_ptr prog,
-          std::map<std::string, detail::raw_kernel_ptr> available_kernels);
+  program(device_ptr dev, detail::raw_context_ptr context,
+          detail::raw_command_queue_ptr queue, detail::raw_program_ptr prog,
+          std::map<std::string, detail::raw_kernel_ptr> available_kernels,
+          host_pool_ptr pool, std::vector<device_ptr> devices);
 
   ~program();
 
+  /// Returns the kernel `name`. Hands out each kernel created along with the
+  /// program once and creates new kernels afterwards, because actors set
+  /// their kernel arguments independently of each other.
+  detail::raw_kernel_ptr kernel(const char* name);
+
+  device_ptr device_;
   detail::raw_context_ptr context_;
   detail::raw_program_ptr program_;
   detail::raw_command_queue_ptr queue_;
+  std::mutex kernels_mtx_;
   std::map<std::string, detail::raw_kernel_ptr> available_kernels_;
+  host_pool_ptr pool_;
+  std::vector<device_ptr> devices_;
 };
 
 } // namespace opencl
@@ -0,0 +1,125 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_PROGRAM_FAMILY_HPP
+#define CAF_OPENCL_PROGRAM_FAMILY_HPP
+
+#include <map>
+#include <list>
+#include <mutex>
+#include <future>
+#include <string>
+#include <unordered_map>
+
+#include "caf/ref_counted.hpp"
+
+#include "caf/opencl/device.hpp"
+#include "caf/opencl/program.hpp"
+#include "caf/opencl/host_pool.hpp"
+
+#include "caf/opencl/detail/raw_ptr.hpp"
+
+namespace caf {
+namespace opencl {
+
+/// Preprocessor definitions for a program variant, e.g., `{"TILE", "16"}`
+/// adds `-D TILE=16` to the build options. Empty values omit the `=`.
+using defines = std::map<std::string, std::string>;
+
+class program_family;
+using program_family_ptr = intrusive_ptr<program_family>;
+
+/// Compiles variants of one source on demand, each with a different set of
+/// preprocessor definitions. Keeps up to `max_variants` variants in memory
+/// and stores their binaries in the program cache directory if configured.
+class program_family : public ref_counted {
+public:
+  friend class manager;
+  template <class T, class... Ts>
+  friend intrusive_ptr<T> caf::make_counted(Ts&&...);
+
+  /// Counters for the lookups of variants.
+  struct statistics {
+    size_t hits;      // variants found in memory
+    size_t loads;     // variants loaded from the disk cache
+    size_t builds;    // variants compiled from source
+    size_t evictions; // variants dropped to stay within `max_variants`
+  };
+
+  /// Returns the variant for `xs`, loading or compiling it on first use.
+  /// Blocks while the variant is compiling.
+  /// @throws std::runtime_error if compiling the variant fails.
+  program_ptr variant(const defines& xs);
+
+  /// Returns the build options of the variant for `xs`.
+  std::string build_options(const defines& xs) const;
+
+  /// Returns the number of variants currently kept in memory.
+  size_t live_variants() const;
+
+  /// Returns the counters for the lookups of variants.
+  statistics stats() const;
+
+  inline size_t max_variants() const {
+    return max_variants_;
+  }
+
+  inline const device_ptr& get_device() const {
+    return device_;
+  }
+
+private:
+  program_family(std::string source, std::string options, device_ptr dev,
+                 size_t max_variants, std::string cache_dir,
+                 host_pool_ptr pool);
+
+  ~program_family();
+
+  program_ptr build(const std::string& options);
+
+  /// Returns the path of the cached binary for `options`.
+  std::string cache_path(const std::string& options) const;
+
+  /// Loads the binary at `path`, returns `nullptr` if none exists or the
+  /// device rejects it.
+  program_ptr load(const std::string& path, const std::string& options);
+
+  /// Writes the binary of `prog` to `path`, ignoring any errors.
+  void store(const program_ptr& prog, const std::string& path);
+
+  using entry = std::pair<std::string, program_ptr>;
+
+  std::string source_;
+  std::string options_;
+  device_ptr device_;
+  size_t max_variants_;
+  std::string cache_dir_;
+  host_pool_ptr pool_;
+  mutable std::mutex mtx_;
+  std::list<entry> variants_; // most recently used first
+  std::unordered_map<std::string, std::list<entry>::iterator> index_;
+  // variants in progress, completed once loaded or compiled
+  std::unordered_map<std::string, std::shared_future<program_ptr>> building_;
+  statistics stats_;
+};
+
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_PROGRAM_FAMILY_HPP
@@ -0,0 +1,509 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+
+#ifndef CAF_OPENCL_RADIX_SORT_HPP
+#define CAF_OPENCL_RADIX_SORT_HPP
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <type_traits>
+
+#include "caf/unit.hpp"
+#include "caf/actor_system.hpp"
+#include "caf/event_based_actor.hpp"
+
+#include "caf/opencl/scan.hpp"
+#include "caf/opencl/device.hpp"
+#include "caf/opencl/manager.hpp"
+#include "caf/opencl/mem_ref.hpp"
+#include "caf/opencl/nd_range.hpp"
+#include "caf/opencl/arguments.hpp"
+
+#include "caf/opencl/detail/cl_type.hpp"
+#include "caf/opencl/detail/group_size.hpp"
+
+namespace caf {
+namespace opencl {
+
+/// Tuning parameters of a radix sort, chosen per device.
+struct radix_sort_options {
+  /// Number of key bits sorted per pass, between 1 and 8. Wider digits
+  /// require fewer passes but more local work per pass.
+  cl_uint digit_bits = 4;
+  /// Number of work items per group. The default of 0 selects the largest
+  /// power of two up to 256 the device supports.
+  size_t group_size = 0;
+};
+
+namespace detail {
+
+/// Maps a key type to an OpenCL C function `key_bits` that converts keys to
+/// unsigned integers of the same width with the same order.
+template <class T>
+struct radix_key;
+
+template <>
+struct radix_key<cl_uint> {
+  static const char* source() {
+    return "uint key_bits(K x) { return x; }\n";
+  }
+};
+
+template <>
+struct radix_key<cl_int> {
+  static const char* source() {
+    return "uint key_bits(K x) { return as_uint(x) ^ 0x80000000u; }\n";
+  }
+};
+
+template <>
+struct radix_key<cl_ulong> {
+  static const char* source() {
+    return "ulong key_bits(K x) { return x; }\n";
+  }
+};
+
+template <>
+struct radix_key<cl_long> {
+  static const char* source() {
+    return "ulong key_bits(K x) {\n"
+           "  return as_ulong(x) ^ 0x8000000000000000ul;\n"
+           "}\n";
+  }
+};
+
+// flips all bits of negative numbers and only the sign bit of positive ones
+template <>
+struct radix_key<cl_float> {
+  static const char* source() {
+    return "uint key_bits(K x) {\n"
+           "  uint u = as_uint(x);\n"
+           "  return u ^ (-(u >> 31) | 0x80000000u);\n"
+           "}\n";
+  }
+};
+
+template <>
+struct radix_key<cl_double> {
+  static const char* source() {
+    return "ulong key_bits(K x) {\n"
+           "  ulong u = as_ulong(x);\n"
+           "  return u ^ (-(u >> 63) | 0x8000000000000000ul);\n"
+           "}\n";
+  }
+};
+
+/// Returns the source of the radix sort kernels for keys of type `K` and,
+/// if `with_values` is set, values of type `V` defined in the `prelude`.
+std::string radix_sort_source(const std::string& prelude,
+                              const char* key_bits, cl_uint digit_bits,
+                              bool with_values);
+
+/// Coordinates the passes of a radix sort. Each pass counts the digits of
+/// each tile of the input, scans the counts to get the output offset of each
+/// digit per tile and scatters the keys, and values if present, to their
+/// offsets. Sorting keys without values sets `V` to `unit_t`.
+template <class K, class V, class TagIn, class TagOut>
+class radix_sort_actor : public event_based_actor {
+public:
+  using kref = mem_ref<K>;
+  using vref = mem_ref<V>;
+  using uref = mem_ref<cl_uint>;
+  using with_values = std::integral_constant<
+    bool, !std::is_same<V, unit_t>::value
+  >;
+  using by_value = std::is_same<TagOut, val>;
+  using key_input = typename std::conditional<
+    std::is_same<TagIn, val>::value, std::vector<K>, kref
+  >::type;
+  using value_input = typename std::conditional<
+    std::is_same<TagIn, val>::value, std::vector<V>, vref
+  >::type;
+
+  radix_sort_actor(actor_config& cfg, device_ptr dev, actor count,
+                   actor scan, actor scatter, actor fetch, cl_uint digit_bits)
+      : event_based_actor(cfg),
+        dev_(std::move(dev)),
+        count_(std::move(count)),
+        scan_(std::move(scan)),
+        scatter_(std::move(scatter)),
+        fetch_(std::move(fetch)),
+        digit_bits_(digit_bits) {
+    // nop
+  }
+
+  const char* name() const override {
+    return "OpenCL radix sort";
+  }
+
+  behavior make_behavior() override {
+    return make_behavior(with_values{});
+  }
+
+private:
+  behavior make_behavior(std::false_type) {
+    return {
+      [=](key_input& keys) {
+        auto rp = this->make_response_promise();
+        auto n = static_cast<cl_uint>(keys.size());
+        if (n == 0) {
+          deliver(rp, kref{}, vref{}, with_values{}, by_value{});
+          return;
+        }
+        pass(upload(keys), vref{}, n, 0, rp);
+      }
+    };
+  }
+
+  behavior make_behavior(std::true_type) {
+    return {
+      [=](key_input& keys, value_input& values) {
+        auto rp = this->make_response_promise();
+        if (keys.size() != values.size()) {
+          rp.deliver(make_error(sec::runtime_error,
+                                "Keys and values differ in size."));
+          return;
+        }
+        auto n = static_cast<cl_uint>(keys.size());
+        if (n == 0) {
+          deliver(rp, kref{}, vref{}, with_values{}, by_value{});
+          return;
+        }
+        pass(upload(keys), upload(values), n, 0, rp);
+      }
+    };
+  }
+
+  template <class T>
+  mem_ref<T> upload(std::vector<T>& xs) {
+    return dev_->global_argument(xs);
+  }
+
+  template <class T>
+  mem_ref<T> upload(mem_ref<T>& xs) {
+    return std::move(xs);
+  }
+
+  // sorts by the digit starting at bit `shift`, then continues with the next
+  void pass(kref keys, vref values, cl_uint n, cl_uint shift,
+            response_promise rp) {
+    if (shift >= sizeof(K) * 8) {
+      deliver(rp, std::move(keys), std::move(values), with_values{},
+              by_value{});
+      return;
+    }
+    auto on_error = [=](error& err) mutable {
+      rp.deliver(std::move(err));
+    };
+    this->request(count_, infinite, keys, n, shift).then(
+      [=](uref& counts) mutable {
+        this->request(scan_, infinite, std::move(counts)).then(
+          [=](uref& offsets) mutable {
+            scatter(keys, values, offsets, n, shift, rp, with_values{});
+          },
+          on_error
+        );
+      },
+      on_error
+    );
+  }
+
+  void scatter(kref& keys, vref&, uref& offsets, cl_uint n, cl_uint shift,
+               response_promise& rp, std::false_type) {
+    auto next = shift + digit_bits_;
+    this->request(scatter_, infinite, std::move(keys), std::move(offsets),
+                  n, shift).then(
+      [=](kref& sorted) mutable {
+        pass(std::move(sorted), vref{}, n, next, rp);
+      },
+      [=](error& err) mutable {
+        rp.deliver(std::move(err));
+      }
+    );
+  }
+
+  void scatter(kref& keys, vref& values, uref& offsets, cl_uint n,
+               cl_uint shift, response_promise& rp, std::true_type) {
+    auto next = shift + digit_bits_;
+    this->request(scatter_, infinite, std::move(keys), std::move(values),
+                  std::move(offsets), n, shift).then(
+      [=](kref& sorted_keys, vref& sorted_values) mutable {
+        pass(std::move(sorted_keys), std::move(sorted_values), n, next, rp);
+      },
+      [=](error& err) mutable {
+        rp.deliver(std::move(err));
+      }
+    );
+  }
+
+  void deliver(response_promise& rp, kref keys, vref,
+               std::false_type, std::false_type) {
+    rp.deliver(std::move(keys));
+  }
+
+  void deliver(response_promise& rp, kref keys, vref values,
+               std::true_type, std::false_type) {
+    rp.deliver(std::move(keys), std::move(values));
+  }
+
+  void deliver(response_promise& rp, kref keys, vref,
+               std::false_type, std::true_type) {
+    if (!keys) {
+      rp.deliver(std::vector<K>{});
+      return;
+    }
+    this->request(fetch_, infinite, std::move(keys)).then(
+      [=](std::vector<K>& xs) mutable {
+        rp.deliver(std::move(xs));
+      },
+      [=](error& err) mutable {
+        rp.deliver(std::move(err));
+      }
+    );
+  }
+
+  void deliver(response_promise& rp, kref keys, vref values,
+               std::true_type, std::true_type) {
+    if (!keys) {
+      rp.deliver(std::vector<K>{}, std::vector<V>{});
+      return;
+    }
+    this->request(fetch_, infinite, std::move(keys), std::move(values)).then(
+      [=](std::vector<K>& xs, std::vector<V>& ys) mutable {
+        rp.deliver(std::move(xs), std::move(ys));
+      },
+      [=](error& err) mutable {
+        rp.deliver(std::move(err));
+      }
+    );
+  }
+
+  device_ptr dev_;
+  actor count_;
+  actor scan_;
+  actor scatter_;
+  actor fetch_;
+  cl_uint digit_bits_;
+};
+
+/// Checks `opts` against the limits of `dev` and returns the group size.
+inline size_t radix_group_size(const device_ptr& dev,
+                               const radix_sort_options& opts) {
+  if (opts.digit_bits < 1 || opts.digit_bits > 8) {
+    std::ostringstream oss;
+    oss << "radix sort: digit width of " << opts.digit_bits
+        << " bits not in [1, 8]";
+    throw std::runtime_error(oss.str());
+  }
+  // each work item holds its digit, its position and a scan element
+  if (opts.group_size == 0)
+    return group_size(dev, 3 * sizeof(cl_uint));
+  if (opts.group_size > dev->max_work_group_size()
+      || opts.group_size > dev->max_work_item_sizes()[0]) {
+    std::ostringstream oss;
+    oss << "radix sort: group size " << opts.group_size
+        << " exceeds the limits of device " << dev->name();
+    throw std::runtime_error(oss.str());
+  }
+  return opts.group_size;
+}
+
+template <class V>
+std::string radix_value_prelude() {
+  return cl_type_prelude<V>("V");
+}
+
+template <>
+inline std::string radix_value_prelude<unit_t>() {
+  return "";
+}
+
+/// Spawns the kernels that scatter and fetch keys only.
+template <class K, class V, class Range, class Tile>
+void spawn_radix_scatter(manager& mngr, const program_ptr& prog,
+                         size_t group_size, size_t radix, Range range_for,
+                         Tile tile, actor& scatter, actor& fetch,
+                         std::false_type) {
+  using kref = mem_ref<K>;
+  using uref = mem_ref<cl_uint>;
+  using map_fun = std::function<optional<message> (nd_range&, message&)>;
+  map_fun map_scatter = [=](nd_range& range, message& msg) {
+    return msg.apply([&](kref& keys, uref& offsets, cl_uint n,
+                         cl_uint shift) {
+      range = range_for(n);
+      return make_message(std::move(keys), std::move(offsets), n, shift,
+                          tile(n));
+    });
+  };
+  scatter = mngr.spawn(
+    prog, "radix_scatter", range_for(1), map_scatter,
+    in<K, mref>{},
+    out<K, mref>{[](kref&, uref&, cl_uint n, cl_uint, cl_uint) {
+      return size_t{n};
+    }},
+    in<cl_uint, mref>{},
+    local<cl_uint>{group_size},
+    local<cl_uint>{group_size},
+    local<cl_uint>{group_size},
+    local<cl_uint>{2 * radix},
+    priv<cl_uint, val>{},
+    priv<cl_uint, val>{},
+    priv<cl_uint, val>{}
+  );
+  fetch = mngr.spawn(prog, "radix_fetch", nd_range{dim_vec{1}},
+                     in_out<K, mref, val>{});
+}
+
+/// Spawns the kernels that scatter and fetch keys along with their values.
+template <class K, class V, class Range, class Tile>
+void spawn_radix_scatter(manager& mngr, const program_ptr& prog,
+                         size_t group_size, size_t radix, Range range_for,
+                         Tile tile, actor& scatter, actor& fetch,
+                         std::true_type) {
+  using kref = mem_ref<K>;
+  using vref = mem_ref<V>;
+  using uref = mem_ref<cl_uint>;
+  using map_fun = std::function<optional<message> (nd_range&, message&)>;
+  map_fun map_scatter = [=](nd_range& range, message& msg) {
+    return msg.apply([&](kref& keys, vref& values, uref& offsets,
+                         cl_uint n, cl_uint shift) {
+      range = range_for(n);
+      return make_message(std::move(keys), std::move(values),
+                          std::move(offsets), n, shift, tile(n));
+    });
+  };
+  auto len = [](kref&, vref&, uref&, cl_uint n, cl_uint, cl_uint) {
+    return size_t{n};
+  };
+  scatter = mngr.spawn(
+    prog, "radix_scatter", range_for(1), map_scatter,
+    in<K, mref>{},
+    out<K, mref>{len},
+    in<V, mref>{},
+    out<V, mref>{len},
+    in<cl_uint, mref>{},
+    local<cl_uint>{group_size},
+    local<cl_uint>{group_size},
+    local<cl_uint>{group_size},
+    local<cl_uint>{2 * radix},
+    priv<cl_uint, val>{},
+    priv<cl_uint, val>{},
+    priv<cl_uint, val>{}
+  );
+  fetch = mngr.spawn(prog, "radix_fetch_pairs", nd_range{dim_vec{1}},
+                     in_out<K, mref, val>{}, in_out<V, mref, val>{});
+}
+
+/// Spawns the actors for counting, scanning, scattering and fetching keys of
+/// type `K` and, unless `V` is `unit_t`, values of type `V`.
+template <class K, class V, class TagIn, class TagOut>
+actor spawn_radix_sort_actor(actor_system& sys, const device_ptr& dev,
+                             const radix_sort_options& opts) {
+  using kref = mem_ref<K>;
+  using map_fun = std::function<optional<message> (nd_range&, message&)>;
+  constexpr bool with_values = !std::is_same<V, unit_t>::value;
+  // upper bound for the number of tiles, more tiles only add counters
+  constexpr size_t max_groups = 1024;
+  auto& mngr = sys.opencl_manager();
+  auto group_size = radix_group_size(dev, opts);
+  auto radix = size_t{1} << opts.digit_bits;
+  auto prelude = cl_type_prelude<K>("K") + radix_value_prelude<V>();
+  auto source = radix_sort_source(prelude, radix_key<K>::source(),
+                                  opts.digit_bits, with_values);
+  auto prog = mngr.create_program(source.c_str(), "", dev);
+  auto groups = [=](cl_uint n) -> size_t {
+    auto required = (n + group_size - 1) / group_size;
+    return std::max(size_t{1}, std::min(required, max_groups));
+  };
+  // each group processes a tile of the input in steps of `group_size`
+  auto tile = [=](cl_uint n) -> cl_uint {
+    auto per_group = (n + groups(n) - 1) / groups(n);
+    auto steps = (per_group + group_size - 1) / group_size;
+    return static_cast<cl_uint>(steps * group_size);
+  };
+  auto range_for = [=](cl_uint n) {
+    return nd_range{dim_vec{groups(n) * group_size}, {}, dim_vec{group_size}};
+  };
+  auto ndr = range_for(1);
+  map_fun map_count = [=](nd_range& range, message& msg) {
+    return msg.apply([&](kref& keys, cl_uint n, cl_uint shift) {
+      range = range_for(n);
+      return make_message(std::move(keys), n, shift, tile(n));
+    });
+  };
+  auto count = mngr.spawn(
+    prog, "radix_count", ndr, map_count,
+    in<K, mref>{},
+    out<cl_uint, mref>{[=](kref&, cl_uint n, cl_uint, cl_uint) {
+      return radix * groups(n);
+    }},
+    local<cl_uint>{radix},
+    priv<cl_uint, val>{},
+    priv<cl_uint, val>{},
+    priv<cl_uint, val>{}
+  );
+  auto scan = spawn_scan(sys, dev, in_out<cl_uint, mref, mref>{});
+  actor scatter;
+  actor fetch;
+  spawn_radix_scatter<K, V>(mngr, prog, group_size, radix, range_for, tile,
+                            scatter, fetch,
+                            std::integral_constant<bool, with_values>{});
+  return sys.spawn<radix_sort_actor<K, V, TagIn, TagOut>>(
+    dev, std::move(count), std::move(scan), std::move(scatter),
+    std::move(fetch), opts.digit_bits
+  );
+}
+
+} // namespace detail
+
+/// Spawns an actor that sorts a `std::vector<K>` or `mem_ref<K>`, depending
+/// on `TagIn`, in ascending order and responds with a `std::vector<K>` or
+/// `mem_ref<K>`, depending on `TagOut`. Keys may be 32 or 64 bit integers or
+/// floating point numbers. The sort is stable and never modifies its input.
+/// @throws std::runtime_error if `opts` exceed the device limits or
+///                            compiling the kernels fails.
+template <class K, class TagIn, class TagOut>
+actor spawn_radix_sort(actor_system& sys, const device_ptr& dev,
+                       in_out<K, TagIn, TagOut>,
+                       const radix_sort_options& opts = {}) {
+  return detail::spawn_radix_sort_actor<K, unit_t, TagIn, TagOut>(sys, dev,
+                                                                   opts);
+}
+
+/// Spawns an actor that sorts pairs of keys of type `K` and values of type
+/// `V`, both passed as `std::vector` or `mem_ref` of equal size, by key and
+/// responds with the sorted keys and values.
+/// @throws std::runtime_error if `opts` exceed the device limits or
+///                            compiling the kernels fails.
+template <class K, class V, class TagIn, class TagOut>
+actor spawn_radix_sort(actor_system& sys, const device_ptr& dev,
+                       in_out<K, TagIn, TagOut>, in_out<V, TagIn, TagOut>,
+                       const radix_sort_options& opts = {}) {
+  return detail::spawn_radix_sort_actor<K, V, TagIn, TagOut>(sys, dev, opts);
+}
+
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_RADIX_SORT_HPP
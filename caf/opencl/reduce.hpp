@@ -0,0 +1,128 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_REDUCE_HPP
+#define CAF_OPENCL_REDUCE_HPP
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+#include "caf/actor_system.hpp"
+
+#include "caf/opencl/device.hpp"
+#include "caf/opencl/manager.hpp"
+#include "caf/opencl/mem_ref.hpp"
+#include "caf/opencl/nd_range.hpp"
+#include "caf/opencl/arguments.hpp"
+#include "caf/opencl/binary_op.hpp"
+
+#include "caf/opencl/detail/cl_type.hpp"
+#include "caf/opencl/detail/pad_empty.hpp"
+#include "caf/opencl/detail/group_size.hpp"
+
+namespace caf {
+namespace opencl {
+
+namespace detail {
+
+/// Returns the source of the reduction kernel for the type `T` defined in the
+/// `prelude`, combining elements with `op`.
+std::string reduce_source(const std::string& prelude, const binary_op& op);
+
+} // namespace detail
+
+/// Spawns an actor that reduces a `std::vector<T>` or `mem_ref<T>`,
+/// depending on `TagIn`, to a single value using `op`, which must be
+/// associative and commutative. The actor responds with a scalar `T` for
+/// `out<T, val>` and with a one-element `mem_ref<T>` for `out<T, mref>`.
+/// Each work item first combines a strided range of the input, then each
+/// group combines the results of its items in local memory. A second pass
+/// combines the results of all groups within a single group.
+/// @throws std::runtime_error if compiling the kernel fails.
+template <class T, class TagIn, class TagOut>
+actor spawn_reduce(actor_system& sys, const device_ptr& dev, in<T, TagIn>,
+                   out<T, TagOut>, const binary_op& op = binary_op::plus()) {
+  using ref = mem_ref<T>;
+  using input_type = typename std::conditional<
+    std::is_same<TagIn, val>::value, std::vector<T>, ref
+  >::type;
+  using map_fun = std::function<optional<message> (nd_range&, message&)>;
+  auto& mngr = sys.opencl_manager();
+  auto source = detail::reduce_source(detail::cl_type_prelude<T>("T"), op);
+  auto prog = mngr.create_program(source.c_str(), "", dev);
+  auto group_size = detail::group_size(dev, sizeof(T));
+  // the second pass combines one partial result per work item of a group
+  auto groups = [=](cl_uint n) -> size_t {
+    auto required = (n + group_size - 1) / group_size;
+    return std::max(size_t{1}, std::min(required, group_size));
+  };
+  auto single_group = nd_range{dim_vec{group_size}, {}, dim_vec{group_size}};
+  map_fun map_first = [=](nd_range& range, message& msg) {
+    return msg.apply([&](input_type& xs) {
+      auto n = static_cast<cl_uint>(xs.size());
+      range = nd_range{dim_vec{groups(n) * group_size}, {},
+                       dim_vec{group_size}};
+      detail::pad_empty(xs);
+      return make_message(std::move(xs), n);
+    });
+  };
+  map_fun map_second = [=](nd_range&, message& msg) {
+    return msg.apply([&](ref& partials) {
+      auto n = static_cast<cl_uint>(partials.size());
+      return make_message(std::move(partials), n);
+    });
+  };
+  auto first = mngr.spawn(
+    prog, "reduce", single_group, map_first,
+    in<T, TagIn>{},
+    out<T, mref>{[=](input_type&, cl_uint n) { return groups(n); }},
+    local<T>{group_size},
+    priv<cl_uint, val>{}
+  );
+  actor second;
+  if (std::is_same<TagOut, val>::value) {
+    std::function<message (std::vector<T>&)> unbox = [](std::vector<T>& xs) {
+      return make_message(xs.front());
+    };
+    second = mngr.spawn(
+      prog, "reduce", single_group, map_second, unbox,
+      in<T, mref>{},
+      out<T, val>{[](ref&, cl_uint) { return size_t{1}; }},
+      local<T>{group_size},
+      priv<cl_uint, val>{}
+    );
+  } else {
+    second = mngr.spawn(
+      prog, "reduce", single_group, map_second,
+      in<T, mref>{},
+      out<T, mref>{[](ref&, cl_uint) { return size_t{1}; }},
+      local<T>{group_size},
+      priv<cl_uint, val>{}
+    );
+  }
+  return second * first;
+}
+
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_REDUCE_HPP
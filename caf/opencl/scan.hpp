@@ -0,0 +1,231 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_SCAN_HPP
+#define CAF_OPENCL_SCAN_HPP
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <type_traits>
+
+#include "caf/actor_system.hpp"
+#include "caf/event_based_actor.hpp"
+
+#include "caf/opencl/device.hpp"
+#include "caf/opencl/manager.hpp"
+#include "caf/opencl/mem_ref.hpp"
+#include "caf/opencl/nd_range.hpp"
+#include "caf/opencl/arguments.hpp"
+#include "caf/opencl/binary_op.hpp"
+
+#include "caf/opencl/detail/cl_type.hpp"
+#include "caf/opencl/detail/group_size.hpp"
+
+namespace caf {
+namespace opencl {
+
+/// Selects whether the i-th result of a scan includes the i-th input.
+enum class scan_mode {
+  exclusive,
+  inclusive
+};
+
+namespace detail {
+
+/// Returns the source of the scan kernels for the type `T` defined in the
+/// `prelude`, combining elements with `op`.
+std::string scan_source(const std::string& prelude, const binary_op& op);
+
+/// Coordinates the kernels of a scan. Each level scans blocks of the input
+/// and collects the block sums, which the next level scans in turn until a
+/// single block remains. On the way back, each level adds the scanned block
+/// sums to its blocks.
+template <class T, class TagIn, class TagOut>
+class scan_actor : public event_based_actor {
+public:
+  using ref = mem_ref<T>;
+  using vec = std::vector<T>;
+  using input_type = typename std::conditional<
+    std::is_same<TagIn, val>::value, vec, ref
+  >::type;
+  using continuation = std::function<void (ref&)>;
+
+  scan_actor(actor_config& cfg, device_ptr dev, actor scan_blocks,
+             actor add_sums, actor fetch, scan_mode mode)
+      : event_based_actor(cfg),
+        dev_(std::move(dev)),
+        scan_blocks_(std::move(scan_blocks)),
+        add_sums_(std::move(add_sums)),
+        fetch_(std::move(fetch)),
+        inclusive_(mode == scan_mode::inclusive ? 1u : 0u) {
+    // nop
+  }
+
+  const char* name() const override {
+    return "OpenCL scan";
+  }
+
+  behavior make_behavior() override {
+    return {
+      [=](input_type& xs) {
+        auto rp = this->make_response_promise();
+        auto n = static_cast<cl_uint>(xs.size());
+        if (n == 0) {
+          deliver_empty(rp, std::is_same<TagOut, val>{});
+          return;
+        }
+        scan(upload(xs), n, inclusive_, rp, [=](ref& result) mutable {
+          deliver(rp, result, std::is_same<TagOut, val>{});
+        });
+      }
+    };
+  }
+
+private:
+  ref upload(vec& xs) {
+    return dev_->global_argument(xs);
+  }
+
+  ref upload(ref& xs) {
+    return std::move(xs);
+  }
+
+  void deliver_empty(response_promise& rp, std::false_type) {
+    rp.deliver(ref{});
+  }
+
+  void deliver_empty(response_promise& rp, std::true_type) {
+    rp.deliver(vec{});
+  }
+
+  void deliver(response_promise& rp, ref& result, std::false_type) {
+    rp.deliver(std::move(result));
+  }
+
+  void deliver(response_promise& rp, ref& result, std::true_type) {
+    this->request(fetch_, infinite, std::move(result)).then(
+      [=](vec& ys) mutable {
+        rp.deliver(std::move(ys));
+      },
+      [=](error& err) mutable {
+        rp.deliver(std::move(err));
+      }
+    );
+  }
+
+  // scans the first `n` elements of `data` in place and calls `k` afterwards
+  void scan(ref data, cl_uint n, cl_uint inclusive, response_promise rp,
+            continuation k) {
+    auto on_error = [=](error& err) mutable {
+      rp.deliver(std::move(err));
+    };
+    this->request(scan_blocks_, infinite, std::move(data), n, inclusive).then(
+      [=](ref& scanned, ref& sums) mutable {
+        if (sums.size() == 1) {
+          k(scanned);
+          return;
+        }
+        auto groups = static_cast<cl_uint>(sums.size());
+        scan(std::move(sums), groups, 0u, rp, [=](ref& increments) mutable {
+          this->request(add_sums_, infinite, std::move(scanned),
+                        std::move(increments), n).then(
+            [=](ref& result) mutable {
+              k(result);
+            },
+            on_error
+          );
+        });
+      },
+      on_error
+    );
+  }
+
+  device_ptr dev_;
+  actor scan_blocks_;
+  actor add_sums_;
+  actor fetch_;
+  cl_uint inclusive_;
+};
+
+} // namespace detail
+
+/// Spawns an actor that computes the prefix sums of a `std::vector<T>` or
+/// `mem_ref<T>`, depending on `TagIn`, and responds with a `std::vector<T>`
+/// or `mem_ref<T>`, depending on `TagOut`. The scan supports any input
+/// length and any associative `op`. Inputs passed as `mem_ref` are scanned
+/// in place.
+/// @throws std::runtime_error if compiling the kernels fails.
+template <class T, class TagIn, class TagOut>
+actor spawn_scan(actor_system& sys, const device_ptr& dev,
+                 in_out<T, TagIn, TagOut>,
+                 scan_mode mode = scan_mode::exclusive,
+                 const binary_op& op = binary_op::plus()) {
+  using ref = mem_ref<T>;
+  using map_fun = std::function<optional<message> (nd_range&, message&)>;
+  auto& mngr = sys.opencl_manager();
+  auto source = detail::scan_source(detail::cl_type_prelude<T>("T"), op);
+  auto prog = mngr.create_program(source.c_str(), "", dev);
+  // each work item scans two elements
+  auto group_size = detail::group_size(dev, 2 * sizeof(T));
+  auto block_size = 2 * group_size;
+  auto groups = [=](cl_uint n) -> size_t {
+    return (n + block_size - 1) / block_size;
+  };
+  auto range_for = [=](cl_uint n) {
+    return nd_range{dim_vec{groups(n) * group_size}, {}, dim_vec{group_size}};
+  };
+  auto ndr = range_for(1);
+  map_fun map_scan_blocks = [=](nd_range& range, message& msg) {
+    msg.apply([&](ref&, cl_uint n, cl_uint) {
+      range = range_for(n);
+    });
+    return optional<message>{std::move(msg)};
+  };
+  map_fun map_add_sums = [=](nd_range& range, message& msg) {
+    msg.apply([&](ref&, ref&, cl_uint n) {
+      range = range_for(n);
+    });
+    return optional<message>{std::move(msg)};
+  };
+  auto scan_blocks = mngr.spawn(
+    prog, "scan_blocks", ndr, map_scan_blocks,
+    in_out<T, mref, mref>{},
+    out<T, mref>{[=](ref&, cl_uint n, cl_uint) { return groups(n); }},
+    local<T>{block_size},
+    priv<cl_uint, val>{},
+    priv<cl_uint, val>{}
+  );
+  auto add_sums = mngr.spawn(
+    prog, "scan_add", ndr, map_add_sums,
+    in_out<T, mref, mref>{},
+    in<T, mref>{},
+    priv<cl_uint, val>{}
+  );
+  auto fetch = mngr.spawn(prog, "scan_fetch", nd_range{dim_vec{1}},
+                          in_out<T, mref, val>{});
+  return sys.spawn<detail::scan_actor<T, TagIn, TagOut>>(
+    dev, std::move(scan_blocks), std::move(add_sums), std::move(fetch), mode
+  );
+}
+
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_SCAN_HPP
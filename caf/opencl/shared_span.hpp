@@ -0,0 +1,153 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_SHARED_SPAN_HPP
+#define CAF_OPENCL_SHARED_SPAN_HPP
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <type_traits>
+
+#include "caf/allowed_unsafe_message_type.hpp"
+
+namespace caf {
+namespace opencl {
+
+/// An immutable, reference-counted view on host memory. Copies share the
+/// memory, i.e., sending a `shared_span` to several actors never copies its
+/// elements. The span either owns a vector or wraps external memory, such as
+/// a memory-mapped file or pinned staging memory, and releases it once the
+/// last copy goes out of scope.
+template <class T>
+class shared_span {
+public:
+  using value_type = T;
+  using const_iterator = const T*;
+
+  shared_span() : data_(nullptr), size_(0) {
+    // nop
+  }
+
+  /// Takes ownership of `xs`.
+  explicit shared_span(std::vector<T> xs) {
+    auto ptr = std::make_shared<const std::vector<T>>(std::move(xs));
+    data_ = ptr->data();
+    size_ = ptr->size();
+    owner_ = std::move(ptr);
+  }
+
+  /// Wraps `size` elements at `data` and calls `release` once no span refers
+  /// to the memory anymore, e.g., to unmap a file.
+  shared_span(const T* data, size_t size, std::function<void ()> release)
+      : data_(data),
+        size_(size),
+        owner_(data, [release](const void*) {
+          if (release)
+            release();
+        }) {
+    // nop
+  }
+
+  /// Wraps `size` elements at `data` that `owner` keeps alive.
+  shared_span(const T* data, size_t size, std::shared_ptr<const void> owner)
+      : data_(data),
+        size_(size),
+        owner_(std::move(owner)) {
+    // nop
+  }
+
+  shared_span(shared_span&&) = default;
+  shared_span(const shared_span&) = default;
+  shared_span& operator=(shared_span&&) = default;
+  shared_span& operator=(const shared_span&) = default;
+
+  inline const T* data() const {
+    return data_;
+  }
+
+  inline size_t size() const {
+    return size_;
+  }
+
+  inline bool empty() const {
+    return size_ == 0;
+  }
+
+  inline const_iterator begin() const {
+    return data_;
+  }
+
+  inline const_iterator end() const {
+    return data_ + size_;
+  }
+
+  inline const T& operator[](size_t pos) const {
+    return data_[pos];
+  }
+
+  /// Returns `count` elements starting at `offset` that share the memory.
+  /// @throws std::out_of_range if the range exceeds this span.
+  shared_span subspan(size_t offset, size_t count) const {
+    if (offset > size_ || count > size_ - offset)
+      throw std::out_of_range("shared_span::subspan");
+    return {data_ + offset, count, owner_};
+  }
+
+  /// Returns the number of spans sharing the memory.
+  inline long use_count() const {
+    return owner_.use_count();
+  }
+
+private:
+  const T* data_;
+  size_t size_;
+  std::shared_ptr<const void> owner_;
+};
+
+/// @relates shared_span
+template <class T>
+shared_span<T> make_shared_span(std::vector<T> xs) {
+  return shared_span<T>{std::move(xs)};
+}
+
+/// @relates shared_span
+template <class T>
+bool operator==(const shared_span<T>& x, const shared_span<T>& y) {
+  return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
+}
+
+/// @relates shared_span
+template <class T>
+bool operator!=(const shared_span<T>& x, const shared_span<T>& y) {
+  return !(x == y);
+}
+
+} // namespace opencl
+
+template <class T>
+struct allowed_unsafe_message_type<opencl::shared_span<T>> : std::true_type {};
+
+} // namespace caf
+
+#endif // CAF_OPENCL_SHARED_SPAN_HPP
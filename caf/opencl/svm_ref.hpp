@@ -0,0 +1,189 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_SVM_REF_HPP
+#define CAF_OPENCL_SVM_REF_HPP
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+#include "caf/sec.hpp"
+#include "caf/error.hpp"
+#include "caf/expected.hpp"
+#include "caf/ref_counted.hpp"
+#include "caf/intrusive_ptr.hpp"
+
+#include "caf/opencl/global.hpp"
+
+#include "caf/opencl/detail/raw_ptr.hpp"
+
+namespace caf {
+namespace opencl {
+
+namespace detail {
+
+class svm_block;
+using svm_block_ptr = intrusive_ptr<svm_block>;
+
+/// An allocation in shared virtual memory, released via `clSVMFree` once no
+/// `svm_ref` uses it anymore.
+class svm_block : public ref_counted {
+public:
+  svm_block(raw_context_ptr context, void* ptr, size_t bytes,
+            bool fine_grained);
+
+  ~svm_block() override;
+
+  /// Makes the allocation accessible on the host, blocking until all
+  /// commands enqueued to `queue` before completed.
+  error map(cl_command_queue queue, cl_map_flags flags);
+
+  /// Returns the allocation to the device, blocking until it completed.
+  error unmap(cl_command_queue queue);
+
+  inline void* ptr() const {
+    return ptr_;
+  }
+
+  inline size_t size() const {
+    return bytes_;
+  }
+
+  inline bool fine_grained() const {
+    return fine_grained_;
+  }
+
+private:
+  raw_context_ptr context_;
+  void* ptr_;
+  size_t bytes_;
+  bool fine_grained_;
+};
+
+} // namespace detail
+
+/// A reference to an allocation in shared virtual memory (SVM) of an OpenCL
+/// 2.0 device, created by `device::svm_argument`. The host and kernels use
+/// the same addresses, i.e., pointers stored in the allocation remain valid
+/// on both sides. Kernels access the allocation directly, hence an `svm_ref`
+/// carries no event. The host may dereference `data()` at any time for
+/// fine-grained allocations but only between `map` and `unmap` for
+/// coarse-grained allocations. Access is not thread safe. Hence, an `svm_ref`
+/// should only be passed to actors sequentially. Actors pass no allocations
+/// via `CL_KERNEL_EXEC_INFO_SVM_PTRS`, i.e., pointers that kernels follow
+/// must point into the same allocation or into another `svm_ref` of the
+/// same message.
+template <class T>
+class svm_ref {
+public:
+  using value_type = T;
+
+  svm_ref() : num_elements_(0) {
+    // nop
+  }
+
+  svm_ref(size_t num_elements, detail::raw_command_queue_ptr queue,
+          detail::svm_block_ptr block)
+      : num_elements_(num_elements),
+        queue_(std::move(queue)),
+        block_(std::move(block)) {
+    // nop
+  }
+
+  svm_ref(svm_ref&& other) = default;
+  svm_ref& operator=(svm_ref&& other) = default;
+  svm_ref(const svm_ref& other) = default;
+  svm_ref& operator=(const svm_ref& other) = default;
+
+  /// Returns the address of the first element on the host and the device.
+  inline T* data() const {
+    return block_ ? static_cast<T*>(block_->ptr()) : nullptr;
+  }
+
+  inline T* begin() const {
+    return data();
+  }
+
+  inline T* end() const {
+    return data() + num_elements_;
+  }
+
+  inline size_t size() const {
+    return num_elements_;
+  }
+
+  /// Returns whether the host may access the elements without `map`.
+  inline bool fine_grained() const {
+    return block_ && block_->fine_grained();
+  }
+
+  /// Makes a coarse-grained allocation accessible on the host until `unmap`,
+  /// waiting for all kernels enqueued before. Does nothing for fine-grained
+  /// allocations.
+  error map(cl_map_flags flags = CL_MAP_READ | CL_MAP_WRITE) {
+    if (!block_)
+      return make_error(sec::runtime_error, "No memory assigned.");
+    if (block_->fine_grained())
+      return none;
+    return block_->map(queue_.get(), flags);
+  }
+
+  /// Returns a coarse-grained allocation to the device. Does nothing for
+  /// fine-grained allocations.
+  error unmap() {
+    if (!block_)
+      return make_error(sec::runtime_error, "No memory assigned.");
+    if (block_->fine_grained())
+      return none;
+    return block_->unmap(queue_.get());
+  }
+
+  /// Copies the elements to a vector, mapping the allocation if necessary.
+  expected<std::vector<T>> values() {
+    auto err = map(CL_MAP_READ);
+    if (err)
+      return err;
+    std::vector<T> result(begin(), end());
+    err = unmap();
+    if (err)
+      return err;
+    return result;
+  }
+
+  void reset() {
+    num_elements_ = 0;
+    queue_.reset();
+    block_.reset();
+  }
+
+private:
+  size_t num_elements_;
+  detail::raw_command_queue_ptr queue_;
+  detail::svm_block_ptr block_;
+};
+
+} // namespace opencl
+
+template <class T>
+struct allowed_unsafe_message_type<opencl::svm_ref<T>> : std::true_type {};
+
+} // namespace caf
+
+#endif // CAF_OPENCL_SVM_REF_HPP
@@ -0,0 +1,218 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_VARIANT_FACADE_HPP
+#define CAF_OPENCL_VARIANT_FACADE_HPP
+
+#include <list>
+#include <mutex>
+#include <tuple>
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+
+#include "caf/all.hpp"
+
+#include "caf/opencl/nd_range.hpp"
+#include "caf/opencl/actor_facade.hpp"
+#include "caf/opencl/program_family.hpp"
+
+namespace caf {
+namespace opencl {
+
+/// Dispatches each message to an actor facade for the kernel of the program
+/// variant that the selector picks for the message. Facades are spawned on
+/// first use and at most `max_variants` of the family stay alive. Messages
+/// for a variant that is still compiling wait until its facade exists.
+template <class... Ts>
+class variant_facade : public monitorable_actor {
+public:
+  using impl = actor_facade<false, Ts...>;
+  using selector = std::function<defines (const message&)>;
+  using signature = std::tuple<typename std::decay<Ts>::type...>;
+
+  typename detail::il_indices<detail::type_list<Ts...>>::type indices;
+
+  const char* name() const override {
+    return "OpenCL variant actor";
+  }
+
+  static actor create(actor_config actor_conf, program_family_ptr family,
+                      const char* kernel_name, const nd_range& range,
+                      selector select, Ts&&... xs) {
+    if (!family || !select) {
+      auto str = "OpenCL variant actor needs a program family and a selector.";
+      CAF_LOG_ERROR(str);
+      throw std::runtime_error(str);
+    }
+    auto& sys = actor_conf.host->system();
+    return make_actor<variant_facade, actor>(sys.next_actor_id(), sys.node(),
+                                             &sys, std::move(actor_conf),
+                                             std::move(family), kernel_name,
+                                             range, std::move(select),
+                                             signature{std::forward<Ts>(xs)...});
+  }
+
+  void enqueue(mailbox_element_ptr ptr, execution_unit* eu) override {
+    CAF_ASSERT(ptr != nullptr);
+    CAF_PUSH_AID(id());
+    CAF_LOG_TRACE(CAF_ARG(*ptr));
+    auto content = ptr->move_content_to_message();
+    // the selector only sees messages that the facades accept
+    if (content.match_elements<exit_msg>()) {
+      drop_facades();
+      return;
+    }
+    if (!content.match_elements(typename impl::input_types{})) {
+      CAF_LOG_ERROR("Message types do not match the expected signature.");
+      response_promise promise{eu, ctrl(), *ptr};
+      promise.deliver(make_error(sec::unexpected_message));
+      return;
+    }
+    auto xs = select_(content);
+    auto key = family_->build_options(xs);
+    // keeps sender, message ID and stages, i.e., the facade responds directly
+    auto forwarded = make_mailbox_element(std::move(ptr->sender), ptr->mid,
+                                          std::move(ptr->stages),
+                                          std::move(content));
+    std::unique_lock<std::mutex> guard{mtx_};
+    auto i = index_.find(key);
+    if (i != index_.end()) {
+      facades_.splice(facades_.begin(), facades_, i->second);
+      auto target = i->second->second;
+      guard.unlock();
+      forward(target, std::move(forwarded), eu);
+      return;
+    }
+    // messages wait for the variant while a detached actor compiles it,
+    // i.e., neither the sender nor other variants block on the compiler
+    auto& waiting = pending_[key];
+    waiting.push_back(std::move(forwarded));
+    if (waiting.size() > 1)
+      return;
+    guard.unlock();
+    auto self = actor_cast<strong_actor_ptr>(this);
+    home_system().spawn<detached>([=] {
+      auto facade = actor_cast<abstract_actor*>(self);
+      static_cast<variant_facade*>(facade)->build(key, xs);
+    });
+  }
+
+  void enqueue(strong_actor_ptr sender, message_id mid,
+               message content, execution_unit* host) override {
+    CAF_LOG_TRACE("");
+    enqueue(make_mailbox_element(std::move(sender), mid, {},
+                                 std::move(content)), host);
+  }
+
+  variant_facade(actor_config actor_conf, program_family_ptr family,
+                 std::string kernel_name, nd_range range, selector select,
+                 signature xs)
+      : monitorable_actor(actor_conf),
+        actor_conf_(std::move(actor_conf)),
+        family_(std::move(family)),
+        kernel_name_(std::move(kernel_name)),
+        range_(std::move(range)),
+        select_(std::move(select)),
+        signature_(std::move(xs)) {
+    CAF_LOG_TRACE(CAF_ARG(this->id()));
+  }
+
+private:
+  using entry = std::pair<std::string, actor>;
+
+  static void forward(const actor& target, mailbox_element_ptr ptr,
+                      execution_unit* eu) {
+    actor_cast<abstract_actor*>(target)->enqueue(std::move(ptr), eu);
+  }
+
+  /// Spawns the facade for the variant with `xs` and dispatches all messages
+  /// waiting for it. Runs outside of the sender's context.
+  void build(const std::string& key, const defines& xs) {
+    actor hdl;
+    error err;
+    try {
+      hdl = spawn_facade(family_->variant(xs), indices);
+    } catch (std::exception& e) {
+      CAF_LOG_ERROR("Building the program variant failed:" << e.what());
+      err = make_error(sec::runtime_error, e.what());
+    }
+    std::vector<mailbox_element_ptr> waiting;
+    { // lifetime scope of guard
+      std::unique_lock<std::mutex> guard{mtx_};
+      auto i = pending_.find(key);
+      waiting = std::move(i->second);
+      pending_.erase(i);
+      if (hdl) {
+        // evicted facades finish their pending commands before terminating
+        while (facades_.size() >= family_->max_variants()) {
+          index_.erase(facades_.back().first);
+          facades_.pop_back();
+        }
+        facades_.emplace_front(key, hdl);
+        index_.emplace(key, facades_.begin());
+      }
+    }
+    for (auto& x : waiting) {
+      if (hdl) {
+        forward(hdl, std::move(x), nullptr);
+      } else {
+        response_promise promise{nullptr, ctrl(), *x};
+        promise.deliver(err);
+      }
+    }
+  }
+
+  /// Releases all facades, which terminate once their commands complete.
+  void drop_facades() {
+    std::unique_lock<std::mutex> guard{mtx_};
+    index_.clear();
+    facades_.clear();
+  }
+
+  template <long... Is>
+  actor spawn_facade(program_ptr prog, detail::int_list<Is...>) {
+    auto xs = signature_;
+    return impl::create(actor_conf_, std::move(prog), kernel_name_.c_str(),
+                        range_, typename impl::input_mapping{},
+                        typename impl::output_mapping{},
+                        std::forward<Ts>(std::get<Is>(xs))...);
+  }
+
+  actor_config actor_conf_;
+  program_family_ptr family_;
+  std::string kernel_name_;
+  nd_range range_;
+  selector select_;
+  signature signature_;
+  std::mutex mtx_;
+  std::list<entry> facades_; // most recently used first
+  std::unordered_map<std::string, typename std::list<entry>::iterator> index_;
+  // messages by variant that wait for their facade
+  std::unordered_map<std::string, std::vector<mailbox_element_ptr>> pending_;
+};
+
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_VARIANT_FACADE_HPP
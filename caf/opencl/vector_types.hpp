@@ -0,0 +1,71 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_OPENCL_VECTOR_TYPES_HPP
+#define CAF_OPENCL_VECTOR_TYPES_HPP
+
+#include "caf/actor_system_config.hpp"
+
+#include "caf/meta/type_name.hpp"
+
+#include "caf/opencl/half.hpp"
+#include "caf/opencl/global.hpp"
+
+#include "caf/opencl/detail/cl_type.hpp"
+
+/// Applies `m` to all OpenCL vector types supported in messages as element
+/// type and length. Wider vectors require an alignment beyond what
+/// `operator new` guarantees before C++17, i.e., they could be misaligned in
+/// host vectors. Note that `cl_<type>3` is an alias for `cl_<type>4`.
+#define CAF_OPENCL_FOR_EACH_VECTOR_TYPE(m)                                     \
+  m(char, 2) m(char, 4) m(char, 8) m(char, 16)                                 \
+  m(uchar, 2) m(uchar, 4) m(uchar, 8) m(uchar, 16)                             \
+  m(short, 2) m(short, 4) m(short, 8)                                          \
+  m(ushort, 2) m(ushort, 4) m(ushort, 8)                                       \
+  m(int, 2) m(int, 4)                                                          \
+  m(uint, 2) m(uint, 4)                                                        \
+  m(long, 2)                                                                   \
+  m(ulong, 2)                                                                  \
+  m(float, 2) m(float, 4)                                                      \
+  m(double, 2)
+
+// The vector types are unions in the global namespace, hence argument
+// dependent lookup only finds inspect overloads in the global namespace.
+#define CAF_OPENCL_VECTOR_INSPECT(type, n)                                     \
+  template <class Inspector>                                                   \
+  typename Inspector::result_type inspect(Inspector& f, cl_##type##n& x) {     \
+    return f(caf::meta::type_name("cl_" #type #n), x.s);                       \
+  }
+
+CAF_OPENCL_FOR_EACH_VECTOR_TYPE(CAF_OPENCL_VECTOR_INSPECT)
+
+#undef CAF_OPENCL_VECTOR_INSPECT
+
+namespace caf {
+namespace opencl {
+
+/// Adds `half`, the OpenCL vector types and `std::vector`s of them as message
+/// types, named `half`, `cl_float4`, `half_vector`, `cl_float4_vector`, etc.
+/// The `config` of this module calls this function in its constructor.
+void add_vector_types(actor_system_config& cfg);
+
+} // namespace opencl
+} // namespace caf
+
+#endif // CAF_OPENCL_VECTOR_TYPES_HPP
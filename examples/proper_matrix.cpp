@@ -137,7 +137,7 @@ inline bool operator!=(const square_matrix<Size>& lhs,
 
 using matrix_type = square_matrix<matrix_size>;
 
-void multiplier(event_based_actor* self) {
+void multiplier(event_based_actor* self, gemm_tiling tiling) {
   auto& mngr = self->system().opencl_manager();
 
   // create two matrices with ascending values
@@ -180,11 +180,28 @@ void multiplier(event_based_actor* self) {
                            unbox_args, box_res,
                            in<float>{}, in<float>{}, out<float>{});
 
+  // the library also provides a tiled multiplication for any shape that
+  // accepts the same conversion functions, passing the tiling found in main
+  // avoids blocking this actor while tuning
+  auto dev = mngr.find_device();
+  if (!dev)
+    return;
+  auto tiled = spawn_gemm(self->system(), *dev,
+                          gemm_shape{matrix_size, matrix_size, matrix_size},
+                          unbox_args, box_res, in<float>{}, out<float>{},
+                          tiling);
+
   // send both matrices to the actor and
   // wait for results in form of a matrix_type
-  self->request(worker, chrono::seconds(5), move(m1), move(m2)).then(
-    [](const matrix_type& result) {
+  self->request(worker, chrono::seconds(5), m1, m2).then(
+    [=](const matrix_type& result) {
       cout << "result:" << endl << to_string(result);
+      self->request(tiled, chrono::seconds(5), m1, m2).then(
+        [=](const matrix_type& tiled_result) {
+          cout << "tiled result "
+               << (tiled_result == result ? "matches" : "differs") << endl;
+        }
+      );
     }
   );
 }
@@ -197,7 +214,14 @@ int main() {
     .add_message_type<fvec>("float_vector")
     .add_message_type<matrix_type>("square_matrix");
   actor_system system{cfg};
-  system.spawn(multiplier);
+  // tuning times kernels and waits for them, i.e., it blocks the calling
+  // thread and must not run inside an event-based actor
+  gemm_tiling tiling;
+  auto dev = system.opencl_manager().find_device();
+  if (dev)
+    tiling = tune_gemm<float>(system, *dev, gemm_shape{matrix_size, matrix_size,
+                                                       matrix_size});
+  system.spawn(multiplier, tiling);
   system.await_all_actors_done();
   return 0;
 }
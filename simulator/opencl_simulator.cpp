@@ -0,0 +1,1669 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+// A stand-in for the OpenCL library that implements the subset of the API
+// used by this module on top of host memory. Kernels do not compute anything,
+// but buffers, transfers, events, callbacks and in-order queues behave like
+// on a device and each command takes a configurable, simulated time.
+//
+// Simulated time advances a virtual clock per queue: a command starts once
+// its queue and all events it waits for have reached its start time. Events
+// report these times via `clGetEventProfilingInfo` on queues created with
+// CL_QUEUE_PROFILING_ENABLE, i.e., device times are exact and reproducible,
+// while commands complete on the host without waiting. In realtime mode,
+// commands additionally spin on the steady clock for their duration, which
+// leaves only the jitter of scheduling the queue threads.
+//
+// The simulator reads its configuration from the environment:
+//
+// - CAF_OPENCL_SIM_DEVICES: number of devices (default: 1)
+// - CAF_OPENCL_SIM_DEVICE_TYPE: gpu, cpu or accelerator (default: gpu)
+// - CAF_OPENCL_SIM_GLOBAL_MEM: global memory per device in bytes
+//   (default: 1 GiB)
+// - CAF_OPENCL_SIM_LAUNCH_NS: duration of a kernel launch (default: 10000)
+// - CAF_OPENCL_SIM_ITEM_NS: additional duration per work item (default: 0)
+// - CAF_OPENCL_SIM_TRANSFER_NS: duration of a transfer without its payload
+//   (default: 5000)
+// - CAF_OPENCL_SIM_BYTES_PER_NS: bandwidth of transfers (default: 8)
+// - CAF_OPENCL_SIM_BUILD_NS: duration of building a program
+//   (default: 1000000)
+// - CAF_OPENCL_SIM_REALTIME: commands and builds take their simulated time
+//   on the host as well if set to 1 (default: 0)
+// - CAF_OPENCL_SIM_STATS: prints counters to stderr at exit if set to 1
+//
+// Building a program fails if its source contains `#error`.
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+
+#if defined(__APPLE__)
+# include <OpenCL/opencl.h>
+#else
+# include <CL/opencl.h>
+#endif
+
+namespace {
+
+// -- configuration ------------------------------------------------------------
+
+uint64_t env(const char* name, uint64_t fallback) {
+  auto str = getenv(name);
+  return str != nullptr ? strtoull(str, nullptr, 10) : fallback;
+}
+
+struct settings {
+  settings() {
+    devices = static_cast<cl_uint>(env("CAF_OPENCL_SIM_DEVICES", 1));
+    auto type = getenv("CAF_OPENCL_SIM_DEVICE_TYPE");
+    device_type = CL_DEVICE_TYPE_GPU;
+    if (type != nullptr && strcmp(type, "cpu") == 0)
+      device_type = CL_DEVICE_TYPE_CPU;
+    else if (type != nullptr && strcmp(type, "accelerator") == 0)
+      device_type = CL_DEVICE_TYPE_ACCELERATOR;
+    global_mem = env("CAF_OPENCL_SIM_GLOBAL_MEM", uint64_t{1} << 30);
+    launch_ns = env("CAF_OPENCL_SIM_LAUNCH_NS", 10000);
+    item_ns = env("CAF_OPENCL_SIM_ITEM_NS", 0);
+    transfer_ns = env("CAF_OPENCL_SIM_TRANSFER_NS", 5000);
+    bytes_per_ns = std::max(uint64_t{1}, env("CAF_OPENCL_SIM_BYTES_PER_NS", 8));
+    build_ns = env("CAF_OPENCL_SIM_BUILD_NS", 1000000);
+    realtime = env("CAF_OPENCL_SIM_REALTIME", 0) != 0;
+  }
+
+  cl_uint devices;
+  cl_device_type device_type;
+  uint64_t global_mem;
+  uint64_t launch_ns;
+  uint64_t item_ns;
+  uint64_t transfer_ns;
+  uint64_t bytes_per_ns;
+  uint64_t build_ns;
+  bool realtime;
+};
+
+const settings& config() {
+  static settings instance;
+  return instance;
+}
+
+// -- statistics ---------------------------------------------------------------
+
+struct statistics {
+  statistics() : print(env("CAF_OPENCL_SIM_STATS", 0) != 0) {
+    // nop
+  }
+
+  ~statistics() {
+    if (!print)
+      return;
+    std::cerr << "[opencl simulator] kernels: " << kernels
+              << ", reads: " << reads << " (" << bytes_read << " bytes)"
+              << ", writes: " << writes << " (" << bytes_written << " bytes)"
+              << ", copies: " << copies << " (" << bytes_copied << " bytes)"
+              << ", buffers: " << buffers << ", images: " << images
+              << ", builds: " << builds
+              << ", device time: " << device_ns << " ns"
+              << std::endl;
+  }
+
+  bool print;
+  std::atomic<uint64_t> kernels{0};
+  std::atomic<uint64_t> reads{0};
+  std::atomic<uint64_t> writes{0};
+  std::atomic<uint64_t> copies{0};
+  std::atomic<uint64_t> bytes_read{0};
+  std::atomic<uint64_t> bytes_written{0};
+  std::atomic<uint64_t> bytes_copied{0};
+  std::atomic<uint64_t> buffers{0};
+  std::atomic<uint64_t> images{0};
+  std::atomic<uint64_t> builds{0};
+  std::atomic<uint64_t> device_ns{0}; // sum of all simulated command times
+};
+
+statistics stats;
+
+// -- helpers ------------------------------------------------------------------
+
+// spins instead of sleeping, since timer slack of sleeping threads exceeds
+// the default latencies
+void simulate(uint64_t ns) {
+  if (!config().realtime || ns == 0)
+    return;
+  auto deadline = std::chrono::steady_clock::now()
+                  + std::chrono::nanoseconds(ns);
+  while (std::chrono::steady_clock::now() < deadline)
+    ; // nop
+}
+
+uint64_t transfer_time(size_t bytes) {
+  return config().transfer_ns + bytes / config().bytes_per_ns;
+}
+
+// writes `x` to the output parameters of a `clGet*Info` function
+template <class T>
+cl_int info(size_t size, void* value, size_t* size_ret, const T& x) {
+  if (size_ret != nullptr)
+    *size_ret = sizeof(T);
+  if (value != nullptr) {
+    if (size < sizeof(T))
+      return CL_INVALID_VALUE;
+    memcpy(value, &x, sizeof(T));
+  }
+  return CL_SUCCESS;
+}
+
+cl_int info(size_t size, void* value, size_t* size_ret, const std::string& x) {
+  if (size_ret != nullptr)
+    *size_ret = x.size() + 1;
+  if (value != nullptr) {
+    if (size < x.size() + 1)
+      return CL_INVALID_VALUE;
+    memcpy(value, x.c_str(), x.size() + 1);
+  }
+  return CL_SUCCESS;
+}
+
+template <class T>
+cl_int info(size_t size, void* value, size_t* size_ret,
+            const std::vector<T>& xs) {
+  auto bytes = xs.size() * sizeof(T);
+  if (size_ret != nullptr)
+    *size_ret = bytes;
+  if (value != nullptr) {
+    if (size < bytes)
+      return CL_INVALID_VALUE;
+    memcpy(value, xs.data(), bytes);
+  }
+  return CL_SUCCESS;
+}
+
+void set_error(cl_int* errcode_ret, cl_int err) {
+  if (errcode_ret != nullptr)
+    *errcode_ret = err;
+}
+
+} // namespace <anonymous>
+
+// -- OpenCL objects -----------------------------------------------------------
+
+struct ref_counted_object {
+  ref_counted_object() : refs(1) {
+    // nop
+  }
+
+  virtual ~ref_counted_object() {
+    // nop
+  }
+
+  void retain() {
+    ++refs;
+  }
+
+  void release() {
+    if (--refs == 0)
+      delete this;
+  }
+
+  std::atomic<cl_uint> refs;
+};
+
+struct _cl_platform_id {
+  std::vector<cl_device_id> devices;
+};
+
+struct _cl_device_id {
+  cl_uint index;
+  std::atomic<uint64_t> allocated{0};
+};
+
+struct _cl_context : ref_counted_object {
+  std::vector<cl_device_id> devices;
+};
+
+struct _cl_mem : ref_counted_object {
+  ~_cl_mem() override {
+    // callbacks run in reverse order of their registration
+    for (auto i = callbacks.rbegin(); i != callbacks.rend(); ++i)
+      i->first(this, i->second);
+    context->devices.front()->allocated -= data.size();
+    context->release();
+  }
+
+  cl_context context;
+  cl_mem_flags flags;
+  std::vector<char> data;
+  // images store their pixels tightly packed
+  cl_mem_object_type type = CL_MEM_OBJECT_BUFFER;
+  size_t element_size = 1;
+  size_t extent[3] = {0, 0, 0};
+  std::vector<std::pair<void (CL_CALLBACK*)(cl_mem, void*), void*>> callbacks;
+};
+
+struct _cl_program : ref_counted_object {
+  ~_cl_program() override {
+    context->release();
+  }
+
+  cl_context context;
+  std::string source;
+  std::string log;
+  std::vector<std::pair<std::string, cl_uint>> kernels; // name and arity
+  bool built = false;
+  bool from_binary = false; // binaries skip the simulated compilation
+  std::vector<cl_device_id> devices;
+};
+
+struct _cl_kernel : ref_counted_object {
+  ~_cl_kernel() override {
+    program->release();
+  }
+
+  cl_program program;
+  std::string name;
+  std::vector<std::vector<char>> args;
+};
+
+struct _cl_event : ref_counted_object {
+  using callback = void (CL_CALLBACK*)(cl_event, cl_int, void*);
+
+  ~_cl_event() override {
+    if (queue != nullptr)
+      queue->release();
+  }
+
+  // completes the event and runs its callbacks outside of the lock
+  void complete() {
+    std::vector<std::pair<callback, void*>> fs;
+    {
+      std::unique_lock<std::mutex> guard{mtx};
+      status = CL_COMPLETE;
+      fs.swap(callbacks);
+    }
+    cv.notify_all();
+    for (auto& f : fs)
+      f.first(this, CL_COMPLETE, f.second);
+  }
+
+  void await() {
+    std::unique_lock<std::mutex> guard{mtx};
+    cv.wait(guard, [&] { return status == CL_COMPLETE; });
+  }
+
+  ref_counted_object* queue = nullptr;
+  cl_context context = nullptr;
+  cl_command_type type = CL_COMMAND_MARKER;
+  cl_int status = CL_QUEUED;
+  // virtual times in nanoseconds, final once the event completes
+  cl_ulong queued = 0;
+  cl_ulong started = 0;
+  cl_ulong ended = 0;
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::vector<std::pair<callback, void*>> callbacks;
+};
+
+namespace {
+
+// a command waits for its dependencies, takes its simulated time and runs its
+// effect before completing its event
+struct command {
+  std::vector<cl_event> wait_list;
+  uint64_t duration;
+  std::function<void ()> effect;
+  std::vector<ref_counted_object*> retained;
+  cl_event event;
+};
+
+// executes the commands of a queue in order on a thread of its own, the
+// thread outlives the queue object until all commands are done
+struct queue_state {
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::deque<command> pending;
+  size_t running = 0;
+  bool closed = false;
+  std::atomic<cl_ulong> clock{0}; // end of the last command in virtual time
+
+  void run() {
+    for (;;) {
+      command cmd;
+      {
+        std::unique_lock<std::mutex> guard{mtx};
+        cv.wait(guard, [&] { return closed || !pending.empty(); });
+        if (pending.empty())
+          return;
+        cmd = std::move(pending.front());
+        pending.pop_front();
+        ++running;
+      }
+      auto start = clock.load();
+      for (auto e : cmd.wait_list) {
+        e->await();
+        {
+          std::unique_lock<std::mutex> guard{e->mtx};
+          start = std::max(start, e->ended);
+        }
+        e->release();
+      }
+      {
+        std::unique_lock<std::mutex> guard{cmd.event->mtx};
+        cmd.event->status = CL_RUNNING;
+        cmd.event->started = start;
+        cmd.event->ended = start + cmd.duration;
+      }
+      clock = start + cmd.duration;
+      stats.device_ns += cmd.duration;
+      simulate(cmd.duration);
+      if (cmd.effect)
+        cmd.effect();
+      cmd.event->complete();
+      cmd.event->release();
+      for (auto x : cmd.retained)
+        x->release();
+      {
+        std::unique_lock<std::mutex> guard{mtx};
+        --running;
+      }
+      cv.notify_all();
+    }
+  }
+
+  void finish() {
+    std::unique_lock<std::mutex> guard{mtx};
+    cv.wait(guard, [&] { return pending.empty() && running == 0; });
+  }
+};
+
+} // namespace <anonymous>
+
+struct _cl_command_queue : ref_counted_object {
+  _cl_command_queue() : state(std::make_shared<queue_state>()) {
+    auto st = state;
+    std::thread{[st] { st->run(); }}.detach();
+  }
+
+  ~_cl_command_queue() override {
+    {
+      std::unique_lock<std::mutex> guard{state->mtx};
+      state->closed = true;
+    }
+    state->cv.notify_all();
+    context->release();
+  }
+
+  cl_context context;
+  cl_device_id device;
+  cl_command_queue_properties properties;
+  std::shared_ptr<queue_state> state;
+};
+
+namespace {
+
+_cl_platform_id& the_platform() {
+  static _cl_platform_id* instance = [] {
+    auto result = new _cl_platform_id;
+    for (cl_uint i = 0; i < config().devices; ++i) {
+      auto dev = new _cl_device_id;
+      dev->index = i;
+      result->devices.push_back(dev);
+    }
+    return result;
+  }();
+  return *instance;
+}
+
+// enqueues a command that takes `duration` and runs `effect` afterwards
+cl_int enqueue(cl_command_queue queue, cl_command_type type,
+               uint64_t duration, std::function<void ()> effect,
+               std::vector<ref_counted_object*> retained,
+               cl_uint num_events, const cl_event* wait_list,
+               cl_event* event, bool blocking = false) {
+  if (queue == nullptr)
+    return CL_INVALID_COMMAND_QUEUE;
+  if ((num_events == 0) != (wait_list == nullptr))
+    return CL_INVALID_EVENT_WAIT_LIST;
+  for (cl_uint i = 0; i < num_events; ++i)
+    if (wait_list[i] == nullptr)
+      return CL_INVALID_EVENT_WAIT_LIST;
+  command cmd;
+  for (cl_uint i = 0; i < num_events; ++i) {
+    wait_list[i]->retain();
+    cmd.wait_list.push_back(wait_list[i]);
+  }
+  auto ev = new _cl_event;
+  ev->queue = queue;
+  queue->retain();
+  ev->context = queue->context;
+  ev->type = type;
+  ev->status = CL_SUBMITTED;
+  ev->queued = queue->state->clock.load();
+  ev->retain(); // released by the queue
+  for (auto x : retained)
+    x->retain();
+  cmd.duration = duration;
+  cmd.effect = std::move(effect);
+  cmd.retained = std::move(retained);
+  cmd.event = ev;
+  {
+    std::unique_lock<std::mutex> guard{queue->state->mtx};
+    queue->state->pending.push_back(std::move(cmd));
+  }
+  queue->state->cv.notify_all();
+  if (blocking)
+    ev->await();
+  if (event != nullptr)
+    *event = ev;
+  else
+    ev->release();
+  return CL_SUCCESS;
+}
+
+// extracts name and number of arguments of all kernels in `source`
+bool parse_kernels(const std::string& source,
+                   std::vector<std::pair<std::string, cl_uint>>& result,
+                   std::string& log) {
+  if (source.find("#error") != std::string::npos) {
+    log = "simulated build failure: source contains #error";
+    return false;
+  }
+  auto is_ident = [](char c) {
+    return isalnum(static_cast<unsigned char>(c)) != 0 || c == '_';
+  };
+  auto is_space = [](char c) {
+    return isspace(static_cast<unsigned char>(c)) != 0;
+  };
+  size_t pos = 0;
+  auto skip_spaces = [&] {
+    while (pos < source.size() && is_space(source[pos]))
+      ++pos;
+  };
+  // matches both `kernel` and `__kernel`
+  while ((pos = source.find("kernel", pos)) != std::string::npos) {
+    auto first = pos;
+    pos += 6;
+    if ((first > 0 && is_ident(source[first - 1]) && source[first - 1] != '_')
+        || (pos < source.size() && is_ident(source[pos])))
+      continue;
+    skip_spaces();
+    if (source.compare(pos, 4, "void") != 0)
+      continue;
+    pos += 4;
+    skip_spaces();
+    auto name_first = pos;
+    while (pos < source.size() && is_ident(source[pos]))
+      ++pos;
+    auto name = source.substr(name_first, pos - name_first);
+    skip_spaces();
+    if (name.empty() || pos >= source.size() || source[pos] != '(')
+      continue;
+    // count the top-level commas up to the closing parenthesis
+    cl_uint args = 0;
+    bool empty = true;
+    int depth = 0;
+    for (++pos; pos < source.size(); ++pos) {
+      auto c = source[pos];
+      if (c == '(') {
+        ++depth;
+      } else if (c == ')') {
+        if (depth-- == 0)
+          break;
+      } else if (c == ',' && depth == 0) {
+        ++args;
+      } else if (!is_space(c)) {
+        empty = false;
+      }
+    }
+    if (!empty)
+      ++args;
+    result.emplace_back(std::move(name), args);
+  }
+  return true;
+}
+
+// copies a rectangular region between buffer and host memory like the
+// `clEnqueue*BufferRect` functions, returns false for out of bounds access
+struct rect_copy {
+  size_t buffer_offset;
+  size_t host_offset;
+  size_t region[3];
+  size_t buffer_row_pitch;
+  size_t buffer_slice_pitch;
+  size_t host_row_pitch;
+  size_t host_slice_pitch;
+
+  bool init(const size_t* buffer_origin, const size_t* host_origin,
+            const size_t* rgn, size_t brp, size_t bsp, size_t hrp,
+            size_t hsp, size_t buffer_size) {
+    if (buffer_origin == nullptr || host_origin == nullptr || rgn == nullptr
+        || rgn[0] == 0 || rgn[1] == 0 || rgn[2] == 0)
+      return false;
+    std::copy(rgn, rgn + 3, region);
+    buffer_row_pitch = brp != 0 ? brp : region[0];
+    buffer_slice_pitch = bsp != 0 ? bsp : region[1] * buffer_row_pitch;
+    host_row_pitch = hrp != 0 ? hrp : region[0];
+    host_slice_pitch = hsp != 0 ? hsp : region[1] * host_row_pitch;
+    if (buffer_row_pitch < region[0] || host_row_pitch < region[0])
+      return false;
+    buffer_offset = buffer_origin[2] * buffer_slice_pitch
+                    + buffer_origin[1] * buffer_row_pitch + buffer_origin[0];
+    host_offset = host_origin[2] * host_slice_pitch
+                  + host_origin[1] * host_row_pitch + host_origin[0];
+    auto last = buffer_offset + (region[2] - 1) * buffer_slice_pitch
+                + (region[1] - 1) * buffer_row_pitch + region[0];
+    return last <= buffer_size;
+  }
+
+  size_t bytes() const {
+    return region[0] * region[1] * region[2];
+  }
+
+  void run(char* buffer, char* host, bool to_host) const {
+    for (size_t z = 0; z < region[2]; ++z) {
+      for (size_t y = 0; y < region[1]; ++y) {
+        auto b = buffer + buffer_offset + z * buffer_slice_pitch
+                 + y * buffer_row_pitch;
+        auto h = host + host_offset + z * host_slice_pitch
+                 + y * host_row_pitch;
+        if (to_host)
+          memcpy(h, b, region[0]);
+        else
+          memcpy(b, h, region[0]);
+      }
+    }
+  }
+};
+
+// returns the size of a pixel in `format` or 0 for unsupported formats
+size_t element_size(const cl_image_format& format) {
+  size_t channels;
+  switch (format.image_channel_order) {
+    case CL_R:
+    case CL_A:
+      channels = 1;
+      break;
+    case CL_RG:
+      channels = 2;
+      break;
+    case CL_RGBA:
+    case CL_BGRA:
+      channels = 4;
+      break;
+    default:
+      return 0;
+  }
+  switch (format.image_channel_data_type) {
+    case CL_SNORM_INT8:
+    case CL_UNORM_INT8:
+    case CL_SIGNED_INT8:
+    case CL_UNSIGNED_INT8:
+      return channels;
+    case CL_SNORM_INT16:
+    case CL_UNORM_INT16:
+    case CL_SIGNED_INT16:
+    case CL_UNSIGNED_INT16:
+    case CL_HALF_FLOAT:
+      return 2 * channels;
+    case CL_SIGNED_INT32:
+    case CL_UNSIGNED_INT32:
+    case CL_FLOAT:
+      return 4 * channels;
+    default:
+      return 0;
+  }
+}
+
+// converts an image transfer to a rect copy, returns false for invalid
+// arguments or out of bounds access
+bool image_rect(cl_mem image, const size_t* origin, const size_t* region,
+                size_t row_pitch, size_t slice_pitch, rect_copy& rect) {
+  if (image->type == CL_MEM_OBJECT_BUFFER || origin == nullptr
+      || region == nullptr)
+    return false;
+  auto elem = image->element_size;
+  auto is_2d = image->type == CL_MEM_OBJECT_IMAGE2D;
+  if (is_2d && (origin[2] != 0 || region[2] != 1 || slice_pitch != 0))
+    return false;
+  for (size_t i = 0; i < 3; ++i)
+    if (origin[i] + region[i] > image->extent[i])
+      return false;
+  size_t image_origin[] = {origin[0] * elem, origin[1], origin[2]};
+  size_t host_origin[] = {0, 0, 0};
+  size_t bytes_region[] = {region[0] * elem, region[1], region[2]};
+  return rect.init(image_origin, host_origin, bytes_region,
+                   image->extent[0] * elem,
+                   image->extent[0] * image->extent[1] * elem, row_pitch,
+                   slice_pitch, image->data.size());
+}
+
+} // namespace <anonymous>
+
+extern "C" {
+
+// -- platforms and devices ----------------------------------------------------
+
+CL_API_ENTRY cl_int CL_API_CALL
+clGetPlatformIDs(cl_uint num_entries, cl_platform_id* platforms,
+                 cl_uint* num_platforms) {
+  if ((num_entries == 0 && platforms != nullptr)
+      || (platforms == nullptr && num_platforms == nullptr))
+    return CL_INVALID_VALUE;
+  if (platforms != nullptr)
+    platforms[0] = &the_platform();
+  if (num_platforms != nullptr)
+    *num_platforms = 1;
+  return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clGetPlatformInfo(cl_platform_id platform, cl_platform_info param,
+                  size_t size, void* value, size_t* size_ret) {
+  if (platform != &the_platform())
+    return CL_INVALID_PLATFORM;
+  switch (param) {
+    case CL_PLATFORM_PROFILE:
+      return info(size, value, size_ret, std::string{"FULL_PROFILE"});
+    case CL_PLATFORM_VERSION:
+      return info(size, value, size_ret,
+                  std::string{"OpenCL 1.2 CAF Simulator"});
+    case CL_PLATFORM_NAME:
+      return info(size, value, size_ret, std::string{"CAF OpenCL Simulator"});
+    case CL_PLATFORM_VENDOR:
+      return info(size, value, size_ret, std::string{"CAF"});
+    case CL_PLATFORM_EXTENSIONS:
+      return info(size, value, size_ret, std::string{});
+    default:
+      return CL_INVALID_VALUE;
+  }
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clGetDeviceIDs(cl_platform_id platform, cl_device_type type,
+               cl_uint num_entries, cl_device_id* devices,
+               cl_uint* num_devices) {
+  if (platform != &the_platform())
+    return CL_INVALID_PLATFORM;
+  if (num_entries == 0 && devices != nullptr)
+    return CL_INVALID_VALUE;
+  auto& all = platform->devices;
+  auto matches = (type & config().device_type) != 0
+                 || type == CL_DEVICE_TYPE_ALL
+                 || type == CL_DEVICE_TYPE_DEFAULT;
+  if (!matches || all.empty())
+    return CL_DEVICE_NOT_FOUND;
+  auto n = static_cast<cl_uint>(all.size());
+  if (devices != nullptr)
+    for (cl_uint i = 0; i < std::min(num_entries, n); ++i)
+      devices[i] = all[i];
+  if (num_devices != nullptr)
+    *num_devices = n;
+  return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clGetDeviceInfo(cl_device_id device, cl_device_info param, size_t size,
+                void* value, size_t* size_ret) {
+  if (device == nullptr)
+    return CL_INVALID_DEVICE;
+  auto& cfg = config();
+  auto cpu = cfg.device_type == CL_DEVICE_TYPE_CPU;
+  switch (param) {
+    case CL_DEVICE_ADDRESS_BITS:
+      return info(size, value, size_ret, cl_uint{64});
+    case CL_DEVICE_ENDIAN_LITTLE:
+    case CL_DEVICE_AVAILABLE:
+    case CL_DEVICE_COMPILER_AVAILABLE:
+      return info(size, value, size_ret, cl_bool{CL_TRUE});
+    case CL_DEVICE_EXTENSIONS:
+      return info(size, value, size_ret, std::string{"cl_khr_fp64"});
+    case CL_DEVICE_IMAGE_SUPPORT:
+      return info(size, value, size_ret, cl_bool{CL_TRUE});
+    case CL_DEVICE_IMAGE2D_MAX_WIDTH:
+    case CL_DEVICE_IMAGE2D_MAX_HEIGHT:
+      return info(size, value, size_ret, size_t{16384});
+    case CL_DEVICE_IMAGE3D_MAX_WIDTH:
+    case CL_DEVICE_IMAGE3D_MAX_HEIGHT:
+    case CL_DEVICE_IMAGE3D_MAX_DEPTH:
+      return info(size, value, size_ret, size_t{2048});
+    case CL_DEVICE_GLOBAL_MEM_CACHE_SIZE:
+      return info(size, value, size_ret, cl_ulong{1} << 20);
+    case CL_DEVICE_GLOBAL_MEM_CACHELINE_SIZE:
+      return info(size, value, size_ret, cl_uint{64});
+    case CL_DEVICE_GLOBAL_MEM_SIZE:
+      return info(size, value, size_ret,
+                  static_cast<cl_ulong>(cfg.global_mem));
+    case CL_DEVICE_HOST_UNIFIED_MEMORY:
+      return info(size, value, size_ret,
+                  static_cast<cl_bool>(cpu ? CL_TRUE : CL_FALSE));
+    case CL_DEVICE_LOCAL_MEM_SIZE:
+      return info(size, value, size_ret, cl_ulong{1} << 16);
+    case CL_DEVICE_LOCAL_MEM_TYPE:
+      return info(size, value, size_ret,
+                  static_cast<cl_device_local_mem_type>(cpu ? CL_GLOBAL
+                                                            : CL_LOCAL));
+    case CL_DEVICE_MAX_CLOCK_FREQUENCY:
+      return info(size, value, size_ret, cl_uint{1000});
+    case CL_DEVICE_MAX_COMPUTE_UNITS:
+      return info(size, value, size_ret, cl_uint{16});
+    case CL_DEVICE_MAX_CONSTANT_ARGS:
+      return info(size, value, size_ret, cl_uint{8});
+    case CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE:
+      return info(size, value, size_ret, cl_ulong{1} << 16);
+    case CL_DEVICE_MAX_MEM_ALLOC_SIZE:
+      return info(size, value, size_ret,
+                  static_cast<cl_ulong>(cfg.global_mem / 4));
+    case CL_DEVICE_MAX_PARAMETER_SIZE:
+      return info(size, value, size_ret, size_t{1024});
+    case CL_DEVICE_MAX_WORK_GROUP_SIZE:
+      return info(size, value, size_ret, size_t{1024});
+    case CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS:
+      return info(size, value, size_ret, cl_uint{3});
+    case CL_DEVICE_MAX_WORK_ITEM_SIZES:
+      return info(size, value, size_ret,
+                  std::vector<size_t>{1024, 1024, 64});
+    case CL_DEVICE_PROFILING_TIMER_RESOLUTION:
+      return info(size, value, size_ret, size_t{1});
+    case CL_DEVICE_QUEUE_PROPERTIES:
+      return info(size, value, size_ret,
+                  cl_command_queue_properties{CL_QUEUE_PROFILING_ENABLE});
+    case CL_DEVICE_TYPE:
+      return info(size, value, size_ret, cfg.device_type);
+    case CL_DEVICE_NAME:
+      return info(size, value, size_ret,
+                  "CAF Simulated Device " + std::to_string(device->index));
+    case CL_DEVICE_VENDOR:
+      return info(size, value, size_ret, std::string{"CAF"});
+    case CL_DEVICE_VERSION:
+      return info(size, value, size_ret,
+                  std::string{"OpenCL 1.2 CAF Simulator"});
+    case CL_DRIVER_VERSION:
+      return info(size, value, size_ret, std::string{"1.0"});
+    case CL_DEVICE_OPENCL_C_VERSION:
+      return info(size, value, size_ret, std::string{"OpenCL C 1.2"});
+    case CL_DEVICE_PLATFORM:
+      return info(size, value, size_ret, cl_platform_id{&the_platform()});
+    default:
+      return CL_INVALID_VALUE;
+  }
+}
+
+// devices belong to the platform and live until the program ends
+CL_API_ENTRY cl_int CL_API_CALL clRetainDevice(cl_device_id device) {
+  return device != nullptr ? CL_SUCCESS : CL_INVALID_DEVICE;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseDevice(cl_device_id device) {
+  return device != nullptr ? CL_SUCCESS : CL_INVALID_DEVICE;
+}
+
+// -- contexts -----------------------------------------------------------------
+
+CL_API_ENTRY cl_context CL_API_CALL
+clCreateContext(const cl_context_properties*, cl_uint num_devices,
+                const cl_device_id* devices,
+                void (CL_CALLBACK*)(const char*, const void*, size_t, void*),
+                void*, cl_int* errcode_ret) {
+  if (num_devices == 0 || devices == nullptr) {
+    set_error(errcode_ret, CL_INVALID_VALUE);
+    return nullptr;
+  }
+  auto result = new _cl_context;
+  result->devices.assign(devices, devices + num_devices);
+  set_error(errcode_ret, CL_SUCCESS);
+  return result;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainContext(cl_context context) {
+  if (context == nullptr)
+    return CL_INVALID_CONTEXT;
+  context->retain();
+  return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseContext(cl_context context) {
+  if (context == nullptr)
+    return CL_INVALID_CONTEXT;
+  context->release();
+  return CL_SUCCESS;
+}
+
+// -- command queues -----------------------------------------------------------
+
+CL_API_ENTRY cl_command_queue CL_API_CALL
+clCreateCommandQueue(cl_context context, cl_device_id device,
+                     cl_command_queue_properties properties,
+                     cl_int* errcode_ret) {
+  if (context == nullptr) {
+    set_error(errcode_ret, CL_INVALID_CONTEXT);
+    return nullptr;
+  }
+  auto& devs = context->devices;
+  if (std::find(devs.begin(), devs.end(), device) == devs.end()) {
+    set_error(errcode_ret, CL_INVALID_DEVICE);
+    return nullptr;
+  }
+  auto result = new _cl_command_queue;
+  result->context = context;
+  result->device = device;
+  result->properties = properties;
+  context->retain();
+  set_error(errcode_ret, CL_SUCCESS);
+  return result;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainCommandQueue(cl_command_queue queue) {
+  if (queue == nullptr)
+    return CL_INVALID_COMMAND_QUEUE;
+  queue->retain();
+  return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseCommandQueue(cl_command_queue queue) {
+  if (queue == nullptr)
+    return CL_INVALID_COMMAND_QUEUE;
+  queue->release();
+  return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clFlush(cl_command_queue queue) {
+  // commands start as soon as they are enqueued
+  return queue != nullptr ? CL_SUCCESS : CL_INVALID_COMMAND_QUEUE;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clFinish(cl_command_queue queue) {
+  if (queue == nullptr)
+    return CL_INVALID_COMMAND_QUEUE;
+  queue->state->finish();
+  return CL_SUCCESS;
+}
+
+// -- buffers ------------------------------------------------------------------
+
+CL_API_ENTRY cl_mem CL_API_CALL
+clCreateBuffer(cl_context context, cl_mem_flags flags, size_t size,
+               void* host_ptr, cl_int* errcode_ret) {
+  if (context == nullptr) {
+    set_error(errcode_ret, CL_INVALID_CONTEXT);
+    return nullptr;
+  }
+  auto& cfg = config();
+  if (size == 0 || size > cfg.global_mem / 4) {
+    set_error(errcode_ret, CL_INVALID_BUFFER_SIZE);
+    return nullptr;
+  }
+  auto copy = (flags & (CL_MEM_COPY_HOST_PTR | CL_MEM_USE_HOST_PTR)) != 0;
+  if (copy != (host_ptr != nullptr)) {
+    set_error(errcode_ret, CL_INVALID_HOST_PTR);
+    return nullptr;
+  }
+  auto dev = context->devices.front();
+  if (dev->allocated.fetch_add(size) + size > cfg.global_mem) {
+    dev->allocated -= size;
+    set_error(errcode_ret, CL_MEM_OBJECT_ALLOCATION_FAILURE);
+    return nullptr;
+  }
+  auto result = new _cl_mem;
+  result->context = context;
+  context->retain();
+  result->flags = flags;
+  result->data.resize(size);
+  if (copy)
+    memcpy(result->data.data(), host_ptr, size);
+  ++stats.buffers;
+  set_error(errcode_ret, CL_SUCCESS);
+  return result;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainMemObject(cl_mem mem) {
+  if (mem == nullptr)
+    return CL_INVALID_MEM_OBJECT;
+  mem->retain();
+  return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseMemObject(cl_mem mem) {
+  if (mem == nullptr)
+    return CL_INVALID_MEM_OBJECT;
+  mem->release();
+  return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clSetMemObjectDestructorCallback(cl_mem mem,
+                                 void (CL_CALLBACK* f)(cl_mem, void*),
+                                 void* user_data) {
+  if (mem == nullptr)
+    return CL_INVALID_MEM_OBJECT;
+  if (f == nullptr)
+    return CL_INVALID_VALUE;
+  mem->callbacks.emplace_back(f, user_data);
+  return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clEnqueueReadBuffer(cl_command_queue queue, cl_mem buffer, cl_bool blocking,
+                    size_t offset, size_t size, void* ptr, cl_uint num_events,
+                    const cl_event* wait_list, cl_event* event) {
+  if (buffer == nullptr)
+    return CL_INVALID_MEM_OBJECT;
+  if (ptr == nullptr || offset + size > buffer->data.size())
+    return CL_INVALID_VALUE;
+  ++stats.reads;
+  stats.bytes_read += size;
+  return enqueue(queue, CL_COMMAND_READ_BUFFER, transfer_time(size),
+                 [=] { memcpy(ptr, buffer->data.data() + offset, size); },
+                 {buffer}, num_events, wait_list, event, blocking != 0);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clEnqueueWriteBuffer(cl_command_queue queue, cl_mem buffer, cl_bool blocking,
+                     size_t offset, size_t size, const void* ptr,
+                     cl_uint num_events, const cl_event* wait_list,
+                     cl_event* event) {
+  if (buffer == nullptr)
+    return CL_INVALID_MEM_OBJECT;
+  if (ptr == nullptr || offset + size > buffer->data.size())
+    return CL_INVALID_VALUE;
+  ++stats.writes;
+  stats.bytes_written += size;
+  return enqueue(queue, CL_COMMAND_WRITE_BUFFER, transfer_time(size),
+                 [=] { memcpy(buffer->data.data() + offset, ptr, size); },
+                 {buffer}, num_events, wait_list, event, blocking != 0);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clEnqueueCopyBuffer(cl_command_queue queue, cl_mem src, cl_mem dst,
+                    size_t src_offset, size_t dst_offset, size_t size,
+                    cl_uint num_events, const cl_event* wait_list,
+                    cl_event* event) {
+  if (src == nullptr || dst == nullptr)
+    return CL_INVALID_MEM_OBJECT;
+  if (src_offset + size > src->data.size()
+      || dst_offset + size > dst->data.size())
+    return CL_INVALID_VALUE;
+  ++stats.copies;
+  stats.bytes_copied += size;
+  return enqueue(queue, CL_COMMAND_COPY_BUFFER, transfer_time(size),
+                 [=] {
+                   memmove(dst->data.data() + dst_offset,
+                           src->data.data() + src_offset, size);
+                 },
+                 {src, dst}, num_events, wait_list, event);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clEnqueueReadBufferRect(cl_command_queue queue, cl_mem buffer,
+                        cl_bool blocking, const size_t* buffer_origin,
+                        const size_t* host_origin, const size_t* region,
+                        size_t buffer_row_pitch, size_t buffer_slice_pitch,
+                        size_t host_row_pitch, size_t host_slice_pitch,
+                        void* ptr, cl_uint num_events,
+                        const cl_event* wait_list, cl_event* event) {
+  if (buffer == nullptr)
+    return CL_INVALID_MEM_OBJECT;
+  rect_copy rect;
+  if (ptr == nullptr
+      || !rect.init(buffer_origin, host_origin, region, buffer_row_pitch,
+                    buffer_slice_pitch, host_row_pitch, host_slice_pitch,
+                    buffer->data.size()))
+    return CL_INVALID_VALUE;
+  ++stats.reads;
+  stats.bytes_read += rect.bytes();
+  auto host = static_cast<char*>(ptr);
+  return enqueue(queue, CL_COMMAND_READ_BUFFER_RECT,
+                 transfer_time(rect.bytes()),
+                 [=] { rect.run(buffer->data.data(), host, true); },
+                 {buffer}, num_events, wait_list, event, blocking != 0);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clEnqueueWriteBufferRect(cl_command_queue queue, cl_mem buffer,
+                         cl_bool blocking, const size_t* buffer_origin,
+                         const size_t* host_origin, const size_t* region,
+                         size_t buffer_row_pitch, size_t buffer_slice_pitch,
+                         size_t host_row_pitch, size_t host_slice_pitch,
+                         const void* ptr, cl_uint num_events,
+                         const cl_event* wait_list, cl_event* event) {
+  if (buffer == nullptr)
+    return CL_INVALID_MEM_OBJECT;
+  rect_copy rect;
+  if (ptr == nullptr
+      || !rect.init(buffer_origin, host_origin, region, buffer_row_pitch,
+                    buffer_slice_pitch, host_row_pitch, host_slice_pitch,
+                    buffer->data.size()))
+    return CL_INVALID_VALUE;
+  ++stats.writes;
+  stats.bytes_written += rect.bytes();
+  auto host = const_cast<char*>(static_cast<const char*>(ptr));
+  return enqueue(queue, CL_COMMAND_WRITE_BUFFER_RECT,
+                 transfer_time(rect.bytes()),
+                 [=] { rect.run(buffer->data.data(), host, false); },
+                 {buffer}, num_events, wait_list, event, blocking != 0);
+}
+
+// simulated buffers live in host memory, i.e., mapping exposes them directly
+CL_API_ENTRY void* CL_API_CALL
+clEnqueueMapBuffer(cl_command_queue queue, cl_mem buffer, cl_bool blocking,
+                   cl_map_flags, size_t offset, size_t size,
+                   cl_uint num_events, const cl_event* wait_list,
+                   cl_event* event, cl_int* errcode_ret) {
+  if (buffer == nullptr) {
+    set_error(errcode_ret, CL_INVALID_MEM_OBJECT);
+    return nullptr;
+  }
+  if (offset + size > buffer->data.size()) {
+    set_error(errcode_ret, CL_INVALID_VALUE);
+    return nullptr;
+  }
+  auto err = enqueue(queue, CL_COMMAND_MAP_BUFFER, 0, [] {}, {buffer},
+                     num_events, wait_list, event, blocking != 0);
+  set_error(errcode_ret, err);
+  return err == CL_SUCCESS ? buffer->data.data() + offset : nullptr;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clEnqueueUnmapMemObject(cl_command_queue queue, cl_mem mem, void*,
+                        cl_uint num_events, const cl_event* wait_list,
+                        cl_event* event) {
+  if (mem == nullptr)
+    return CL_INVALID_MEM_OBJECT;
+  return enqueue(queue, CL_COMMAND_UNMAP_MEM_OBJECT, 0, [] {}, {mem},
+                 num_events, wait_list, event, false);
+}
+
+// -- images -------------------------------------------------------------------
+
+CL_API_ENTRY cl_mem CL_API_CALL
+clCreateImage(cl_context context, cl_mem_flags flags,
+              const cl_image_format* format, const cl_image_desc* desc,
+              void* host_ptr, cl_int* errcode_ret) {
+  if (context == nullptr) {
+    set_error(errcode_ret, CL_INVALID_CONTEXT);
+    return nullptr;
+  }
+  if (format == nullptr) {
+    set_error(errcode_ret, CL_INVALID_IMAGE_FORMAT_DESCRIPTOR);
+    return nullptr;
+  }
+  auto elem = element_size(*format);
+  if (elem == 0) {
+    set_error(errcode_ret, CL_IMAGE_FORMAT_NOT_SUPPORTED);
+    return nullptr;
+  }
+  if (desc == nullptr || (desc->image_type != CL_MEM_OBJECT_IMAGE2D
+                          && desc->image_type != CL_MEM_OBJECT_IMAGE3D)) {
+    set_error(errcode_ret, CL_INVALID_IMAGE_DESCRIPTOR);
+    return nullptr;
+  }
+  auto is_2d = desc->image_type == CL_MEM_OBJECT_IMAGE2D;
+  size_t extent[] = {desc->image_width, desc->image_height,
+                     is_2d ? size_t{1} : desc->image_depth};
+  size_t max_extent = is_2d ? 16384 : 2048;
+  for (auto x : extent) {
+    if (x == 0 || x > max_extent) {
+      set_error(errcode_ret, CL_INVALID_IMAGE_SIZE);
+      return nullptr;
+    }
+  }
+  auto copy = (flags & (CL_MEM_COPY_HOST_PTR | CL_MEM_USE_HOST_PTR)) != 0;
+  if (copy != (host_ptr != nullptr)) {
+    set_error(errcode_ret, CL_INVALID_HOST_PTR);
+    return nullptr;
+  }
+  auto size = extent[0] * extent[1] * extent[2] * elem;
+  auto dev = context->devices.front();
+  if (dev->allocated.fetch_add(size) + size > config().global_mem) {
+    dev->allocated -= size;
+    set_error(errcode_ret, CL_MEM_OBJECT_ALLOCATION_FAILURE);
+    return nullptr;
+  }
+  auto result = new _cl_mem;
+  result->context = context;
+  context->retain();
+  result->flags = flags;
+  result->data.resize(size);
+  result->type = desc->image_type;
+  result->element_size = elem;
+  std::copy(extent, extent + 3, result->extent);
+  if (copy) {
+    rect_copy rect;
+    size_t origin[] = {0, 0, 0};
+    image_rect(result, origin, extent, desc->image_row_pitch,
+               is_2d ? 0 : desc->image_slice_pitch, rect);
+    rect.run(result->data.data(), static_cast<char*>(host_ptr), false);
+  }
+  ++stats.images;
+  set_error(errcode_ret, CL_SUCCESS);
+  return result;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clEnqueueReadImage(cl_command_queue queue, cl_mem image, cl_bool blocking,
+                   const size_t* origin, const size_t* region,
+                   size_t row_pitch, size_t slice_pitch, void* ptr,
+                   cl_uint num_events, const cl_event* wait_list,
+                   cl_event* event) {
+  if (image == nullptr)
+    return CL_INVALID_MEM_OBJECT;
+  rect_copy rect;
+  if (ptr == nullptr
+      || !image_rect(image, origin, region, row_pitch, slice_pitch, rect))
+    return CL_INVALID_VALUE;
+  ++stats.reads;
+  stats.bytes_read += rect.bytes();
+  auto host = static_cast<char*>(ptr);
+  return enqueue(queue, CL_COMMAND_READ_IMAGE, transfer_time(rect.bytes()),
+                 [=] { rect.run(image->data.data(), host, true); },
+                 {image}, num_events, wait_list, event, blocking != 0);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clEnqueueWriteImage(cl_command_queue queue, cl_mem image, cl_bool blocking,
+                    const size_t* origin, const size_t* region,
+                    size_t row_pitch, size_t slice_pitch, const void* ptr,
+                    cl_uint num_events, const cl_event* wait_list,
+                    cl_event* event) {
+  if (image == nullptr)
+    return CL_INVALID_MEM_OBJECT;
+  rect_copy rect;
+  if (ptr == nullptr
+      || !image_rect(image, origin, region, row_pitch, slice_pitch, rect))
+    return CL_INVALID_VALUE;
+  ++stats.writes;
+  stats.bytes_written += rect.bytes();
+  auto host = const_cast<char*>(static_cast<const char*>(ptr));
+  return enqueue(queue, CL_COMMAND_WRITE_IMAGE, transfer_time(rect.bytes()),
+                 [=] { rect.run(image->data.data(), host, false); },
+                 {image}, num_events, wait_list, event, blocking != 0);
+}
+
+// -- shared virtual memory ----------------------------------------------------
+
+// simulated devices implement OpenCL 1.2, i.e., report no SVM capabilities
+#ifdef CL_VERSION_2_0
+
+CL_API_ENTRY void* CL_API_CALL
+clSVMAlloc(cl_context, cl_svm_mem_flags, size_t, cl_uint) {
+  return nullptr;
+}
+
+CL_API_ENTRY void CL_API_CALL clSVMFree(cl_context, void*) {
+  // nop
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clEnqueueSVMMap(cl_command_queue, cl_bool, cl_map_flags, void*, size_t,
+                cl_uint, const cl_event*, cl_event*) {
+  return CL_INVALID_OPERATION;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clEnqueueSVMUnmap(cl_command_queue, void*, cl_uint, const cl_event*,
+                  cl_event*) {
+  return CL_INVALID_OPERATION;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clSetKernelArgSVMPointer(cl_kernel, cl_uint, const void*) {
+  return CL_INVALID_OPERATION;
+}
+
+#endif // CL_VERSION_2_0
+
+// -- programs and kernels -----------------------------------------------------
+
+CL_API_ENTRY cl_program CL_API_CALL
+clCreateProgramWithSource(cl_context context, cl_uint count,
+                          const char** strings, const size_t* lengths,
+                          cl_int* errcode_ret) {
+  if (context == nullptr) {
+    set_error(errcode_ret, CL_INVALID_CONTEXT);
+    return nullptr;
+  }
+  if (count == 0 || strings == nullptr) {
+    set_error(errcode_ret, CL_INVALID_VALUE);
+    return nullptr;
+  }
+  auto result = new _cl_program;
+  result->context = context;
+  context->retain();
+  for (cl_uint i = 0; i < count; ++i) {
+    if (lengths != nullptr && lengths[i] > 0)
+      result->source.append(strings[i], lengths[i]);
+    else
+      result->source.append(strings[i]);
+  }
+  set_error(errcode_ret, CL_SUCCESS);
+  return result;
+}
+
+// simulated binaries consist of the program source
+CL_API_ENTRY cl_program CL_API_CALL
+clCreateProgramWithBinary(cl_context context, cl_uint num_devices,
+                          const cl_device_id* devices, const size_t* lengths,
+                          const unsigned char** binaries,
+                          cl_int* binary_status, cl_int* errcode_ret) {
+  if (context == nullptr) {
+    set_error(errcode_ret, CL_INVALID_CONTEXT);
+    return nullptr;
+  }
+  if (num_devices == 0 || devices == nullptr || lengths == nullptr
+      || binaries == nullptr || binaries[0] == nullptr || lengths[0] == 0) {
+    set_error(errcode_ret, CL_INVALID_VALUE);
+    return nullptr;
+  }
+  auto result = new _cl_program;
+  result->context = context;
+  context->retain();
+  result->source.assign(reinterpret_cast<const char*>(binaries[0]),
+                        lengths[0]);
+  result->from_binary = true;
+  result->devices.assign(devices, devices + num_devices);
+  if (binary_status != nullptr)
+    for (cl_uint i = 0; i < num_devices; ++i)
+      binary_status[i] = CL_SUCCESS;
+  set_error(errcode_ret, CL_SUCCESS);
+  return result;
+}
+
+// simulated devices implement OpenCL 1.2, i.e., do not accept IL
+#ifdef CL_VERSION_2_1
+
+CL_API_ENTRY cl_program CL_API_CALL
+clCreateProgramWithIL(cl_context, const void*, size_t, cl_int* errcode_ret) {
+  set_error(errcode_ret, CL_INVALID_OPERATION);
+  return nullptr;
+}
+
+#endif // CL_VERSION_2_1
+
+CL_API_ENTRY cl_int CL_API_CALL
+clBuildProgram(cl_program program, cl_uint num_devices,
+               const cl_device_id* devices, const char*,
+               void (CL_CALLBACK* notify)(cl_program, void*),
+               void* user_data) {
+  if (program == nullptr)
+    return CL_INVALID_PROGRAM;
+  if (devices != nullptr && !program->from_binary)
+    program->devices.assign(devices, devices + num_devices);
+  else if (program->devices.empty())
+    program->devices = program->context->devices;
+  if (!program->from_binary) {
+    ++stats.builds;
+    simulate(config().build_ns);
+  }
+  program->kernels.clear();
+  program->log.clear();
+  program->built = parse_kernels(program->source, program->kernels,
+                                 program->log);
+  if (notify != nullptr)
+    notify(program, user_data);
+  return program->built ? CL_SUCCESS : CL_BUILD_PROGRAM_FAILURE;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clGetProgramBuildInfo(cl_program program, cl_device_id,
+                      cl_program_build_info param, size_t size, void* value,
+                      size_t* size_ret) {
+  if (program == nullptr)
+    return CL_INVALID_PROGRAM;
+  switch (param) {
+    case CL_PROGRAM_BUILD_STATUS:
+      return info(size, value, size_ret,
+                  cl_build_status{program->built ? CL_BUILD_SUCCESS
+                                                 : CL_BUILD_ERROR});
+    case CL_PROGRAM_BUILD_OPTIONS:
+      return info(size, value, size_ret, std::string{});
+    case CL_PROGRAM_BUILD_LOG:
+      return info(size, value, size_ret, program->log);
+    default:
+      return CL_INVALID_VALUE;
+  }
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clGetProgramInfo(cl_program program, cl_program_info param, size_t size,
+                 void* value, size_t* size_ret) {
+  if (program == nullptr)
+    return CL_INVALID_PROGRAM;
+  switch (param) {
+    case CL_PROGRAM_REFERENCE_COUNT:
+      return info(size, value, size_ret, cl_uint{1});
+    case CL_PROGRAM_CONTEXT:
+      return info(size, value, size_ret, program->context);
+    case CL_PROGRAM_NUM_DEVICES:
+      return info(size, value, size_ret,
+                  static_cast<cl_uint>(program->devices.size()));
+    case CL_PROGRAM_DEVICES:
+      return info(size, value, size_ret, program->devices);
+    case CL_PROGRAM_SOURCE:
+      return info(size, value, size_ret, program->source);
+    case CL_PROGRAM_BINARY_SIZES:
+      return info(size, value, size_ret,
+                  std::vector<size_t>(program->devices.size(),
+                                      program->built ? program->source.size()
+                                                     : 0));
+    case CL_PROGRAM_BINARIES: {
+      // `value` points to an array with one destination per device
+      auto n = program->devices.size();
+      if (size_ret != nullptr)
+        *size_ret = n * sizeof(unsigned char*);
+      if (value == nullptr)
+        return CL_SUCCESS;
+      if (size < n * sizeof(unsigned char*))
+        return CL_INVALID_VALUE;
+      auto dsts = static_cast<unsigned char**>(value);
+      for (size_t i = 0; i < n; ++i)
+        if (dsts[i] != nullptr && program->built)
+          memcpy(dsts[i], program->source.data(), program->source.size());
+      return CL_SUCCESS;
+    }
+    default:
+      return CL_INVALID_VALUE;
+  }
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainProgram(cl_program program) {
+  if (program == nullptr)
+    return CL_INVALID_PROGRAM;
+  program->retain();
+  return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseProgram(cl_program program) {
+  if (program == nullptr)
+    return CL_INVALID_PROGRAM;
+  program->release();
+  return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_kernel CL_API_CALL
+clCreateKernel(cl_program program, const char* name, cl_int* errcode_ret) {
+  if (program == nullptr) {
+    set_error(errcode_ret, CL_INVALID_PROGRAM);
+    return nullptr;
+  }
+  if (!program->built) {
+    set_error(errcode_ret, CL_INVALID_PROGRAM_EXECUTABLE);
+    return nullptr;
+  }
+  auto& ks = program->kernels;
+  auto i = std::find_if(ks.begin(), ks.end(),
+                        [&](const std::pair<std::string, cl_uint>& x) {
+                          return x.first == name;
+                        });
+  if (i == ks.end()) {
+    set_error(errcode_ret, CL_INVALID_KERNEL_NAME);
+    return nullptr;
+  }
+  auto result = new _cl_kernel;
+  result->program = program;
+  program->retain();
+  result->name = i->first;
+  result->args.resize(i->second);
+  set_error(errcode_ret, CL_SUCCESS);
+  return result;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clCreateKernelsInProgram(cl_program program, cl_uint num_kernels,
+                         cl_kernel* kernels, cl_uint* num_kernels_ret) {
+  if (program == nullptr)
+    return CL_INVALID_PROGRAM;
+  if (!program->built)
+    return CL_INVALID_PROGRAM_EXECUTABLE;
+  auto n = static_cast<cl_uint>(program->kernels.size());
+  if (kernels != nullptr) {
+    if (num_kernels < n)
+      return CL_INVALID_VALUE;
+    for (cl_uint i = 0; i < n; ++i)
+      kernels[i] = clCreateKernel(program, program->kernels[i].first.c_str(),
+                                  nullptr);
+  }
+  if (num_kernels_ret != nullptr)
+    *num_kernels_ret = n;
+  return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clGetKernelInfo(cl_kernel kernel, cl_kernel_info param, size_t size,
+                void* value, size_t* size_ret) {
+  if (kernel == nullptr)
+    return CL_INVALID_KERNEL;
+  switch (param) {
+    case CL_KERNEL_FUNCTION_NAME:
+      return info(size, value, size_ret, kernel->name);
+    case CL_KERNEL_NUM_ARGS:
+      return info(size, value, size_ret,
+                  static_cast<cl_uint>(kernel->args.size()));
+    case CL_KERNEL_REFERENCE_COUNT:
+      return info(size, value, size_ret, kernel->refs.load());
+    case CL_KERNEL_CONTEXT:
+      return info(size, value, size_ret, kernel->program->context);
+    case CL_KERNEL_PROGRAM:
+      return info(size, value, size_ret, kernel->program);
+    default:
+      return CL_INVALID_VALUE;
+  }
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clGetKernelWorkGroupInfo(cl_kernel kernel, cl_device_id,
+                         cl_kernel_work_group_info param, size_t size,
+                         void* value, size_t* size_ret) {
+  if (kernel == nullptr)
+    return CL_INVALID_KERNEL;
+  switch (param) {
+    case CL_KERNEL_WORK_GROUP_SIZE:
+      return info(size, value, size_ret, size_t{256});
+    case CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE:
+      return info(size, value, size_ret, size_t{32});
+    default:
+      return CL_INVALID_VALUE;
+  }
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clSetKernelArg(cl_kernel kernel, cl_uint index, size_t size,
+               const void* value) {
+  if (kernel == nullptr)
+    return CL_INVALID_KERNEL;
+  if (index >= kernel->args.size())
+    return CL_INVALID_ARG_INDEX;
+  if (size == 0)
+    return CL_INVALID_ARG_SIZE;
+  // arguments in local memory only pass their size
+  auto& arg = kernel->args[index];
+  arg.resize(size);
+  if (value != nullptr)
+    memcpy(arg.data(), value, size);
+  return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainKernel(cl_kernel kernel) {
+  if (kernel == nullptr)
+    return CL_INVALID_KERNEL;
+  kernel->retain();
+  return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseKernel(cl_kernel kernel) {
+  if (kernel == nullptr)
+    return CL_INVALID_KERNEL;
+  kernel->release();
+  return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clEnqueueNDRangeKernel(cl_command_queue queue, cl_kernel kernel,
+                       cl_uint dims, const size_t*, const size_t* global,
+                       const size_t* local, cl_uint num_events,
+                       const cl_event* wait_list, cl_event* event) {
+  if (kernel == nullptr)
+    return CL_INVALID_KERNEL;
+  if (dims < 1 || dims > 3)
+    return CL_INVALID_WORK_DIMENSION;
+  if (global == nullptr)
+    return CL_INVALID_GLOBAL_WORK_SIZE;
+  uint64_t items = 1;
+  size_t group = 1;
+  for (cl_uint i = 0; i < dims; ++i) {
+    if (global[i] == 0)
+      return CL_INVALID_GLOBAL_WORK_SIZE;
+    if (local != nullptr && (local[i] == 0 || global[i] % local[i] != 0))
+      return CL_INVALID_WORK_GROUP_SIZE;
+    items *= global[i];
+    group *= local != nullptr ? local[i] : 1;
+  }
+  if (group > 1024)
+    return CL_INVALID_WORK_GROUP_SIZE;
+  for (auto& arg : kernel->args)
+    if (arg.empty())
+      return CL_INVALID_KERNEL_ARGS;
+  ++stats.kernels;
+  auto duration = config().launch_ns + items * config().item_ns;
+  return enqueue(queue, CL_COMMAND_NDRANGE_KERNEL, duration, nullptr,
+                 {kernel}, num_events, wait_list, event);
+}
+
+// -- events -------------------------------------------------------------------
+
+CL_API_ENTRY cl_int CL_API_CALL
+clEnqueueMarkerWithWaitList(cl_command_queue queue, cl_uint num_events,
+                            const cl_event* wait_list, cl_event* event) {
+  // queues run their commands in order, hence a marker completes last
+  return enqueue(queue, CL_COMMAND_MARKER, 0, nullptr, {}, num_events,
+                 wait_list, event);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clEnqueueMarker(cl_command_queue queue, cl_event* event) {
+  if (event == nullptr)
+    return CL_INVALID_VALUE;
+  return enqueue(queue, CL_COMMAND_MARKER, 0, nullptr, {}, 0, nullptr,
+                 event);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clWaitForEvents(cl_uint num_events, const cl_event* events) {
+  if (num_events == 0 || events == nullptr)
+    return CL_INVALID_VALUE;
+  for (cl_uint i = 0; i < num_events; ++i) {
+    if (events[i] == nullptr)
+      return CL_INVALID_EVENT;
+    events[i]->await();
+  }
+  return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clGetEventInfo(cl_event event, cl_event_info param, size_t size,
+               void* value, size_t* size_ret) {
+  if (event == nullptr)
+    return CL_INVALID_EVENT;
+  switch (param) {
+    case CL_EVENT_COMMAND_EXECUTION_STATUS: {
+      std::unique_lock<std::mutex> guard{event->mtx};
+      return info(size, value, size_ret, event->status);
+    }
+    case CL_EVENT_COMMAND_TYPE:
+      return info(size, value, size_ret, event->type);
+    case CL_EVENT_REFERENCE_COUNT:
+      return info(size, value, size_ret, event->refs.load());
+    case CL_EVENT_CONTEXT:
+      return info(size, value, size_ret, event->context);
+    case CL_EVENT_COMMAND_QUEUE:
+      return info(size, value, size_ret,
+                  static_cast<cl_command_queue>(event->queue));
+    default:
+      return CL_INVALID_VALUE;
+  }
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clGetEventProfilingInfo(cl_event event, cl_profiling_info param, size_t size,
+                        void* value, size_t* size_ret) {
+  if (event == nullptr)
+    return CL_INVALID_EVENT;
+  auto queue = static_cast<cl_command_queue>(event->queue);
+  if ((queue->properties & CL_QUEUE_PROFILING_ENABLE) == 0)
+    return CL_PROFILING_INFO_NOT_AVAILABLE;
+  std::unique_lock<std::mutex> guard{event->mtx};
+  if (event->status != CL_COMPLETE)
+    return CL_PROFILING_INFO_NOT_AVAILABLE;
+  switch (param) {
+    case CL_PROFILING_COMMAND_QUEUED:
+    case CL_PROFILING_COMMAND_SUBMIT:
+      return info(size, value, size_ret, event->queued);
+    case CL_PROFILING_COMMAND_START:
+      return info(size, value, size_ret, event->started);
+    case CL_PROFILING_COMMAND_END:
+      return info(size, value, size_ret, event->ended);
+    default:
+      return CL_INVALID_VALUE;
+  }
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clSetEventCallback(cl_event event, cl_int type,
+                   void (CL_CALLBACK* f)(cl_event, cl_int, void*),
+                   void* user_data) {
+  if (event == nullptr)
+    return CL_INVALID_EVENT;
+  if (f == nullptr || type != CL_COMPLETE)
+    return CL_INVALID_VALUE;
+  {
+    std::unique_lock<std::mutex> guard{event->mtx};
+    if (event->status != CL_COMPLETE) {
+      event->callbacks.emplace_back(f, user_data);
+      return CL_SUCCESS;
+    }
+  }
+  // the event has completed already
+  f(event, CL_COMPLETE, user_data);
+  return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainEvent(cl_event event) {
+  if (event == nullptr)
+    return CL_INVALID_EVENT;
+  event->retain();
+  return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseEvent(cl_event event) {
+  if (event == nullptr)
+    return CL_INVALID_EVENT;
+  event->release();
+  return CL_SUCCESS;
+}
+
+} // extern "C"
@@ -0,0 +1,73 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+
+#include "caf/opencl/compact.hpp"
+
+using namespace std;
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+namespace {
+
+constexpr const char* compact_kernels = R"__(
+/// Flags the elements to keep.
+kernel void compact_flags(global const T* restrict data,
+                          global uint* restrict flags, uint len) {
+  const uint i = get_global_id(0);
+  if (i < len)
+    flags[i] = keep(data[i]) ? 1 : 0;
+}
+
+/// Reads the number of kept elements from the scanned flags.
+kernel void compact_count(global const uint* restrict positions,
+                          global uint* restrict count, uint len) {
+  count[0] = positions[len - 1];
+}
+
+/// Moves each kept element to its position, which is one less than the
+/// inclusive scan of the flags.
+kernel void compact_scatter(global const T* restrict data,
+                            global const uint* restrict positions,
+                            global T* restrict result,
+                            uint len, uint count) {
+  const uint i = get_global_id(0);
+  if (i >= len)
+    return;
+  const uint pos = positions[i];
+  const uint prev = i > 0 ? positions[i - 1] : 0;
+  if (pos != prev && pos <= count)
+    result[pos - 1] = data[i];
+}
+)__";
+
+} // namespace <anonymous>
+
+string compact_source(const string& prelude, const string& predicate) {
+  string result = prelude;
+  result += "bool keep(T x) {\n  return (" + predicate + ");\n}\n";
+  result += compact_kernels;
+  return result;
+}
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
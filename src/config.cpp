@@ -0,0 +1,54 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include "caf/opencl/config.hpp"
+#include "caf/opencl/vector_types.hpp"
+
+namespace caf {
+namespace opencl {
+
+config::config() {
+  opt_group{custom_options_, "opencl"}
+  .add(opencl_options.platform_name, "platform-name",
+       "only use platforms with a name containing this string")
+  .add(opencl_options.platform_vendor, "platform-vendor",
+       "only use platforms with a vendor containing this string")
+  .add(opencl_options.device_types, "device-types",
+       "comma-separated list of gpu, accelerator, cpu or all")
+  .add(opencl_options.device_name, "device-name",
+       "only use devices with a name matching this regex")
+  .add(opencl_options.host_pool_size, "host-pool-size",
+       "max. idle host vectors per element type (0 disables the pool)")
+  .add(opencl_options.memory_budget, "memory-budget",
+       "max. bytes allocated per device (0 selects the global memory size)")
+  .add(opencl_options.max_pooled_bytes, "max-pooled-bytes",
+       "max. bytes per device kept in idle buffers (0 disables pooling)")
+  .add(opencl_options.spill_mem_refs, "spill-mem-refs",
+       "move cold mem_refs to host memory when exceeding the budget")
+  .add(opencl_options.upload_cache_bytes, "upload-cache-bytes",
+       "max. bytes per device kept for repeated inputs (0 disables the cache)")
+  .add(opencl_options.program_cache_dir, "program-cache-dir",
+       "directory for compiled program variants (empty disables the cache)")
+  .add(opencl_options.max_cached_programs, "max-cached-programs",
+       "max. programs kept for deduplicating builds (0 disables the cache)");
+  add_vector_types(*this);
+}
+
+} // namespace opencl
+} // namespace caf
@@ -17,6 +17,7 @@
  * http://www.boost.org/LICENSE_1_0.txt.                                      *
  ******************************************************************************/
 
+#include <limits>
 #include <iostream>
 #include <utility>
 
@@ -33,78 +34,165 @@ using namespace std;
 namespace caf {
 namespace opencl {
 
-device_ptr device::create(const detail::raw_context_ptr& context,
+device_ptr device::create(detail::lazy_context_ptr context,
                           const detail::raw_device_ptr& device_id,
-                          unsigned id) {
+                          unsigned id, const options& opts) {
   CAF_LOG_DEBUG("creating device for opencl device with id:" << CAF_ARG(id));
-  // look up properties we need to create the command queue
-  auto supported = info<cl_ulong>(device_id, CL_DEVICE_QUEUE_PROPERTIES);
-  bool profiling = false; // (supported & CL_QUEUE_PROFILING_ENABLE) != 0u;
-  bool out_of_order = (supported & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) != 0u;
-  unsigned properties = profiling ? CL_QUEUE_PROFILING_ENABLE : 0;
-  if (out_of_order)
-    properties |= CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
-  // create the command queue
-  detail::raw_command_queue_ptr command_queue{
-    v2get(CAF_CLF(clCreateCommandQueue),
-          context.get(), device_id.get(),
-          properties),
-    false
-  };
-  // create the device
-  auto dev = make_counted<device>(device_id, std::move(command_queue),
-                                  context, id);
-  //device dev{device_id, std::move(command_queue), context, id};
-  // look up device properties
-  dev->address_bits_ = info<cl_uint>(device_id, CL_DEVICE_ADDRESS_BITS);
-  dev->little_endian_ = info<cl_bool>(device_id, CL_DEVICE_ENDIAN_LITTLE);
-  dev->global_mem_cache_size_ =
-    info<cl_ulong>(device_id, CL_DEVICE_GLOBAL_MEM_CACHE_SIZE);
-  dev->global_mem_cacheline_size_ =
-    info<cl_uint>(device_id, CL_DEVICE_GLOBAL_MEM_CACHELINE_SIZE);
-  dev->global_mem_size_ =
-    info<cl_ulong >(device_id,CL_DEVICE_GLOBAL_MEM_SIZE);
-  dev->host_unified_memory_ =
-    info<cl_bool>(device_id, CL_DEVICE_HOST_UNIFIED_MEMORY);
-  dev->local_mem_size_ =
-    info<cl_ulong>(device_id, CL_DEVICE_LOCAL_MEM_SIZE);
-  dev->local_mem_type_ =
-    info<cl_uint>(device_id, CL_DEVICE_LOCAL_MEM_TYPE);
-  dev->max_clock_frequency_ =
-    info<cl_uint>(device_id, CL_DEVICE_MAX_CLOCK_FREQUENCY);
-  dev->max_compute_units_ =
-    info<cl_uint>(device_id, CL_DEVICE_MAX_COMPUTE_UNITS);
-  dev->max_constant_args_ =
-    info<cl_uint>(device_id, CL_DEVICE_MAX_CONSTANT_ARGS);
-  dev->max_constant_buffer_size_ =
-    info<cl_ulong>(device_id, CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE);
-  dev->max_mem_alloc_size_ =
-    info<cl_ulong>(device_id, CL_DEVICE_MAX_MEM_ALLOC_SIZE);
-  dev->max_parameter_size_ =
-    info<size_t>(device_id, CL_DEVICE_MAX_PARAMETER_SIZE);
-  dev->max_work_group_size_ =
-    info<size_t>(device_id, CL_DEVICE_MAX_WORK_GROUP_SIZE);
-  dev->max_work_item_dimensions_ =
-    info<cl_uint>(device_id, CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS);
-  dev->profiling_timer_resolution_ =
-    info<size_t>(device_id, CL_DEVICE_PROFILING_TIMER_RESOLUTION);
-  dev->max_work_item_sizes_.resize(dev->max_work_item_dimensions_);
-  clGetDeviceInfo(device_id.get(), CL_DEVICE_MAX_WORK_ITEM_SIZES,
-                  sizeof(size_t) * dev->max_work_item_dimensions_,
-                  dev->max_work_item_sizes_.data(), nullptr);
-  dev->device_type_ =
-    device_type_from_ulong(info<cl_ulong>(device_id, CL_DEVICE_TYPE));
-  string extensions = info_string(device_id, CL_DEVICE_EXTENSIONS);
-  split(dev->extensions_, extensions, " ", false);
-  dev->opencl_c_version_ = info_string(device_id, CL_DEVICE_EXTENSIONS);
-  dev->device_vendor_ = info_string(device_id, CL_DEVICE_VENDOR);
-  dev->device_version_ = info_string(device_id, CL_DEVICE_VERSION);
-  dev->name_ = info_string(device_id, CL_DEVICE_NAME);
-  return dev;
+  return make_counted<device>(device_id, std::move(context), id, opts);
+}
+
+const detail::raw_command_queue_ptr& device::queue() {
+  std::call_once(queue_once_, [&] {
+    CAF_LOG_DEBUG("creating command queue for device:" << CAF_ARG(id_));
+    // look up properties we need to create the command queue
+    auto supported = info<cl_ulong>(device_id_, CL_DEVICE_QUEUE_PROPERTIES);
+    profiling_enabled_ = false; // (supported & CL_QUEUE_PROFILING_ENABLE) != 0u;
+    out_of_order_execution_ =
+      (supported & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) != 0u;
+    unsigned properties = profiling_enabled_ ? CL_QUEUE_PROFILING_ENABLE : 0;
+    if (out_of_order_execution_)
+      properties |= CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
+    // create the command queue
+    queue_.reset(v2get(CAF_CLF(clCreateCommandQueue),
+                       context().get(), device_id_.get(),
+                       properties),
+                 false);
+  });
+  return queue_;
+}
+
+const device::properties& device::props() const {
+  std::call_once(props_once_, [&] {
+    auto& dev = device_id_;
+    auto& p = props_;
+    p.address_bits = info<cl_uint>(dev, CL_DEVICE_ADDRESS_BITS);
+    p.little_endian = info<cl_bool>(dev, CL_DEVICE_ENDIAN_LITTLE);
+    p.global_mem_cache_size =
+      info<cl_ulong>(dev, CL_DEVICE_GLOBAL_MEM_CACHE_SIZE);
+    p.global_mem_cacheline_size =
+      info<cl_uint>(dev, CL_DEVICE_GLOBAL_MEM_CACHELINE_SIZE);
+    p.global_mem_size = info<cl_ulong>(dev, CL_DEVICE_GLOBAL_MEM_SIZE);
+    p.host_unified_memory = info<cl_bool>(dev, CL_DEVICE_HOST_UNIFIED_MEMORY);
+    p.local_mem_size = info<cl_ulong>(dev, CL_DEVICE_LOCAL_MEM_SIZE);
+    p.local_mem_type = info<cl_uint>(dev, CL_DEVICE_LOCAL_MEM_TYPE);
+    p.max_clock_frequency = info<cl_uint>(dev, CL_DEVICE_MAX_CLOCK_FREQUENCY);
+    p.max_compute_units = info<cl_uint>(dev, CL_DEVICE_MAX_COMPUTE_UNITS);
+    p.max_constant_args = info<cl_uint>(dev, CL_DEVICE_MAX_CONSTANT_ARGS);
+    p.max_constant_buffer_size =
+      info<cl_ulong>(dev, CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE);
+    p.max_mem_alloc_size = info<cl_ulong>(dev, CL_DEVICE_MAX_MEM_ALLOC_SIZE);
+    p.max_parameter_size = info<size_t>(dev, CL_DEVICE_MAX_PARAMETER_SIZE);
+    p.max_work_group_size = info<size_t>(dev, CL_DEVICE_MAX_WORK_GROUP_SIZE);
+    p.max_work_item_dimensions =
+      info<cl_uint>(dev, CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS);
+    p.profiling_timer_resolution =
+      info<size_t>(dev, CL_DEVICE_PROFILING_TIMER_RESOLUTION);
+    p.max_work_item_sizes.resize(p.max_work_item_dimensions);
+    clGetDeviceInfo(dev.get(), CL_DEVICE_MAX_WORK_ITEM_SIZES,
+                    sizeof(size_t) * p.max_work_item_dimensions,
+                    p.max_work_item_sizes.data(), nullptr);
+    p.type = device_type_from_ulong(info<cl_ulong>(dev, CL_DEVICE_TYPE));
+    string extensions = info_string(dev, CL_DEVICE_EXTENSIONS);
+    split(p.extensions, extensions, " ", false);
+    p.opencl_c_version = info_string(dev, CL_DEVICE_OPENCL_C_VERSION);
+    p.device_vendor = info_string(dev, CL_DEVICE_VENDOR);
+    p.device_version = info_string(dev, CL_DEVICE_VERSION);
+    p.driver_version = info_string(dev, CL_DRIVER_VERSION);
+    p.name = info_string(dev, CL_DEVICE_NAME);
+    // devices prior to OpenCL 2.0 reject the query
+    p.svm_capabilities = 0;
+#ifdef CL_VERSION_2_0
+    cl_device_svm_capabilities svm;
+    if (clGetDeviceInfo(dev.get(), CL_DEVICE_SVM_CAPABILITIES, sizeof(svm),
+                        &svm, nullptr) == CL_SUCCESS)
+      p.svm_capabilities = svm;
+#endif
+  });
+  return props_;
 }
 
 void device::synchronize() {
-  clFinish(queue_.get());
+  clFinish(queue().get());
+}
+
+memory_usage device::mem_usage() {
+  auto result = tracker()->usage();
+  upload_cache_->stats(result);
+  return result;
+}
+
+void device::memory_budget(size_t bytes) {
+  tracker()->budget(bytes);
+}
+
+void device::release_idle_buffers() {
+  upload_cache_->clear();
+  if (tracker_)
+    tracker_->evict(numeric_limits<size_t>::max());
+}
+
+void device::upload_cache_budget(size_t bytes) {
+  upload_cache_->budget(bytes);
+}
+
+void device::spilling(bool enabled) {
+  tracker()->spilling(enabled);
+}
+
+const detail::mem_tracker_ptr& device::tracker() {
+  std::call_once(tracker_once_, [&] {
+    auto budget = memory_budget_ > 0 ? memory_budget_
+                                     : static_cast<size_t>(global_mem_size());
+    tracker_ = make_counted<detail::mem_tracker>(budget, max_pooled_bytes_);
+    tracker_->spilling(spill_mem_refs_);
+    context_->add_tracker(tracker_);
+  });
+  return tracker_;
+}
+
+function<void ()> device::pinned_allocate(size_t bytes, void*& ptr) {
+  cl_int err;
+  detail::raw_mem_ptr buffer{clCreateBuffer(context().get(),
+                                            CL_MEM_READ_WRITE
+                                            | CL_MEM_ALLOC_HOST_PTR,
+                                            bytes, nullptr, &err),
+                             false};
+  if (err != CL_SUCCESS)
+    throwcl("clCreateBuffer", err);
+  auto mapped = clEnqueueMapBuffer(queue().get(), buffer.get(), CL_TRUE,
+                                   CL_MAP_READ | CL_MAP_WRITE, 0, bytes, 0,
+                                   nullptr, nullptr, &err);
+  if (err != CL_SUCCESS)
+    throwcl("clEnqueueMapBuffer", err);
+  ptr = mapped;
+  auto q = queue();
+  return [q, buffer, mapped] {
+    clEnqueueUnmapMemObject(q.get(), buffer.get(), mapped, 0, nullptr,
+                            nullptr);
+  };
+}
+
+expected<detail::svm_block_ptr> device::svm_allocate(size_t bytes,
+                                                     bool fine_grained) {
+#ifdef CL_VERSION_2_0
+  auto caps = svm_capabilities();
+  if ((caps & CL_DEVICE_SVM_COARSE_GRAIN_BUFFER) == 0)
+    return make_error(sec::runtime_error,
+                      "Device does not support shared virtual memory.");
+  fine_grained = fine_grained && (caps & CL_DEVICE_SVM_FINE_GRAIN_BUFFER) != 0;
+  cl_svm_mem_flags flags = CL_MEM_READ_WRITE;
+  if (fine_grained)
+    flags |= CL_MEM_SVM_FINE_GRAIN_BUFFER;
+  auto ptr = clSVMAlloc(context().get(), flags, bytes, 0);
+  if (ptr == nullptr)
+    return make_error(sec::runtime_error, "clSVMAlloc failed.");
+  return make_counted<detail::svm_block>(context(), ptr, bytes, fine_grained);
+#else
+  static_cast<void>(bytes);
+  static_cast<void>(fine_grained);
+  return make_error(sec::runtime_error,
+                    "Shared virtual memory requires OpenCL 2.0.");
+#endif
 }
 
 string device::info_string(const detail::raw_device_ptr& device_id,
@@ -118,18 +206,23 @@ string device::info_string(const detail::raw_device_ptr& device_id,
 }
 
 device::device(detail::raw_device_ptr device_id,
-               detail::raw_command_queue_ptr queue,
-               detail::raw_context_ptr context,
-               unsigned id)
+               detail::lazy_context_ptr context,
+               unsigned id, const options& opts)
   : device_id_(std::move(device_id)),
-    queue_(std::move(queue)),
     context_(std::move(context)),
-    id_(id) {
+    id_(id),
+    profiling_enabled_(false),
+    out_of_order_execution_(false),
+    memory_budget_(opts.memory_budget),
+    max_pooled_bytes_(opts.max_pooled_bytes),
+    spill_mem_refs_(opts.spill_mem_refs),
+    upload_cache_(make_counted<detail::upload_cache>(opts.upload_cache_bytes)) {
   // nop
 }
 
 device::~device() {
-  // nop
+  // idle and cached buffers keep the tracker alive
+  release_idle_buffers();
 }
 
 } // namespace opencl
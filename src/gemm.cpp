@@ -0,0 +1,202 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+
+#include <map>
+#include <mutex>
+#include <sstream>
+
+#include "caf/opencl/gemm.hpp"
+
+using namespace std;
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+namespace {
+
+// Work item (x, y) of a group computes the elements (y + i * TM / WM,
+// x + j * TN / WN) of its block for i < WM and j < WN. Spreading the
+// elements of a work item across the block avoids bank conflicts when
+// reading the tiles.
+constexpr const char* gemm_kernel = R"__(
+#if A_ROW_MAJOR
+#  define A(i, k) a[(i) * K + (k)]
+#else
+#  define A(i, k) a[(k) * M + (i)]
+#endif
+#if B_ROW_MAJOR
+#  define B(k, j) b[(k) * N + (j)]
+#else
+#  define B(k, j) b[(j) * K + (k)]
+#endif
+#if C_ROW_MAJOR
+#  define C(i, j) c[(i) * N + (j)]
+#else
+#  define C(i, j) c[(j) * M + (i)]
+#endif
+
+#define THREADS_X (TN / WN)
+#define THREADS_Y (TM / WM)
+
+/// Computes a block of `c = a * b` per work group.
+kernel void gemm(global const T* restrict a,
+                 global const T* restrict b,
+                 global T* restrict c) {
+  local T a_tile[TM][TK];
+  local T b_tile[TK][TN];
+  const uint x = get_local_id(0);
+  const uint y = get_local_id(1);
+  const uint thread = y * THREADS_X + x;
+  const uint row = get_group_id(1) * TM;
+  const uint column = get_group_id(0) * TN;
+  T acc[WM][WN];
+  for (uint i = 0; i < WM; ++i)
+    for (uint j = 0; j < WN; ++j)
+      acc[i][j] = 0;
+  for (uint k0 = 0; k0 < K; k0 += TK) {
+    // neighboring work items load neighboring elements from global memory
+    for (uint idx = thread; idx < TM * TK; idx += THREADS_X * THREADS_Y) {
+#if A_ROW_MAJOR
+      const uint i = idx / TK;
+      const uint k = idx % TK;
+#else
+      const uint i = idx % TM;
+      const uint k = idx / TM;
+#endif
+      a_tile[i][k] = row + i < M && k0 + k < K ? A(row + i, k0 + k) : 0;
+    }
+    for (uint idx = thread; idx < TK * TN; idx += THREADS_X * THREADS_Y) {
+#if B_ROW_MAJOR
+      const uint k = idx / TN;
+      const uint j = idx % TN;
+#else
+      const uint k = idx % TK;
+      const uint j = idx / TK;
+#endif
+      b_tile[k][j] = k0 + k < K && column + j < N ? B(k0 + k, column + j)
+                                                   : 0;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+    for (uint k = 0; k < TK; ++k) {
+      T a_reg[WM];
+      for (uint i = 0; i < WM; ++i)
+        a_reg[i] = a_tile[y + i * THREADS_Y][k];
+      for (uint j = 0; j < WN; ++j) {
+        const T b_reg = b_tile[k][x + j * THREADS_X];
+        for (uint i = 0; i < WM; ++i)
+          acc[i][j] += a_reg[i] * b_reg;
+      }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+  }
+  for (uint i = 0; i < WM; ++i) {
+    const uint r = row + y + i * THREADS_Y;
+    for (uint j = 0; j < WN; ++j) {
+      const uint col = column + x + j * THREADS_X;
+      if (r < M && col < N)
+        C(r, col) = acc[i][j];
+    }
+  }
+}
+)__";
+
+// tile_m, tile_n, tile_k, work_m, work_n
+const gemm_tiling candidates[] = {
+  {16, 16, 16, 1, 1},
+  {32, 32, 16, 2, 2},
+  {32, 32, 32, 2, 2},
+  {64, 64, 8, 4, 4},
+  {64, 64, 16, 4, 4},
+  {128, 64, 16, 8, 4},
+  {64, 128, 16, 4, 8},
+  {128, 128, 8, 8, 8}
+};
+
+mutex tilings_mtx;
+map<string, gemm_tiling> tilings;
+
+} // namespace <anonymous>
+
+string gemm_source(const string& prelude, const gemm_shape& shape,
+                   const gemm_tiling& tiling) {
+  auto row_major = [](matrix_order x) {
+    return x == matrix_order::row_major ? 1 : 0;
+  };
+  ostringstream oss;
+  oss << prelude
+      << "#define M " << shape.m << "u\n"
+      << "#define N " << shape.n << "u\n"
+      << "#define K " << shape.k << "u\n"
+      << "#define TM " << tiling.tile_m << "u\n"
+      << "#define TN " << tiling.tile_n << "u\n"
+      << "#define TK " << tiling.tile_k << "u\n"
+      << "#define WM " << tiling.work_m << "u\n"
+      << "#define WN " << tiling.work_n << "u\n"
+      << "#define A_ROW_MAJOR " << row_major(shape.a_order) << "\n"
+      << "#define B_ROW_MAJOR " << row_major(shape.b_order) << "\n"
+      << "#define C_ROW_MAJOR " << row_major(shape.c_order) << "\n"
+      << gemm_kernel;
+  return oss.str();
+}
+
+vector<gemm_tiling> gemm_candidates(const device_ptr& dev,
+                                    size_t element_size) {
+  vector<gemm_tiling> result;
+  for (auto& x : candidates) {
+    auto threads_x = x.tile_n / x.work_n;
+    auto threads_y = x.tile_m / x.work_m;
+    auto local_bytes = (x.tile_m + x.tile_n) * x.tile_k * element_size;
+    auto& max_items = dev->max_work_item_sizes();
+    if (threads_x * threads_y <= dev->max_work_group_size()
+        && max_items.size() > 1
+        && threads_x <= max_items[0] && threads_y <= max_items[1]
+        && local_bytes <= dev->local_mem_size())
+      result.push_back(x);
+  }
+  return result;
+}
+
+string gemm_tuning_key(const device_ptr& dev, const char* type,
+                       const gemm_shape& shape) {
+  ostringstream oss;
+  oss << dev->id() << '/' << dev->name() << '/' << type << '/'
+      << shape.m << 'x' << shape.n << 'x' << shape.k << '/'
+      << static_cast<int>(shape.a_order) << static_cast<int>(shape.b_order)
+      << static_cast<int>(shape.c_order);
+  return oss.str();
+}
+
+optional<gemm_tiling> find_gemm_tiling(const string& key) {
+  lock_guard<mutex> guard{tilings_mtx};
+  auto i = tilings.find(key);
+  if (i == tilings.end())
+    return none;
+  return i->second;
+}
+
+void store_gemm_tiling(const string& key, const gemm_tiling& tiling) {
+  lock_guard<mutex> guard{tilings_mtx};
+  tilings[key] = tiling;
+}
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
@@ -0,0 +1,146 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include "caf/opencl/half.hpp"
+
+#include <cstring>
+#include <cstdint>
+
+#if defined(__F16C__)
+# include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+# include <arm_neon.h>
+#endif
+
+namespace caf {
+namespace opencl {
+
+namespace {
+
+// rounds to the nearest value and ties to even like the SIMD conversions
+uint16_t float_to_half_bits(float x) {
+  uint32_t f;
+  memcpy(&f, &x, sizeof(f));
+  auto sign = static_cast<uint16_t>((f >> 16) & 0x8000u);
+  auto abs = f & 0x7FFFFFFFu;
+  if (abs >= 0x7F800000u) {
+    // infinity or NaN, keeping NaNs quiet
+    if (abs == 0x7F800000u)
+      return sign | 0x7C00u;
+    return static_cast<uint16_t>(sign | 0x7E00u | ((abs >> 13) & 0x3FFu));
+  }
+  if (abs >= 0x477FF000u) // 65520 and above rounds to infinity
+    return sign | 0x7C00u;
+  if (abs < 0x38800000u) {
+    // result is subnormal or zero
+    auto exp = abs >> 23;
+    if (exp < 102)
+      return sign;
+    auto mant = (abs & 0x7FFFFFu) | 0x800000u;
+    auto shift = 126 - exp;
+    auto h = mant >> shift;
+    auto rem = mant & ((1u << shift) - 1);
+    auto halfway = 1u << (shift - 1);
+    if (rem > halfway || (rem == halfway && (h & 1u) != 0))
+      ++h;
+    return static_cast<uint16_t>(sign | h);
+  }
+  // rebias the exponent, a carry of the rounding increments the exponent
+  auto h = (abs - 0x38000000u) >> 13;
+  auto rem = abs & 0x1FFFu;
+  if (rem > 0x1000u || (rem == 0x1000u && (h & 1u) != 0))
+    ++h;
+  return static_cast<uint16_t>(sign | h);
+}
+
+float half_bits_to_float(uint16_t h) {
+  uint32_t sign = static_cast<uint32_t>(h & 0x8000u) << 16;
+  uint32_t exp = (h >> 10) & 0x1Fu;
+  uint32_t mant = h & 0x3FFu;
+  uint32_t f;
+  if (exp == 0x1F) {
+    // infinity or NaN, quieting signaling NaNs
+    f = sign | 0x7F800000u | (mant << 13) | (mant != 0 ? 0x400000u : 0);
+  } else if (exp == 0) {
+    if (mant == 0) {
+      f = sign;
+    } else {
+      // normalize the subnormal value
+      uint32_t e = 113;
+      do {
+        mant <<= 1;
+        --e;
+      } while ((mant & 0x400u) == 0);
+      f = sign | (e << 23) | ((mant & 0x3FFu) << 13);
+    }
+  } else {
+    f = sign | ((exp + 112) << 23) | (mant << 13);
+  }
+  float result;
+  memcpy(&result, &f, sizeof(result));
+  return result;
+}
+
+} // namespace <anonymous>
+
+half::half(float x) : bits(float_to_half_bits(x)) {
+  // nop
+}
+
+half::operator float() const {
+  return half_bits_to_float(bits);
+}
+
+void to_half(const float* first, size_t n, half* out) {
+  size_t i = 0;
+#if defined(__F16C__)
+  for (; i + 8 <= n; i += 8) {
+    auto xs = _mm256_cvtps_ph(_mm256_loadu_ps(first + i),
+                              _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), xs);
+  }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+  for (; i + 4 <= n; i += 4) {
+    auto xs = vcvt_f16_f32(vld1q_f32(first + i));
+    vst1_u16(reinterpret_cast<uint16_t*>(out + i), vreinterpret_u16_f16(xs));
+  }
+#endif
+  for (; i < n; ++i)
+    out[i].bits = float_to_half_bits(first[i]);
+}
+
+void to_float(const half* first, size_t n, float* out) {
+  size_t i = 0;
+#if defined(__F16C__)
+  for (; i + 8 <= n; i += 8) {
+    auto xs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+    _mm256_storeu_ps(out + i, _mm256_cvtph_ps(xs));
+  }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+  for (; i + 4 <= n; i += 4) {
+    auto xs = vld1_u16(reinterpret_cast<const uint16_t*>(first + i));
+    vst1q_f32(out + i, vcvt_f32_f16(vreinterpret_f16_u16(xs)));
+  }
+#endif
+  for (; i < n; ++i)
+    out[i] = half_bits_to_float(first[i].bits);
+}
+
+} // namespace opencl
+} // namespace caf
@@ -0,0 +1,49 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include <cstring>
+
+#include "caf/opencl/detail/hash.hpp"
+
+using namespace std;
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+uint64_t hash(const void* data, size_t bytes) {
+  constexpr uint64_t mul = 0x9e3779b97f4a7c15ull;
+  auto p = static_cast<const char*>(data);
+  auto result = hash_mix(bytes * mul);
+  uint64_t word;
+  for (; bytes >= sizeof(word); p += sizeof(word), bytes -= sizeof(word)) {
+    memcpy(&word, p, sizeof(word));
+    result = (result ^ hash_mix(word * mul)) * mul;
+  }
+  if (bytes > 0) {
+    word = 0;
+    memcpy(&word, p, bytes);
+    result = (result ^ hash_mix(word * mul)) * mul;
+  }
+  return hash_mix(result);
+}
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
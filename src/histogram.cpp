@@ -0,0 +1,81 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+
+#include "caf/opencl/histogram.hpp"
+
+using namespace std;
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+namespace {
+
+constexpr const char* histogram_kernels = R"__(
+/// Counts a strided range of the input per work item into the private bins
+/// of its group and stores the bins of each group in `partials`.
+kernel void histogram(global const T* restrict data,
+                      global uint* restrict partials,
+                      local uint* bins, uint len) {
+  const uint thread = get_local_id(0);
+  const uint size = get_local_size(0);
+  for (uint b = thread; b < BINS; b += size)
+    bins[b] = 0;
+  barrier(CLK_LOCAL_MEM_FENCE);
+  for (uint i = get_global_id(0); i < len; i += get_global_size(0)) {
+    const uint b = bin_index(data[i]);
+    if (b < BINS)
+      atomic_inc(&bins[b]);
+  }
+  barrier(CLK_LOCAL_MEM_FENCE);
+  global uint* result = partials + get_group_id(0) * BINS;
+  for (uint b = thread; b < BINS; b += size)
+    result[b] = bins[b];
+}
+
+/// Sums the bins of all groups.
+kernel void histogram_merge(global const uint* restrict partials,
+                            global uint* restrict result, uint groups) {
+  const uint b = get_global_id(0);
+  if (b >= BINS)
+    return;
+  uint sum = 0;
+  for (uint g = 0; g < groups; ++g)
+    sum += partials[g * BINS + b];
+  result[b] = sum;
+}
+)__";
+
+} // namespace <anonymous>
+
+string histogram_source(const string& prelude, size_t bins,
+                        const bin_index& index) {
+  string result = prelude;
+  result += "#define BINS " + to_string(bins) + "u\n";
+  result += "uint bin_index(T x) {\n";
+  result += index.declarations;
+  result += "  return " + index.expression + ";\n}\n";
+  result += histogram_kernels;
+  return result;
+}
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
@@ -0,0 +1,82 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include "caf/opencl/image.hpp"
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+size_t image_element_size(const cl_image_format& format) {
+  // packed formats store all channels in a single value
+  switch (format.image_channel_data_type) {
+    case CL_UNORM_SHORT_565:
+    case CL_UNORM_SHORT_555:
+      return 2;
+    case CL_UNORM_INT_101010:
+      return 4;
+    default:
+      break;
+  }
+  size_t channel_size;
+  switch (format.image_channel_data_type) {
+    case CL_SNORM_INT8:
+    case CL_UNORM_INT8:
+    case CL_SIGNED_INT8:
+    case CL_UNSIGNED_INT8:
+      channel_size = 1;
+      break;
+    case CL_SNORM_INT16:
+    case CL_UNORM_INT16:
+    case CL_SIGNED_INT16:
+    case CL_UNSIGNED_INT16:
+    case CL_HALF_FLOAT:
+      channel_size = 2;
+      break;
+    case CL_SIGNED_INT32:
+    case CL_UNSIGNED_INT32:
+    case CL_FLOAT:
+      channel_size = 4;
+      break;
+    default:
+      return 0;
+  }
+  switch (format.image_channel_order) {
+    case CL_R:
+    case CL_A:
+    case CL_Rx:
+    case CL_INTENSITY:
+    case CL_LUMINANCE:
+      return channel_size;
+    case CL_RG:
+    case CL_RA:
+    case CL_RGx:
+      return 2 * channel_size;
+    case CL_RGBA:
+    case CL_BGRA:
+    case CL_ARGB:
+      return 4 * channel_size;
+    default:
+      return 0;
+  }
+}
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
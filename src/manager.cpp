@@ -18,7 +18,9 @@
  * http://www.boost.org/LICENSE_1_0.txt.                                      *
  ******************************************************************************/
 
-#include <fstream>
+#include <future>
+#include <cstring>
+#include <sstream>
 
 #include "caf/detail/type_list.hpp"
 
@@ -28,6 +30,7 @@
 #include "caf/opencl/opencl_err.hpp"
 
 #include "caf/opencl/detail/raw_ptr.hpp"
+#include "caf/opencl/detail/mapped_file.hpp"
 
 using namespace std;
 
@@ -47,7 +50,12 @@ optional<device_ptr> manager::find_device(size_t dev_id) const {
   return none;
 }
 
-void manager::init(actor_system_config&) {
+void manager::init(actor_system_config& cfg) {
+  auto cl_cfg = dynamic_cast<config*>(&cfg);
+  if (cl_cfg)
+    options_ = cl_cfg->opencl_options;
+  if (options_.host_pool_size > 0)
+    enable_host_pool(options_.host_pool_size);
   // get number of available platforms
   auto num_platforms = v1get<cl_uint>(CAF_CLF(clGetPlatformIDs));
   // get platform ids
@@ -55,12 +63,18 @@ void manager::init(actor_system_config&) {
   v2callcl(CAF_CLF(clGetPlatformIDs), num_platforms, platform_ids.data());
   if (platform_ids.empty())
     throw std::runtime_error("no OpenCL platform found");
-  // initialize platforms (device discovery)
+  // initialize platforms (device discovery), contexts and command queues
+  // are only created once a device is used
   unsigned current_device_id = 0;
   for (auto& pl_id : platform_ids) {
-    platforms_.push_back(platform::create(pl_id, current_device_id));
-    current_device_id +=
-      static_cast<unsigned>(platforms_.back()->devices().size());
+    auto pl = platform::create(pl_id, current_device_id, options_);
+    if (!pl)
+      continue;
+    CAF_LOG_INFO("discovered OpenCL platform:" << CAF_ARG(pl->name())
+                 << ", devices:" << pl->devices().size()
+                 << ", startup time:" << pl->discovery_time().count() << "us");
+    current_device_id += static_cast<unsigned>(pl->devices().size());
+    platforms_.push_back(std::move(pl));
   }
 }
 
@@ -85,30 +99,24 @@ actor_system::module* manager::make(actor_system& sys,
   return new manager{sys};
 }
 
-program_ptr manager::create_program_from_file(const char* path,
-                                              const char* options,
-                                              uint32_t device_id) {
-  std::ifstream read_source{std::string(path), std::ios::in};
-  string kernel_source;
-  if (read_source) {
-    read_source.seekg(0, std::ios::end);
-    kernel_source.resize(static_cast<size_t>(read_source.tellg()));
-    read_source.seekg(0, std::ios::beg);
-    read_source.read(&kernel_source[0],
-                     static_cast<streamsize>(kernel_source.size()));
-    read_source.close();
-  } else {
-    ostringstream oss;
-    oss << "No file at '" << path << "' found.";
-    CAF_LOG_ERROR(CAF_ARG(oss.str()));
-    throw runtime_error(oss.str());
-  }
-  return create_program(kernel_source.c_str(), options, device_id);
+void manager::enable_host_pool(size_t max_buffers) {
+  host_pool_ = make_counted<host_pool>(max_buffers);
+  // cached programs still refer to the previous pool
+  clear_program_cache();
 }
 
-program_ptr manager::create_program(const char* kernel_source,
-                                    const char* options,
-                                    uint32_t device_id) {
+void manager::clear_program_cache() {
+  unique_lock<mutex> guard{programs_mtx_};
+  program_index_.clear();
+  programs_.clear();
+}
+
+size_t manager::cached_programs() const {
+  unique_lock<mutex> guard{programs_mtx_};
+  return programs_.size();
+}
+
+device_ptr manager::device_by_id(uint32_t device_id) const {
   auto dev = find_device(device_id);
   if (!dev) {
     ostringstream oss;
@@ -116,66 +124,225 @@ program_ptr manager::create_program(const char* kernel_source,
     CAF_LOG_ERROR(CAF_ARG(oss.str()));
     throw runtime_error(oss.str());
   }
-  return create_program(kernel_source, options, *dev);
+  return *dev;
+}
+
+program_ptr manager::create_program_from_file(const char* path,
+                                              const char* options,
+                                              uint32_t device_id) {
+  return create_program_from_file(path, options, device_by_id(device_id));
+}
+
+program_ptr manager::create_program(const char* kernel_source,
+                                    const char* options,
+                                    uint32_t device_id) {
+  return create_program(kernel_source, options, device_by_id(device_id));
 }
 
 program_ptr manager::create_program_from_file(const char* path,
                                               const char* options,
                                               const device_ptr dev) {
-  std::ifstream read_source{std::string(path), std::ios::in};
-  string kernel_source;
-  if (read_source) {
-    read_source.seekg(0, std::ios::end);
-    kernel_source.resize(static_cast<size_t>(read_source.tellg()));
-    read_source.seekg(0, std::ios::beg);
-    read_source.read(&kernel_source[0],
-                     static_cast<streamsize>(kernel_source.size()));
-    read_source.close();
-  } else {
-    ostringstream oss;
-    oss << "No file at '" << path << "' found.";
-    CAF_LOG_ERROR(CAF_ARG(oss.str()));
-    throw runtime_error(oss.str());
-  }
-  return create_program(kernel_source.c_str(), options, dev);
+  detail::mapped_file source{path};
+  return create_program(source.data(), source.size(), options, {dev});
 }
 
 program_ptr manager::create_program(const char* kernel_source,
                                     const char* options,
                                     const device_ptr dev) {
-  // create program object from kernel source
-  size_t kernel_source_length = strlen(kernel_source);
+  return create_program(kernel_source, strlen(kernel_source), options, {dev});
+}
+
+program_ptr manager::create_program(const char* kernel_source,
+                                    const char* options,
+                                    const vector<device_ptr>& devs) {
+  return create_program(kernel_source, strlen(kernel_source), options, devs);
+}
+
+program_ptr manager::create_program_from_il(const void* il, size_t size,
+                                            const char* options,
+                                            uint32_t device_id) {
+  return create_program_from_il(il, size, options, device_by_id(device_id));
+}
+
+program_ptr manager::create_program_from_il(const void* il, size_t size,
+                                            const char* options,
+                                            const device_ptr dev) {
+#ifdef CL_VERSION_2_1
   detail::raw_program_ptr pptr;
-  pptr.reset(v2get(CAF_CLF(clCreateProgramWithSource), dev->context_.get(),
-                           1u, &kernel_source, &kernel_source_length),
+  pptr.reset(v2get(CAF_CLF(clCreateProgramWithIL), dev->context().get(), il,
+                   size),
              false);
-  // build programm from program object
-  auto dev_tmp = dev->device_id_.get();
-  auto err = clBuildProgram(pptr.get(), 1, &dev_tmp, options, nullptr, nullptr);
+  return build_program(pptr, options, {dev}, host_pool_);
+#else
+  static_cast<void>(il);
+  static_cast<void>(size);
+  static_cast<void>(options);
+  static_cast<void>(dev);
+  auto str = "create_program_from_il: requires OpenCL 2.1";
+  CAF_LOG_ERROR(str);
+  throw runtime_error(str);
+#endif
+}
+
+program_ptr manager::create_program_from_il_file(const char* path,
+                                                 const char* options,
+                                                 uint32_t device_id) {
+  return create_program_from_il_file(path, options, device_by_id(device_id));
+}
+
+program_ptr manager::create_program_from_il_file(const char* path,
+                                                 const char* options,
+                                                 const device_ptr dev) {
+  detail::mapped_file il{path};
+  return create_program_from_il(il.data(), il.size(), options, dev);
+}
+
+program_ptr manager::create_program_from_binary(const void* binary,
+                                                size_t size,
+                                                const char* options,
+                                                uint32_t device_id) {
+  return create_program_from_binary(binary, size, options,
+                                    device_by_id(device_id));
+}
+
+program_ptr manager::create_program_from_binary(const void* binary,
+                                                size_t size,
+                                                const char* options,
+                                                const device_ptr dev) {
+  auto dev_id = dev->device_id_.get();
+  auto data = static_cast<const unsigned char*>(binary);
+  cl_int status = CL_SUCCESS;
+  detail::raw_program_ptr pptr;
+  pptr.reset(v2get(CAF_CLF(clCreateProgramWithBinary), dev->context().get(),
+                   1u, &dev_id, &size, &data, &status),
+             false);
+  throwcl("clCreateProgramWithBinary", status);
+  return build_program(pptr, options, {dev}, host_pool_);
+}
+
+program_ptr manager::create_program_from_binary_file(const char* path,
+                                                     const char* options,
+                                                     uint32_t device_id) {
+  return create_program_from_binary_file(path, options,
+                                         device_by_id(device_id));
+}
+
+program_ptr manager::create_program_from_binary_file(const char* path,
+                                                     const char* options,
+                                                     const device_ptr dev) {
+  detail::mapped_file binary{path};
+  return create_program_from_binary(binary.data(), binary.size(), options,
+                                    dev);
+}
+
+program_ptr manager::create_program(const char* kernel_source,
+                                    size_t kernel_source_length,
+                                    const char* options,
+                                    const vector<device_ptr>& devs) {
+  if (devs.empty())
+    throw runtime_error("create_program: no devices given");
+  for (auto& dev : devs) {
+    if (!dev->shares_context(*devs.front())) {
+      auto str = "create_program: devices do not share a context";
+      CAF_LOG_ERROR(str);
+      throw runtime_error(str);
+    }
+  }
+  string key;
+  for (auto& dev : devs) {
+    key += to_string(dev->id());
+    key += ',';
+  }
+  key += '\0';
+  if (options != nullptr)
+    key += options;
+  key += '\0';
+  key.append(kernel_source, kernel_source_length);
+  promise<program_ptr> building;
+  { // lifetime scope of guard
+    unique_lock<mutex> guard{programs_mtx_};
+    auto i = program_index_.find(key);
+    if (i != program_index_.end()) {
+      programs_.splice(programs_.begin(), programs_, i->second);
+      return i->second->second;
+    }
+    auto j = building_.find(key);
+    if (j != building_.end()) {
+      auto pending = j->second;
+      guard.unlock();
+      return pending.get(); // rethrows build errors
+    }
+    building_.emplace(key, building.get_future().share());
+  }
+  program_ptr result;
+  try {
+    // create program object from kernel source
+    detail::raw_program_ptr pptr;
+    pptr.reset(v2get(CAF_CLF(clCreateProgramWithSource),
+                     devs.front()->context().get(), 1u, &kernel_source,
+                     &kernel_source_length),
+               false);
+    result = build_program(pptr, options, devs, host_pool_);
+  } catch (...) {
+    // waiting callers see the error, later calls try again
+    building.set_exception(current_exception());
+    unique_lock<mutex> guard{programs_mtx_};
+    building_.erase(key);
+    throw;
+  }
+  { // lifetime scope of guard
+    unique_lock<mutex> guard{programs_mtx_};
+    auto limit = options_.max_cached_programs;
+    while (!programs_.empty() && programs_.size() >= limit) {
+      program_index_.erase(programs_.back().first);
+      programs_.pop_back();
+    }
+    if (limit > 0) {
+      programs_.emplace_front(key, result);
+      program_index_.emplace(key, programs_.begin());
+    }
+    building_.erase(key);
+  }
+  building.set_value(result);
+  return result;
+}
+
+program_ptr manager::build_program(detail::raw_program_ptr pptr,
+                                   const char* options,
+                                   vector<device_ptr> devs,
+                                   host_pool_ptr pool) {
+  // build programm from program object, once for all devices
+  vector<cl_device_id> dev_ids;
+  for (auto& dev : devs)
+    dev_ids.push_back(dev->device_id_.get());
+  auto err = clBuildProgram(pptr.get(), static_cast<cl_uint>(dev_ids.size()),
+                            dev_ids.data(), options, nullptr, nullptr);
   if (err != CL_SUCCESS) {
     ostringstream oss;
     oss << "clBuildProgram: " << opencl_error(err);
     if (err == CL_BUILD_PROGRAM_FAILURE) {
-      size_t buildlog_buffer_size = 0;
-      // get the log length
-      clGetProgramBuildInfo(pptr.get(), dev_tmp, CL_PROGRAM_BUILD_LOG,
-                            0, nullptr, &buildlog_buffer_size);
-      vector<char> buffer(buildlog_buffer_size);
-      // fill the buffer with buildlog informations
-      clGetProgramBuildInfo(pptr.get(), dev_tmp, CL_PROGRAM_BUILD_LOG,
-                            sizeof(char) * buildlog_buffer_size,
-                            buffer.data(), nullptr);
-      ostringstream ss;
-      ss << "############## Build log ##############"
-         << endl << string(buffer.data()) << endl
-         << "#######################################";
-      // seems that just apple implemented the
-      // pfn_notify callback, but we can get
-      // the build log
+      for (auto dev_tmp : dev_ids) {
+        size_t buildlog_buffer_size = 0;
+        // get the log length
+        clGetProgramBuildInfo(pptr.get(), dev_tmp, CL_PROGRAM_BUILD_LOG,
+                              0, nullptr, &buildlog_buffer_size);
+        vector<char> buffer(buildlog_buffer_size);
+        // fill the buffer with buildlog informations
+        clGetProgramBuildInfo(pptr.get(), dev_tmp, CL_PROGRAM_BUILD_LOG,
+                              sizeof(char) * buildlog_buffer_size,
+                              buffer.data(), nullptr);
+        ostringstream ss;
+        ss << "############## Build log ##############"
+           << endl << string(buffer.data()) << endl
+           << "#######################################";
+        // seems that just apple implemented the
+        // pfn_notify callback, but we can get
+        // the build log
 #ifndef __APPLE__
-      CAF_LOG_ERROR(CAF_ARG(ss.str()));
+        CAF_LOG_ERROR(CAF_ARG(ss.str()));
 #endif
-      oss << endl << ss.str();
+        oss << endl << ss.str();
+      }
     }
     throw runtime_error(oss.str());
   }
@@ -212,8 +379,28 @@ program_ptr manager::create_program(const char* kernel_source,
                     " on some platforms, we'll ignore this and try to build"
                     " each kernel individually by name.");
   }
-  return make_counted<program>(dev->context_, dev->queue_, pptr,
-                               move(available_kernels));
+  auto& dev = devs.front();
+  return make_counted<program>(dev, dev->context(), dev->queue(), pptr,
+                               move(available_kernels), move(pool),
+                               move(devs));
+}
+
+program_family_ptr manager::create_program_family(const char* kernel_source,
+                                                  const char* options,
+                                                  const device_ptr dev,
+                                                  size_t max_variants) {
+  return make_counted<program_family>(kernel_source,
+                                      options != nullptr ? options : "",
+                                      dev, max_variants,
+                                      options_.program_cache_dir, host_pool_);
+}
+
+program_family_ptr manager::create_program_family(const char* kernel_source,
+                                                  const char* options,
+                                                  uint32_t device_id,
+                                                  size_t max_variants) {
+  return create_program_family(kernel_source, options,
+                               device_by_id(device_id), max_variants);
 }
 
 manager::manager(actor_system& sys) : system_(sys) {
@@ -0,0 +1,93 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "caf/config.hpp"
+#include "caf/logger.hpp"
+
+#ifndef CAF_WINDOWS
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "caf/opencl/detail/mapped_file.hpp"
+
+using namespace std;
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+namespace {
+
+[[noreturn]] void no_such_file(const char* path) {
+  ostringstream oss;
+  oss << "No file at '" << path << "' found.";
+  CAF_LOG_ERROR(CAF_ARG(oss.str()));
+  throw runtime_error(oss.str());
+}
+
+} // namespace <anonymous>
+
+mapped_file::mapped_file(const char* path)
+    : data_(nullptr),
+      size_(0),
+      mapped_(false) {
+#ifndef CAF_WINDOWS
+  auto fd = open(path, O_RDONLY);
+  if (fd < 0)
+    no_such_file(path);
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    auto size = static_cast<size_t>(st.st_size);
+    auto ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (ptr != MAP_FAILED) {
+      data_ = static_cast<const char*>(ptr);
+      size_ = size;
+      mapped_ = true;
+    }
+  }
+  close(fd);
+  if (mapped_)
+    return;
+#endif
+  // fall back to reading files that cannot be mapped, e.g., pipes
+  ifstream in{path, ios::binary};
+  if (!in)
+    no_such_file(path);
+  buf_.assign(istreambuf_iterator<char>{in}, istreambuf_iterator<char>{});
+  data_ = buf_.data();
+  size_ = buf_.size();
+}
+
+mapped_file::~mapped_file() {
+#ifndef CAF_WINDOWS
+  if (mapped_)
+    munmap(const_cast<char*>(data_), size_);
+#endif
+}
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
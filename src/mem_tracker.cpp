@@ -0,0 +1,345 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include "caf/logger.hpp"
+
+#include "caf/opencl/opencl_err.hpp"
+
+#include "caf/opencl/detail/mem_tracker.hpp"
+#include "caf/opencl/detail/spill_slot.hpp"
+
+using namespace std;
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+mem_tracker::mem_tracker(size_t budget, size_t max_pooled)
+    : budget_(budget),
+      max_pooled_(max_pooled),
+      evictions_(0),
+      failed_allocations_(0),
+      spilling_(false),
+      spilled_(0),
+      spills_(0),
+      restores_(0),
+      bytes_spilled_(0),
+      bytes_restored_(0) {
+  counters_.fill(0);
+}
+
+mem_tracker::~mem_tracker() {
+  // nop
+}
+
+raw_mem_ptr mem_tracker::allocate(cl_context context, cl_mem_flags flags,
+                                  size_t bytes, mem_kind kind) {
+  return allocate(flags, bytes, kind, false, "clCreateBuffer",
+                  [&](cl_int& err) {
+                    return clCreateBuffer(context, flags, bytes, nullptr, &err);
+                  });
+}
+
+raw_mem_ptr mem_tracker::allocate_image(cl_context context,
+                                        cl_mem_flags flags,
+                                        const cl_image_format& format,
+                                        const cl_image_desc& desc,
+                                        size_t bytes, mem_kind kind) {
+  return allocate(flags, bytes, kind, true, "clCreateImage",
+                  [&](cl_int& err) {
+                    return clCreateImage(context, flags, &format, &desc,
+                                         nullptr, &err);
+                  });
+}
+
+raw_mem_ptr mem_tracker::allocate(cl_mem_flags flags, size_t bytes,
+                                  mem_kind kind, bool image,
+                                  const char* fname,
+                                  const create_fun& create) {
+  vector<raw_mem_ptr> evicted;
+  vector<spill_slot*> victims;
+  for (auto spilled = false; ; spilled = true) {
+    unique_lock<mutex> guard{mtx_};
+    for (auto i = idle_.begin(); !image && i != idle_.end(); ++i) {
+      auto rec = live_[i->get()];
+      if (rec->bytes == bytes && rec->flags == flags) {
+        auto result = move(*i);
+        idle_.erase(i);
+        counter(mem_kind::pooled) -= bytes;
+        counter(kind) += bytes;
+        rec->kind = kind;
+        return result;
+      }
+    }
+    if (total() + bytes > budget_) {
+      // evicted buffers leave the accounting once they are released below
+      auto freed = take_idle(total() + bytes - budget_, evicted);
+      if (total() - freed + bytes > budget_) {
+        // spill once, then check again whether the allocation fits
+        if (spilling_ && !spilled
+            && take_victims(total() - freed + bytes - budget_, victims) > 0) {
+          guard.unlock();
+          evicted.clear();
+          spill(victims);
+          continue;
+        }
+        ++failed_allocations_;
+        ostringstream oss;
+        oss << fname << ": allocating " << bytes << " bytes exceeds the"
+            << " device memory budget of " << budget_ << " bytes";
+        CAF_LOG_ERROR(CAF_ARG(oss.str()));
+        guard.unlock();
+        throw runtime_error(oss.str());
+      }
+    }
+    // reserve the memory before leaving the critical section
+    counter(kind) += bytes;
+    break;
+  }
+  evicted.clear(); // releases evicted buffers outside of the critical section
+  auto rollback = [&] {
+    unique_lock<mutex> guard{mtx_};
+    counter(kind) -= bytes;
+    ++failed_allocations_;
+  };
+  cl_int err;
+  auto buf = create(err);
+  if (err == CL_MEM_OBJECT_ALLOCATION_FAILURE || err == CL_OUT_OF_RESOURCES) {
+    CAF_LOG_DEBUG("allocation failed, evict idle buffers and retry");
+    evict(numeric_limits<size_t>::max());
+    buf = create(err);
+  }
+  if (err != CL_SUCCESS) {
+    rollback();
+    throwcl(fname, err);
+  }
+  raw_mem_ptr result{buf, false};
+  auto rec = new record{mem_tracker_ptr{this}, bytes, flags, kind, nullptr,
+                        image};
+  { // lifetime scope of guard
+    unique_lock<mutex> guard{mtx_};
+    live_[buf] = rec;
+  }
+  err = clSetMemObjectDestructorCallback(buf, destructor_callback, rec);
+  if (err != CL_SUCCESS) {
+    { // lifetime scope of guard
+      unique_lock<mutex> guard{mtx_};
+      live_.erase(buf);
+    }
+    delete rec;
+    rollback();
+    throwcl("clSetMemObjectDestructorCallback", err);
+  }
+  return result;
+}
+
+bool mem_tracker::recycle(raw_mem_ptr& buf) {
+  if (!buf)
+    return true;
+  unique_lock<mutex> guard{mtx_};
+  auto i = live_.find(buf.get());
+  if (i == live_.end())
+    return false;
+  auto rec = i->second;
+  if (rec->slot) {
+    rec->slot->unpin();
+    return true;
+  }
+  if (rec->image || rec->kind == mem_kind::reference
+      || rec->kind == mem_kind::cached
+      || rec->kind == mem_kind::pooled
+      || counter(mem_kind::pooled) + rec->bytes > max_pooled_)
+    return true; // the caller releases buf after the guard
+  counter(rec->kind) -= rec->bytes;
+  counter(mem_kind::pooled) += rec->bytes;
+  rec->kind = mem_kind::pooled;
+  idle_.push_back(move(buf));
+  return true;
+}
+
+size_t mem_tracker::evict(size_t bytes) {
+  vector<raw_mem_ptr> evicted;
+  size_t freed;
+  { // lifetime scope of guard
+    unique_lock<mutex> guard{mtx_};
+    freed = take_idle(bytes, evicted);
+  }
+  return freed;
+}
+
+memory_usage mem_tracker::usage() const {
+  unique_lock<mutex> guard{mtx_};
+  memory_usage result;
+  result.input = counters_[static_cast<size_t>(mem_kind::input)];
+  result.output = counters_[static_cast<size_t>(mem_kind::output)];
+  result.scratch = counters_[static_cast<size_t>(mem_kind::scratch)];
+  result.pooled = counters_[static_cast<size_t>(mem_kind::pooled)];
+  result.reference = counters_[static_cast<size_t>(mem_kind::reference)];
+  result.cached = counters_[static_cast<size_t>(mem_kind::cached)];
+  result.budget = budget_;
+  result.evictions = evictions_;
+  result.failed_allocations = failed_allocations_;
+  result.spilled = spilled_;
+  result.spills = spills_;
+  result.restores = restores_;
+  result.bytes_spilled = bytes_spilled_;
+  result.bytes_restored = bytes_restored_;
+  return result;
+}
+
+void mem_tracker::budget(size_t bytes) {
+  unique_lock<mutex> guard{mtx_};
+  budget_ = bytes;
+}
+
+void mem_tracker::spilling(bool enabled) {
+  unique_lock<mutex> guard{mtx_};
+  spilling_ = enabled;
+}
+
+bool mem_tracker::spilling() const {
+  unique_lock<mutex> guard{mtx_};
+  return spilling_;
+}
+
+void mem_tracker::destructor_callback(cl_mem buf, void* data) {
+  auto rec = reinterpret_cast<record*>(data);
+  auto tracker = rec->tracker;
+  tracker->released(buf, rec);
+}
+
+void mem_tracker::released(cl_mem buf, record* rec) {
+  { // lifetime scope of guard
+    unique_lock<mutex> guard{mtx_};
+    counter(rec->kind) -= rec->bytes;
+    live_.erase(buf);
+  }
+  delete rec;
+}
+
+size_t mem_tracker::total() const {
+  size_t result = 0;
+  for (auto x : counters_)
+    result += x;
+  return result;
+}
+
+size_t mem_tracker::take_idle(size_t bytes, vector<raw_mem_ptr>& out) {
+  size_t freed = 0;
+  while (freed < bytes && !idle_.empty()) {
+    freed += live_[idle_.front().get()]->bytes;
+    out.push_back(move(idle_.front()));
+    idle_.pop_front();
+    ++evictions_;
+  }
+  return freed;
+}
+
+size_t mem_tracker::take_victims(size_t bytes, vector<spill_slot*>& out) {
+  size_t found = 0;
+  for (auto i = lru_.begin(); i != lru_.end() && found < bytes; ++i) {
+    auto slot = *i;
+    if (slot->busy_ || slot->pins_ > 0)
+      continue;
+    found += slot->bytes_;
+    out.push_back(slot);
+  }
+  if (found < bytes) {
+    // spilling would not make enough room
+    out.clear();
+    return 0;
+  }
+  for (auto slot : out)
+    slot->busy_ = true;
+  return found;
+}
+
+void mem_tracker::spill(vector<spill_slot*>& victims) {
+  for (auto slot : victims)
+    slot->spill();
+  unique_lock<mutex> guard{mtx_};
+  for (auto slot : victims)
+    slot->busy_ = false;
+  victims.clear();
+  cv_.notify_all();
+}
+
+void mem_tracker::attach(spill_slot* slot, cl_mem buf, bool restored) {
+  unique_lock<mutex> guard{mtx_};
+  auto i = live_.find(buf);
+  if (i != live_.end())
+    i->second->slot = slot;
+  slot->lru_pos_ = lru_.insert(lru_.end(), slot);
+  slot->in_lru_ = true;
+  if (restored) {
+    spilled_ -= slot->bytes_;
+    ++restores_;
+    bytes_restored_ += slot->bytes_;
+  }
+}
+
+void mem_tracker::detach(spill_slot* slot, cl_mem buf) {
+  unique_lock<mutex> guard{mtx_};
+  auto i = live_.find(buf);
+  if (i != live_.end()) {
+    // the destructor callback of the buffer must not count it again
+    auto rec = i->second;
+    counter(rec->kind) -= rec->bytes;
+    rec->bytes = 0;
+    rec->slot = nullptr;
+  }
+  if (slot->in_lru_) {
+    lru_.erase(slot->lru_pos_);
+    slot->in_lru_ = false;
+  }
+  spilled_ += slot->bytes_;
+  ++spills_;
+  bytes_spilled_ += slot->bytes_;
+}
+
+void mem_tracker::touch(spill_slot* slot) {
+  unique_lock<mutex> guard{mtx_};
+  if (slot->in_lru_)
+    lru_.splice(lru_.end(), lru_, slot->lru_pos_);
+}
+
+void mem_tracker::forget(spill_slot* slot) {
+  unique_lock<mutex> guard{mtx_};
+  // another thread may spill the slot right now
+  cv_.wait(guard, [&] { return !slot->busy_; });
+  if (slot->in_lru_) {
+    lru_.erase(slot->lru_pos_);
+    slot->in_lru_ = false;
+  }
+  if (slot->spilled_) {
+    spilled_ -= slot->bytes_;
+    return;
+  }
+  auto i = live_.find(slot->device_.get());
+  if (i != live_.end())
+    i->second->slot = nullptr;
+}
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
@@ -17,9 +17,15 @@
  * http://www.boost.org/LICENSE_1_0.txt.                                      *
  ******************************************************************************/
 
+#include <regex>
+#include <chrono>
 #include <utility>
 #include <vector>
 #include <iostream>
+#include <algorithm>
+
+#include "caf/logger.hpp"
+#include "caf/string_algorithms.hpp"
 
 #include "caf/opencl/platform.hpp"
 #include "caf/opencl/opencl_err.hpp"
@@ -29,13 +35,61 @@ using namespace std;
 namespace caf {
 namespace opencl {
 
+namespace {
+
+// Parses a comma-separated list of device types, keeping the order in which
+// device IDs have always been assigned: GPUs, accelerators and then CPUs.
+vector<cl_device_type> device_types_from_string(const string& str) {
+  vector<string> tokens;
+  split(tokens, str, ",", false);
+  bool gpus = false;
+  bool accelerators = false;
+  bool cpus = false;
+  for (auto& token : tokens) {
+    if (token == "gpu") {
+      gpus = true;
+    } else if (token == "accelerator") {
+      accelerators = true;
+    } else if (token == "cpu") {
+      cpus = true;
+    } else if (token == "all") {
+      gpus = accelerators = cpus = true;
+    } else {
+      string errstr = "unknown OpenCL device type: " + token;
+      CAF_LOG_ERROR(CAF_ARG(errstr));
+      throw runtime_error(move(errstr));
+    }
+  }
+  vector<cl_device_type> result;
+  if (gpus)
+    result.push_back(CL_DEVICE_TYPE_GPU);
+  if (accelerators)
+    result.push_back(CL_DEVICE_TYPE_ACCELERATOR);
+  if (cpus)
+    result.push_back(CL_DEVICE_TYPE_CPU);
+  return result;
+}
+
+bool contains(const string& str, const string& what) {
+  return what.empty() || str.find(what) != string::npos;
+}
+
+} // namespace <anonymous>
+
 platform_ptr platform::create(cl_platform_id platform_id,
-                              unsigned start_id) {
-  vector<unsigned> device_types = {CL_DEVICE_TYPE_GPU,
-                                   CL_DEVICE_TYPE_ACCELERATOR,
-                                   CL_DEVICE_TYPE_CPU};
+                              unsigned start_id, const options& opts) {
+  auto t0 = chrono::steady_clock::now();
+  auto name = platform_info(platform_id, CL_PLATFORM_NAME);
+  auto vendor = platform_info(platform_id, CL_PLATFORM_VENDOR);
+  if (!contains(name, opts.platform_name)
+      || !contains(vendor, opts.platform_vendor)) {
+    CAF_LOG_DEBUG("skip filtered platform:" << CAF_ARG(name)
+                  << CAF_ARG(vendor));
+    return nullptr;
+  }
+  auto version = platform_info(platform_id, CL_PLATFORM_VERSION);
   vector<cl_device_id> ids;
-  for (cl_device_type device_type : device_types) {
+  for (auto device_type : device_types_from_string(opts.device_types)) {
     auto known = ids.size();
     cl_uint discoverd;
     auto err = clGetDeviceIDs(platform_id, device_type, 0, nullptr, &discoverd);
@@ -48,33 +102,29 @@ platform_ptr platform::create(cl_platform_id platform_id,
     v2callcl(CAF_CLF(clGetDeviceIDs), platform_id, device_type,
              discoverd, (ids.data() + known));
   }
-  vector<detail::raw_device_ptr> devices;
-  devices.resize(ids.size());
-  auto lift = [](cl_device_id ptr) {
-    return detail::raw_device_ptr{ptr, false};
-  };
-  transform(ids.begin(), ids.end(), devices.begin(), lift);
-  detail::raw_context_ptr context;
-  context.reset(v2get(CAF_CLF(clCreateContext), nullptr,
-                      static_cast<unsigned>(ids.size()),
-                      ids.data(), pfn_notify, nullptr),
-                false);
-  vector<device_ptr> device_information;
-  for (auto& device_id : devices) {
-    device_information.push_back(device::create(context, device_id,
-                                                start_id++));
+  if (!opts.device_name.empty()) {
+    regex rx{opts.device_name};
+    auto filtered = [&](cl_device_id id) {
+      detail::raw_device_ptr ptr{id, false};
+      return !regex_search(device::info_string(ptr, CL_DEVICE_NAME), rx);
+    };
+    ids.erase(remove_if(ids.begin(), ids.end(), filtered), ids.end());
   }
-  if (device_information.empty()) {
-    string errstr = "no devices for the platform found";
-    CAF_LOG_ERROR(CAF_ARG(errstr));
-    throw runtime_error(move(errstr));
+  if (ids.empty()) {
+    CAF_LOG_INFO("no devices for the platform found:" << CAF_ARG(name));
+    return nullptr;
   }
-  auto name = platform_info(platform_id, CL_PLATFORM_NAME);
-  auto vendor = platform_info(platform_id, CL_PLATFORM_VENDOR);
-  auto version = platform_info(platform_id, CL_PLATFORM_VERSION);
+  // the context is created once the first device is actually used
+  auto context = make_counted<detail::lazy_context>(ids);
+  vector<device_ptr> devices;
+  for (auto id : ids)
+    devices.push_back(device::create(context, detail::raw_device_ptr{id, false},
+                                     start_id++, opts));
+  auto t1 = chrono::steady_clock::now();
+  auto discovery_time = chrono::duration_cast<chrono::microseconds>(t1 - t0);
   return make_counted<platform>(platform_id, move(context), move(name),
-                                move(vendor), move(version),
-                                move(device_information));
+                                move(vendor), move(version), move(devices),
+                                discovery_time);
 }
 
 string platform::platform_info(cl_platform_id platform_id,
@@ -89,15 +139,18 @@ string platform::platform_info(cl_platform_id platform_id,
   return string(buffer.data());
 }
 
-platform::platform(cl_platform_id platform_id, detail::raw_context_ptr context,
+platform::platform(cl_platform_id platform_id,
+                   detail::lazy_context_ptr context,
                    string name, string vendor, string version,
-                   vector<device_ptr> devices)
+                   vector<device_ptr> devices,
+                   chrono::microseconds discovery_time)
   : platform_id_(platform_id),
     context_(std::move(context)),
     name_(move(name)),
     vendor_(move(vendor)),
     version_(move(version)),
-    devices_(move(devices)) {
+    devices_(move(devices)),
+    discovery_time_(discovery_time) {
   // nop
 }
 
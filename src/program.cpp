@@ -20,8 +20,12 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <sstream>
 #include <cstring>
 #include <iostream>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
 
 #include "caf/opencl/manager.hpp"
 #include "caf/opencl/program.hpp"
@@ -32,14 +36,19 @@ using namespace std;
 namespace caf {
 namespace opencl {
 
-program::program(detail::raw_context_ptr context,
+program::program(device_ptr dev,
+                 detail::raw_context_ptr context,
                  detail::raw_command_queue_ptr queue,
                  detail::raw_program_ptr prog,
-                 map<string, detail::raw_kernel_ptr> available_kernels)
-    : context_(move(context)),
+                 map<string, detail::raw_kernel_ptr> available_kernels,
+                 host_pool_ptr pool, vector<device_ptr> devices)
+    : device_(move(dev)),
+      context_(move(context)),
       program_(move(prog)),
       queue_(move(queue)),
-      available_kernels_(move(available_kernels)) {
+      available_kernels_(move(available_kernels)),
+      pool_(move(pool)),
+      devices_(move(devices)) {
   // nop
 }
 
@@ -47,5 +56,61 @@ program::~program() {
   // nop
 }
 
+program_ptr program::for_device(const device_ptr& dev) {
+  if (dev == device_)
+    return program_ptr{this};
+  if (find(devices_.begin(), devices_.end(), dev) == devices_.end()) {
+    ostringstream oss;
+    oss << "program was not built for device " << dev->id();
+    CAF_LOG_ERROR(CAF_ARG(oss.str()));
+    throw runtime_error(oss.str());
+  }
+  // kernels built along with this program remain with the first device
+  return make_counted<program>(dev, context_, dev->queue(), program_,
+                               map<string, detail::raw_kernel_ptr>{}, pool_,
+                               devices_);
+}
+
+vector<unsigned char> program::binary() const {
+  auto num_devices = v3get<cl_uint>(CAF_CLF(clGetProgramInfo), program_.get(),
+                                    static_cast<cl_program_info>(
+                                      CL_PROGRAM_NUM_DEVICES));
+  vector<cl_device_id> ids(num_devices);
+  v1callcl(CAF_CLF(clGetProgramInfo), program_.get(),
+           static_cast<cl_program_info>(CL_PROGRAM_DEVICES),
+           sizeof(cl_device_id) * num_devices, ids.data(), nullptr);
+  vector<size_t> sizes(num_devices);
+  v1callcl(CAF_CLF(clGetProgramInfo), program_.get(),
+           static_cast<cl_program_info>(CL_PROGRAM_BINARY_SIZES),
+           sizeof(size_t) * num_devices, sizes.data(), nullptr);
+  auto i = find(ids.begin(), ids.end(), device_->device_id_.get());
+  if (i == ids.end())
+    throw runtime_error("program has no binary for its device");
+  auto pos = static_cast<size_t>(distance(ids.begin(), i));
+  // the query skips devices with a null destination
+  vector<unsigned char> result(sizes[pos]);
+  vector<unsigned char*> dsts(num_devices, nullptr);
+  dsts[pos] = result.data();
+  v1callcl(CAF_CLF(clGetProgramInfo), program_.get(),
+           static_cast<cl_program_info>(CL_PROGRAM_BINARIES),
+           sizeof(unsigned char*) * num_devices, dsts.data(), nullptr);
+  return result;
+}
+
+detail::raw_kernel_ptr program::kernel(const char* name) {
+  { // lifetime scope of guard
+    unique_lock<mutex> guard{kernels_mtx_};
+    auto i = available_kernels_.find(name);
+    if (i != available_kernels_.end()) {
+      auto result = move(i->second);
+      available_kernels_.erase(i);
+      return result;
+    }
+  }
+  detail::raw_kernel_ptr result;
+  result.reset(v2get(CAF_CLF(clCreateKernel), program_.get(), name), false);
+  return result;
+}
+
 } // namespace opencl
 } // namespace caf
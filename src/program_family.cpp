@@ -0,0 +1,245 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include <cstdio>
+#include <future>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iterator>
+
+#include "caf/config.hpp"
+
+#ifdef CAF_WINDOWS
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "caf/opencl/manager.hpp"
+#include "caf/opencl/opencl_err.hpp"
+#include "caf/opencl/program_family.hpp"
+
+#include "caf/opencl/detail/hash.hpp"
+
+using namespace std;
+
+namespace caf {
+namespace opencl {
+
+namespace {
+
+long process_id() {
+#ifdef CAF_WINDOWS
+  return static_cast<long>(_getpid());
+#else
+  return static_cast<long>(getpid());
+#endif
+}
+
+} // namespace <anonymous>
+
+program_family::program_family(string source, string options, device_ptr dev,
+                               size_t max_variants, string cache_dir,
+                               host_pool_ptr pool)
+    : source_(move(source)),
+      options_(move(options)),
+      device_(move(dev)),
+      max_variants_(max_variants > 0 ? max_variants : 1),
+      cache_dir_(move(cache_dir)),
+      pool_(move(pool)),
+      stats_{0, 0, 0, 0} {
+  // nop
+}
+
+program_family::~program_family() {
+  // nop
+}
+
+program_ptr program_family::variant(const defines& xs) {
+  auto opts = build_options(xs);
+  promise<program_ptr> building;
+  { // lifetime scope of guard
+    unique_lock<mutex> guard{mtx_};
+    auto i = index_.find(opts);
+    if (i != index_.end()) {
+      ++stats_.hits;
+      variants_.splice(variants_.begin(), variants_, i->second);
+      return i->second->second;
+    }
+    // concurrent callers wait for a single build of the same variant
+    auto j = building_.find(opts);
+    if (j != building_.end()) {
+      auto pending = j->second;
+      guard.unlock();
+      return pending.get(); // rethrows build errors
+    }
+    building_.emplace(opts, building.get_future().share());
+  }
+  program_ptr prog;
+  try {
+    // compiling outside of the lock keeps other variants available
+    prog = build(opts);
+  } catch (...) {
+    building.set_exception(current_exception());
+    unique_lock<mutex> guard{mtx_};
+    building_.erase(opts);
+    throw;
+  }
+  { // lifetime scope of guard
+    unique_lock<mutex> guard{mtx_};
+    while (variants_.size() >= max_variants_) {
+      index_.erase(variants_.back().first);
+      variants_.pop_back();
+      ++stats_.evictions;
+    }
+    variants_.emplace_front(opts, prog);
+    index_.emplace(opts, variants_.begin());
+    building_.erase(opts);
+  }
+  building.set_value(prog);
+  return prog;
+}
+
+string program_family::build_options(const defines& xs) const {
+  string result = options_;
+  for (auto& x : xs) {
+    if (!result.empty())
+      result += ' ';
+    result += "-D ";
+    result += x.first;
+    if (!x.second.empty()) {
+      result += '=';
+      result += x.second;
+    }
+  }
+  return result;
+}
+
+size_t program_family::live_variants() const {
+  unique_lock<mutex> guard{mtx_};
+  return variants_.size();
+}
+
+program_family::statistics program_family::stats() const {
+  unique_lock<mutex> guard{mtx_};
+  return stats_;
+}
+
+program_ptr program_family::build(const string& options) {
+  string path;
+  if (!cache_dir_.empty()) {
+    path = cache_path(options);
+    auto prog = load(path, options);
+    if (prog) {
+      unique_lock<mutex> guard{mtx_};
+      ++stats_.loads;
+      return prog;
+    }
+  }
+  auto src = source_.c_str();
+  auto len = source_.size();
+  detail::raw_program_ptr pptr;
+  pptr.reset(v2get(CAF_CLF(clCreateProgramWithSource),
+                   device_->context().get(), 1u, &src, &len),
+             false);
+  auto prog = manager::build_program(pptr, options.c_str(), {device_}, pool_);
+  { // lifetime scope of guard
+    unique_lock<mutex> guard{mtx_};
+    ++stats_.builds;
+  }
+  if (!path.empty())
+    store(prog, path);
+  return prog;
+}
+
+string program_family::cache_path(const string& options) const {
+  // binaries only fit the device and driver that created them
+  string key = device_->name();
+  key += '\n';
+  key += device_->driver_version();
+  key += '\n';
+  key += options;
+  key += '\n';
+  key += source_;
+  ostringstream oss;
+  oss << cache_dir_ << '/' << hex << setw(16) << setfill('0')
+      << detail::hash(key.data(), key.size()) << ".bin";
+  return oss.str();
+}
+
+program_ptr program_family::load(const string& path, const string& options) {
+  ifstream in{path, ios::binary};
+  if (!in)
+    return nullptr;
+  vector<unsigned char> binary((istreambuf_iterator<char>(in)),
+                              istreambuf_iterator<char>());
+  if (binary.empty())
+    return nullptr;
+  auto dev_id = device_->device_id_.get();
+  auto len = binary.size();
+  const unsigned char* data = binary.data();
+  cl_int status = CL_SUCCESS;
+  cl_int err = CL_SUCCESS;
+  detail::raw_program_ptr pptr;
+  pptr.reset(clCreateProgramWithBinary(device_->context().get(), 1, &dev_id,
+                                       &len, &data, &status, &err),
+             false);
+  if (err != CL_SUCCESS || status != CL_SUCCESS) {
+    CAF_LOG_WARNING("discard cached program binary:" << CAF_ARG(path)
+                    << ", error:" << opencl_error(err));
+    return nullptr;
+  }
+  try {
+    return manager::build_program(pptr, options.c_str(), {device_}, pool_);
+  } catch (std::runtime_error& e) {
+    CAF_LOG_WARNING("discard cached program binary:" << CAF_ARG(path)
+                    << ", error:" << e.what());
+    return nullptr;
+  }
+}
+
+void program_family::store(const program_ptr& prog, const string& path) {
+  vector<unsigned char> binary;
+  try {
+    binary = prog->binary();
+  } catch (std::runtime_error&) {
+    return;
+  }
+  if (binary.empty())
+    return;
+  // concurrent processes never observe partially written binaries, since
+  // each one writes to a file of its own before renaming it
+  auto tmp = path + "." + to_string(process_id()) + ".tmp";
+  {
+    ofstream out{tmp, ios::binary | ios::trunc};
+    if (!out)
+      return;
+    out.write(reinterpret_cast<const char*>(binary.data()),
+              static_cast<streamsize>(binary.size()));
+    if (!out)
+      return;
+  }
+  if (std::rename(tmp.c_str(), path.c_str()) != 0)
+    std::remove(tmp.c_str());
+}
+
+} // namespace opencl
+} // namespace caf
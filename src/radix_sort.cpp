@@ -0,0 +1,159 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+
+#include "caf/opencl/radix_sort.hpp"
+
+using namespace std;
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+namespace {
+
+// Each group sorts a tile of the input in steps of one element per work item.
+// The counts of all tiles are stored by digit first, such that an exclusive
+// scan over the counts yields the output offset of each digit per tile.
+constexpr const char* radix_kernels = R"__(
+uint digit(K x, uint shift) {
+  return (uint) ((key_bits(x) >> shift) & (RADIX - 1));
+}
+
+/// Counts the digits at `shift` in the tile of each group.
+kernel void radix_count(global const K* restrict keys,
+                        global uint* restrict counts,
+                        local uint* bins, uint len, uint shift, uint tile) {
+  const uint thread = get_local_id(0);
+  const uint size = get_local_size(0);
+  const uint group = get_group_id(0);
+  for (uint d = thread; d < RADIX; d += size)
+    bins[d] = 0;
+  barrier(CLK_LOCAL_MEM_FENCE);
+  const uint first = group * tile;
+  const uint last = min(first + tile, len);
+  for (uint i = first + thread; i < last; i += size)
+    atomic_inc(&bins[digit(keys[i], shift)]);
+  barrier(CLK_LOCAL_MEM_FENCE);
+  for (uint d = thread; d < RADIX; d += size)
+    counts[d * get_num_groups(0) + group] = bins[d];
+}
+
+/// Moves the elements of the tile of each group to their offsets. Each step
+/// sorts its elements by digit in local memory, one bit at a time, to find
+/// the rank of each element among the elements with the same digit while
+/// keeping the order of equal digits.
+kernel void radix_scatter(global const K* restrict keys_in,
+                          global K* restrict keys_out,
+#ifdef WITH_VALUES
+                          global const V* restrict values_in,
+                          global V* restrict values_out,
+#endif
+                          global const uint* restrict offsets,
+                          local uint* digits, local uint* order,
+                          local uint* tmp, local uint* bins,
+                          uint len, uint shift, uint tile) {
+  const uint thread = get_local_id(0);
+  const uint size = get_local_size(0);
+  const uint group = get_group_id(0);
+  local uint* base = bins;
+  local uint* start = bins + RADIX;
+  for (uint d = thread; d < RADIX; d += size)
+    base[d] = offsets[d * get_num_groups(0) + group];
+  const uint first = group * tile;
+  const uint last = min(first + tile, len);
+  for (uint step = first; step < last; step += size) {
+    // elements past the end sort behind all others in the last bin
+    const uint i = step + thread;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    digits[thread] = i < last ? digit(keys_in[i], shift) : RADIX - 1;
+    order[thread] = thread;
+    for (uint bit = 0; bit < DIGIT_BITS; ++bit) {
+      barrier(CLK_LOCAL_MEM_FENCE);
+      const uint d = digits[thread];
+      const uint pos = order[thread];
+      const uint zero = ((d >> bit) & 1) == 0;
+      tmp[thread] = zero;
+      for (uint offset = 1; offset < size; offset <<= 1) {
+        barrier(CLK_LOCAL_MEM_FENCE);
+        const uint x = thread >= offset ? tmp[thread - offset] : 0;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        tmp[thread] += x;
+      }
+      barrier(CLK_LOCAL_MEM_FENCE);
+      const uint zeros = tmp[size - 1];
+      const uint zeros_before = tmp[thread] - zero;
+      const uint dst = zero ? zeros_before : zeros + thread - zeros_before;
+      barrier(CLK_LOCAL_MEM_FENCE);
+      digits[dst] = d;
+      order[dst] = pos;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+    const uint d = digits[thread];
+    const uint src = step + order[thread];
+    const bool valid = src < last;
+    if (thread == 0 || digits[thread - 1] != d)
+      start[d] = thread;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    if (valid) {
+      const uint dst = base[d] + thread - start[d];
+      keys_out[dst] = keys_in[src];
+#ifdef WITH_VALUES
+      values_out[dst] = values_in[src];
+#endif
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+    // the last valid element of each digit advances its offset
+    const bool followed = thread + 1 < size && digits[thread + 1] == d
+                          && step + order[thread + 1] < last;
+    if (valid && !followed)
+      base[d] += thread - start[d] + 1;
+  }
+}
+
+/// Reads back results via the argument of this empty kernel.
+kernel void radix_fetch(global K* keys) {
+  // nop
+}
+
+#ifdef WITH_VALUES
+/// Reads back results via the arguments of this empty kernel.
+kernel void radix_fetch_pairs(global K* keys, global V* values) {
+  // nop
+}
+#endif
+)__";
+
+} // namespace <anonymous>
+
+string radix_sort_source(const string& prelude, const char* key_bits,
+                         cl_uint digit_bits, bool with_values) {
+  string result = prelude;
+  if (with_values)
+    result += "#define WITH_VALUES\n";
+  result += "#define DIGIT_BITS " + to_string(digit_bits) + "u\n";
+  result += "#define RADIX (1u << DIGIT_BITS)\n";
+  result += key_bits;
+  result += radix_kernels;
+  return result;
+}
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
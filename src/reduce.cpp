@@ -0,0 +1,63 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include "caf/opencl/reduce.hpp"
+
+using namespace std;
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+namespace {
+
+constexpr const char* reduce_kernel = R"__(
+/// Combines a strided range of the input per work item, then combines the
+/// results of all work items of a group in local memory.
+kernel void reduce(global const T* restrict data,
+                   global T* restrict partials,
+                   local T* tmp, uint len) {
+  const uint thread = get_local_id(0);
+  T acc = IDENTITY;
+  for (uint i = get_global_id(0); i < len; i += get_global_size(0))
+    acc = op(acc, data[i]);
+  tmp[thread] = acc;
+  barrier(CLK_LOCAL_MEM_FENCE);
+  for (uint offset = get_local_size(0) / 2; offset > 0; offset >>= 1) {
+    if (thread < offset)
+      tmp[thread] = op(tmp[thread], tmp[thread + offset]);
+    barrier(CLK_LOCAL_MEM_FENCE);
+  }
+  if (thread == 0)
+    partials[get_group_id(0)] = tmp[0];
+}
+)__";
+
+} // namespace <anonymous>
+
+string reduce_source(const string& prelude, const binary_op& op) {
+  string result = prelude;
+  result += op_source(op);
+  result += reduce_kernel;
+  return result;
+}
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
@@ -0,0 +1,114 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include "caf/opencl/scan.hpp"
+
+using namespace std;
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+namespace {
+
+// work-efficient scan by Blelloch, see:
+// - http://http.developer.nvidia.com/GPUGems3/gpugems3_ch39.html
+constexpr const char* scan_kernels = R"__(
+/// Scans blocks of two elements per work item and stores the reduction of
+/// each block in `sums`.
+kernel void scan_blocks(global T* restrict data,
+                        global T* restrict sums,
+                        local T* tmp, uint len, uint inclusive) {
+  const uint thread = get_local_id(0);
+  const uint block = get_group_id(0);
+  const uint n = get_local_size(0) * 2;
+  const uint global_offset = block * n;
+  const uint ai = 2 * thread;
+  const uint bi = 2 * thread + 1;
+  const T x = (global_offset + ai < len) ? data[global_offset + ai] : IDENTITY;
+  const T y = (global_offset + bi < len) ? data[global_offset + bi] : IDENTITY;
+  tmp[ai] = x;
+  tmp[bi] = y;
+  // build the reduction in place up the tree
+  uint offset = 1;
+  for (uint d = n >> 1; d > 0; d >>= 1) {
+    barrier(CLK_LOCAL_MEM_FENCE);
+    if (thread < d) {
+      uint a = offset * (2 * thread + 1) - 1;
+      uint b = offset * (2 * thread + 2) - 1;
+      tmp[b] = op(tmp[a], tmp[b]);
+    }
+    offset <<= 1;
+  }
+  if (thread == 0) {
+    sums[block] = tmp[n - 1];
+    tmp[n - 1] = IDENTITY;
+  }
+  // traverse down the tree and build the exclusive scan
+  for (uint d = 1; d < n; d <<= 1) {
+    offset >>= 1;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    if (thread < d) {
+      uint a = offset * (2 * thread + 1) - 1;
+      uint b = offset * (2 * thread + 2) - 1;
+      T t = tmp[a];
+      tmp[a] = tmp[b];
+      tmp[b] = op(tmp[b], t);
+    }
+  }
+  barrier(CLK_LOCAL_MEM_FENCE);
+  if (global_offset + ai < len)
+    data[global_offset + ai] = inclusive ? op(tmp[ai], x) : tmp[ai];
+  if (global_offset + bi < len)
+    data[global_offset + bi] = inclusive ? op(tmp[bi], y) : tmp[bi];
+}
+
+/// Combines each element with the scanned sums of all previous blocks.
+kernel void scan_add(global T* restrict data,
+                     global const T* restrict increments, uint len) {
+  const uint thread = get_local_id(0);
+  const uint block = get_group_id(0);
+  const uint global_offset = block * get_local_size(0) * 2;
+  const uint ai = global_offset + 2 * thread;
+  const uint bi = global_offset + 2 * thread + 1;
+  const T increment = increments[block];
+  if (ai < len)
+    data[ai] = op(increment, data[ai]);
+  if (bi < len)
+    data[bi] = op(increment, data[bi]);
+}
+
+/// Reads back results via the argument of this empty kernel.
+kernel void scan_fetch(global T* data) {
+  // nop
+}
+)__";
+
+} // namespace <anonymous>
+
+string scan_source(const string& prelude, const binary_op& op) {
+  string result = prelude;
+  result += op_source(op);
+  result += scan_kernels;
+  return result;
+}
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
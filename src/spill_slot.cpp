@@ -0,0 +1,135 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include "caf/logger.hpp"
+
+#include "caf/opencl/opencl_err.hpp"
+
+#include "caf/opencl/detail/spill_slot.hpp"
+
+using namespace std;
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+spill_slot::spill_slot(mem_tracker_ptr tracker, raw_context_ptr context,
+                       raw_command_queue_ptr queue, raw_mem_ptr buffer,
+                       cl_mem_flags flags, size_t bytes, raw_event_ptr event,
+                       size_t pins)
+    : tracker_(move(tracker)),
+      context_(move(context)),
+      queue_(move(queue)),
+      flags_(flags),
+      bytes_(bytes),
+      pins_(pins),
+      device_(move(buffer)),
+      event_(move(event)),
+      spilled_(false),
+      in_lru_(false),
+      busy_(false) {
+  tracker_->attach(this, device_.get(), false);
+}
+
+spill_slot::~spill_slot() {
+  tracker_->forget(this);
+}
+
+raw_mem_ptr spill_slot::get() {
+  unique_lock<mutex> guard{mtx_};
+  if (spilled_)
+    restore();
+  else
+    tracker_->touch(this);
+  return device_;
+}
+
+raw_mem_ptr spill_slot::acquire() {
+  ++pins_;
+  try {
+    return get();
+  } catch (...) {
+    --pins_;
+    throw;
+  }
+}
+
+bool spill_slot::read_spilled(void* dst, size_t bytes, cl_int& err) {
+  unique_lock<mutex> guard{mtx_};
+  if (!spilled_)
+    return false;
+  err = clEnqueueReadBuffer(queue_.get(), host_.get(), CL_TRUE, 0, bytes, dst,
+                            0, nullptr, nullptr);
+  return true;
+}
+
+void spill_slot::spill() {
+  raw_mem_ptr released; // destroyed after releasing the lock
+  unique_lock<mutex> guard{mtx_};
+  if (spilled_ || pins_ > 0)
+    return;
+  cl_int err;
+  raw_mem_ptr host{clCreateBuffer(context_.get(),
+                                  CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
+                                  bytes_, nullptr, &err),
+                   false};
+  if (err != CL_SUCCESS) {
+    CAF_LOG_ERROR("unable to allocate host memory: " << opencl_error(err));
+    return;
+  }
+  // a device-side copy also works for buffers without host access
+  cl_event prev = event_.get();
+  cl_event event;
+  err = clEnqueueCopyBuffer(queue_.get(), device_.get(), host.get(), 0, 0,
+                            bytes_, prev ? 1u : 0u, prev ? &prev : nullptr,
+                            &event);
+  if (err != CL_SUCCESS) {
+    CAF_LOG_ERROR("clEnqueueCopyBuffer: " << opencl_error(err));
+    return;
+  }
+  raw_event_ptr done{event, false};
+  err = clWaitForEvents(1, &event);
+  if (err != CL_SUCCESS) {
+    CAF_LOG_ERROR("clWaitForEvents: " << opencl_error(err));
+    return;
+  }
+  tracker_->detach(this, device_.get());
+  host_ = move(host);
+  event_.reset();
+  spilled_ = true;
+  released = move(device_);
+}
+
+void spill_slot::restore() {
+  auto buffer = tracker_->allocate(context_.get(), flags_, bytes_,
+                                   mem_kind::reference);
+  auto event = v1get<cl_event>(CAF_CLF(clEnqueueCopyBuffer), queue_.get(),
+                               host_.get(), buffer.get(), size_t{0},
+                               size_t{0}, bytes_);
+  raw_event_ptr done{event, false};
+  v1callcl(CAF_CLF(clWaitForEvents), 1u, &event);
+  device_ = move(buffer);
+  host_.reset();
+  spilled_ = false;
+  tracker_->attach(this, device_.get(), true);
+}
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
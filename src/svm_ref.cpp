@@ -0,0 +1,74 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include "caf/opencl/svm_ref.hpp"
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+svm_block::svm_block(raw_context_ptr context, void* ptr, size_t bytes,
+                     bool fine_grained)
+    : context_(std::move(context)),
+      ptr_(ptr),
+      bytes_(bytes),
+      fine_grained_(fine_grained) {
+  // nop
+}
+
+svm_block::~svm_block() {
+#ifdef CL_VERSION_2_0
+  clSVMFree(context_.get(), ptr_);
+#endif
+}
+
+error svm_block::map(cl_command_queue queue, cl_map_flags flags) {
+#ifdef CL_VERSION_2_0
+  auto err = clEnqueueSVMMap(queue, CL_TRUE, flags, ptr_, bytes_, 0, nullptr,
+                             nullptr);
+  if (err != CL_SUCCESS)
+    return make_error(sec::runtime_error, opencl_error(err));
+  return none;
+#else
+  static_cast<void>(queue);
+  static_cast<void>(flags);
+  return make_error(sec::runtime_error, "SVM requires OpenCL 2.0.");
+#endif
+}
+
+error svm_block::unmap(cl_command_queue queue) {
+#ifdef CL_VERSION_2_0
+  cl_event event;
+  auto err = clEnqueueSVMUnmap(queue, ptr_, 0, nullptr, &event);
+  if (err == CL_SUCCESS) {
+    err = clWaitForEvents(1, &event);
+    clReleaseEvent(event);
+  }
+  if (err != CL_SUCCESS)
+    return make_error(sec::runtime_error, opencl_error(err));
+  return none;
+#else
+  static_cast<void>(queue);
+  return make_error(sec::runtime_error, "SVM requires OpenCL 2.0.");
+#endif
+}
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
@@ -0,0 +1,139 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include <cstring>
+
+#include "caf/opencl/detail/hash.hpp"
+#include "caf/opencl/detail/upload_cache.hpp"
+
+using namespace std;
+
+namespace caf {
+namespace opencl {
+namespace detail {
+
+upload_cache::upload_cache(size_t budget)
+    : budget_(budget),
+      size_(0),
+      hits_(0),
+      misses_(0),
+      bytes_saved_(0) {
+  // nop
+}
+
+upload_cache::~upload_cache() {
+  // nop
+}
+
+bool upload_cache::admits(size_t bytes) const {
+  unique_lock<mutex> guard{mtx_};
+  return bytes > 0 && bytes <= budget_;
+}
+
+raw_mem_ptr upload_cache::lookup(size_t type, const void* data, size_t bytes,
+                                 raw_event_ptr& event) {
+  auto key = make_key(type, data, bytes);
+  unique_lock<mutex> guard{mtx_};
+  auto i = find(key, type, data, bytes);
+  if (i == lru_.end()) {
+    ++misses_;
+    return nullptr;
+  }
+  ++hits_;
+  bytes_saved_ += bytes;
+  lru_.splice(lru_.begin(), lru_, i);
+  event = i->event;
+  return i->buffer;
+}
+
+void upload_cache::insert(size_t type, const void* data, size_t bytes,
+                          raw_mem_ptr buffer, raw_event_ptr event) {
+  auto key = make_key(type, data, bytes);
+  // releases evicted buffers after leaving the critical section
+  vector<raw_mem_ptr> evicted;
+  unique_lock<mutex> guard{mtx_};
+  // a concurrent miss may have added the same content already
+  if (bytes > budget_ || find(key, type, data, bytes) != lru_.end())
+    return;
+  shrink(budget_ - bytes, evicted);
+  auto first = static_cast<const char*>(data);
+  lru_.push_front(entry{key, type, vector<char>(first, first + bytes),
+                        move(buffer), move(event)});
+  index_.emplace(key, lru_.begin());
+  size_ += bytes;
+}
+
+void upload_cache::budget(size_t bytes) {
+  vector<raw_mem_ptr> evicted;
+  unique_lock<mutex> guard{mtx_};
+  budget_ = bytes;
+  shrink(bytes, evicted);
+}
+
+void upload_cache::clear() {
+  entry_list entries;
+  unique_lock<mutex> guard{mtx_};
+  entries.swap(lru_);
+  index_.clear();
+  size_ = 0;
+}
+
+void upload_cache::stats(memory_usage& usage) const {
+  unique_lock<mutex> guard{mtx_};
+  usage.upload_hits = hits_;
+  usage.upload_misses = misses_;
+  usage.upload_bytes_saved = bytes_saved_;
+}
+
+uint64_t upload_cache::make_key(size_t type, const void* data, size_t bytes) {
+  return hash(data, bytes) ^ hash_mix(static_cast<uint64_t>(type)
+                                      * 0xbf58476d1ce4e5b9ull);
+}
+
+upload_cache::entry_list::iterator
+upload_cache::find(uint64_t key, size_t type, const void* data, size_t bytes) {
+  auto range = index_.equal_range(key);
+  for (auto i = range.first; i != range.second; ++i) {
+    auto& x = *i->second;
+    if (x.type == type && x.content.size() == bytes
+        && memcmp(x.content.data(), data, bytes) == 0)
+      return i->second;
+  }
+  return lru_.end();
+}
+
+void upload_cache::shrink(size_t bytes, vector<raw_mem_ptr>& out) {
+  while (size_ > bytes && !lru_.empty()) {
+    auto& x = lru_.back();
+    auto range = index_.equal_range(x.key);
+    for (auto i = range.first; i != range.second; ++i) {
+      if (&*i->second == &x) {
+        index_.erase(i);
+        break;
+      }
+    }
+    size_ -= x.content.size();
+    out.push_back(move(x.buffer));
+    lru_.pop_back();
+  }
+}
+
+} // namespace detail
+} // namespace opencl
+} // namespace caf
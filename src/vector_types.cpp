@@ -0,0 +1,38 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2016                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include "caf/opencl/vector_types.hpp"
+
+#include <vector>
+
+namespace caf {
+namespace opencl {
+
+void add_vector_types(actor_system_config& cfg) {
+  cfg.add_message_type<half>("half");
+  cfg.add_message_type<std::vector<half>>("half_vector");
+# define CAF_OPENCL_ADD_VECTOR_TYPE(type, n)                                   \
+  cfg.add_message_type<cl_##type##n>("cl_" #type #n);                          \
+  cfg.add_message_type<std::vector<cl_##type##n>>("cl_" #type #n "_vector");
+  CAF_OPENCL_FOR_EACH_VECTOR_TYPE(CAF_OPENCL_ADD_VECTOR_TYPE)
+# undef CAF_OPENCL_ADD_VECTOR_TYPE
+}
+
+} // namespace opencl
+} // namespace caf
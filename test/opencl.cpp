@@ -1,9 +1,14 @@
 #define CAF_SUITE opencl
 #include "caf/test/unit_test.hpp"
 
+#include <thread>
 #include <vector>
+#include <cstdio>
+#include <fstream>
 #include <iomanip>
+#include <iterator>
 #include <cassert>
+#include <numeric>
 #include <iostream>
 #include <algorithm>
 
@@ -41,6 +46,15 @@ constexpr const char* kn_local = "use_local";
 constexpr const char* kn_order = "test_order";
 constexpr const char* kn_private = "use_private";
 constexpr const char* kn_varying = "varying";
+constexpr const char* kn_vector = "scale_vectors";
+constexpr const char* kn_half = "store_half";
+constexpr const char* kn_soa_sum = "soa_sum";
+constexpr const char* kn_soa_swap = "soa_swap";
+constexpr const char* kn_image_offset = "image_offset";
+constexpr const char* kn_image_unorm = "image_unorm";
+constexpr const char* kn_resident = "add_resident";
+constexpr const char* kn_scale_by = "scale_by";
+constexpr const char* kn_bounded = "bounded_increment";
 
 constexpr const char* compiler_flag = "-D CAF_OPENCL_TEST_FLAG";
 
@@ -159,6 +173,54 @@ constexpr const char* kernel_source = R"__(
     out1[idx] = in1[idx];
     out2[idx] = in2[idx];
   }
+
+  kernel void scale_vectors(global  float4* restrict buf,
+                            private float4  factor) {
+    buf[get_global_id(0)] *= factor;
+  }
+
+  kernel void store_half(global const float* restrict input,
+                         global       half*  restrict output) {
+    size_t idx = get_global_id(0);
+    vstore_half(input[idx], idx, output);
+  }
+
+  kernel void soa_sum(global const float* restrict x,
+                      global const float* restrict y,
+                      global       float* restrict mass) {
+    size_t idx = get_global_id(0);
+    mass[idx] = x[idx] + y[idx];
+  }
+
+  kernel void soa_swap(global  float* restrict x,
+                       global  float* restrict y,
+                       private float  offset) {
+    size_t idx = get_global_id(0);
+    float tmp = x[idx];
+    x[idx] = y[idx] + offset;
+    y[idx] = tmp;
+  }
+
+  kernel void image_offset(read_only  image2d_t input,
+                           write_only image2d_t output,
+                           private    float     offset) {
+    int2 pos = (int2)(get_global_id(0), get_global_id(1));
+    write_imagef(output, pos, read_imagef(input, pos) + offset);
+  }
+
+  kernel void image_unorm(read_only image3d_t input,
+                          global    float*    restrict output) {
+    int4 pos = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
+    size_t idx = (get_global_id(2) * get_global_size(1) + get_global_id(1))
+                 * get_global_size(0) + get_global_id(0);
+    output[idx] = read_imagef(input, pos).x;
+  }
+
+  kernel void add_resident(global const int* restrict table,
+                           global       int* restrict values) {
+    size_t idx = get_global_id(0);
+    values[idx] += table[idx];
+  }
 )__";
 
 constexpr const char* kernel_source_error = R"__(
@@ -179,6 +241,24 @@ constexpr const char* kernel_source_compiler_flag = R"__(
   }
 )__";
 
+constexpr const char* kernel_source_variants = R"__(
+  kernel void scale_by(global const int* restrict input,
+                       global       int* restrict output) {
+    size_t x = get_global_id(0);
+    output[x] = input[x] * FACTOR;
+  }
+)__";
+
+constexpr const char* kernel_source_bounded = R"__(
+  kernel void bounded_increment(global const int* restrict input,
+                                global       int* restrict output,
+                                private uint n) {
+    size_t x = get_global_id(0);
+    if (x < n)
+      output[x] = input[x] + 1;
+  }
+)__";
+
 } // namespace <anonymous>
 
 template<size_t Size>
@@ -270,6 +350,18 @@ bool operator!=(const square_matrix<Size>& lhs,
 
 using matrix_type = square_matrix<matrix_size>;
 
+struct particle {
+  float x;
+  float y;
+  int id;
+  float mass;
+};
+
+template <class Inspector>
+typename Inspector::result_type inspect(Inspector& f, particle& x) {
+  return f(meta::type_name("particle"), x.x, x.y, x.id, x.mass);
+}
+
 template <class T>
 void check_vector_results(const string& description,
                           const vector<T>& expected,
@@ -1098,11 +1190,1152 @@ void test_local(actor_system& sys) {
   }, others >> wrong_msg);
 }
 
+void test_host_pool(actor_system& sys) {
+  CAF_MESSAGE("Testing host vector pool");
+  // setup
+  auto& mngr = sys.opencl_manager();
+  mngr.enable_host_pool(4);
+  auto pool = mngr.host_vector_pool();
+  CAF_REQUIRE(pool);
+  auto opt = mngr.find_device(0);
+  CAF_REQUIRE(opt);
+  auto dev = *opt;
+  auto prog = mngr.create_program(kernel_source, "", dev);
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  // tests
+  ivec input = make_iota_vector<int>(problem_size);
+  ivec res{input};
+  for_each(begin(res), end(res), [](int& val){ val *= 2; });
+  auto range = nd_range{dims{problem_size}};
+  auto w1 = mngr.spawn(prog, kn_inout, range, in_out<int,val,val>{});
+  for (int i = 0; i < 3; ++i) {
+    self->send(w1, input);
+    self->receive([&](const ivec& result) {
+      check_vector_results("Testing in-place in_out (val -> val)", res, result);
+    }, others >> wrong_msg);
+  }
+  auto w2 = mngr.spawn(prog, kn_varying, range,
+                       in<int>{}, out<int>{}, in<int>{}, out<int>{});
+  for (int i = 0; i < 3; ++i) {
+    self->send(w2, input, input);
+    self->receive([&](const ivec& res1, const ivec& res2) {
+      check_vector_results("Pooled results, output 1", input, res1);
+      check_vector_results("Pooled results, output 2", input, res2);
+    }, others >> wrong_msg);
+  }
+  CAF_CHECK(pool->hits() + pool->misses() > 0);
+}
+
+void test_memory_usage(actor_system& sys) {
+  CAF_MESSAGE("Testing device memory accounting");
+  auto& mngr = sys.opencl_manager();
+  auto opt = mngr.find_device(0);
+  CAF_REQUIRE(opt);
+  auto dev = *opt;
+  auto before = dev->mem_usage();
+  CAF_CHECK(before.budget > 0);
+  ivec input = make_iota_vector<int>(problem_size);
+  auto ref = dev->global_argument(input);
+  auto during = dev->mem_usage();
+  CAF_CHECK(during.reference >= before.reference + sizeof(int) * problem_size);
+  CAF_CHECK(during.total() <= during.budget);
+  dev->release_idle_buffers();
+  CAF_CHECK_EQUAL(dev->mem_usage().pooled, 0u);
+}
+
+void test_spilling(actor_system& sys) {
+  CAF_MESSAGE("Testing spilling of mem_refs to host memory");
+  auto& mngr = sys.opencl_manager();
+  auto opt = mngr.find_device(0);
+  CAF_REQUIRE(opt);
+  auto dev = *opt;
+  auto prog = mngr.create_program(kernel_source, "", dev);
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  auto before = dev->mem_usage();
+  auto bytes = sizeof(int) * problem_size;
+  dev->memory_budget(before.total() + bytes + bytes / 2);
+  dev->spilling(true);
+  ivec input = make_iota_vector<int>(problem_size);
+  ivec res{input};
+  for_each(begin(res), end(res), [](int& val){ val *= 2; });
+  auto ref1 = dev->global_argument(input);
+  auto ref2 = dev->global_argument(input); // spills ref1
+  auto usage = dev->mem_usage();
+  CAF_CHECK_EQUAL(usage.spills, before.spills + 1);
+  CAF_CHECK_EQUAL(usage.spilled, bytes);
+  auto spilled = ref1.data();
+  CAF_REQUIRE(spilled);
+  check_vector_results("Reading a spilled mem_ref", input, *spilled);
+  // binding ref1 restores it and spills ref2
+  auto w = mngr.spawn(prog, kn_inout, nd_range{dims{problem_size}},
+                      in_out<int,mref,val>{});
+  self->send(w, ref1);
+  self->receive([&](const ivec& result) {
+    check_vector_results("Restoring a spilled mem_ref", res, result);
+  }, others >> wrong_msg);
+  usage = dev->mem_usage();
+  CAF_CHECK_EQUAL(usage.restores, before.restores + 1);
+  CAF_CHECK_EQUAL(usage.bytes_restored, before.bytes_restored + bytes);
+  auto restored = ref2.data();
+  CAF_REQUIRE(restored);
+  check_vector_results("Reading the second spilled mem_ref", input, *restored);
+  dev->spilling(false);
+  dev->memory_budget(before.budget);
+}
+
+void test_scan(actor_system& sys) {
+  CAF_MESSAGE("Testing scan primitive");
+  auto& mngr = sys.opencl_manager();
+  auto opt = mngr.find_device(0);
+  CAF_REQUIRE(opt);
+  auto dev = *opt;
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  // spans three levels of block sums for groups of up to 256 work items
+  ivec input(300000);
+  for (size_t i = 0; i < input.size(); ++i)
+    input[i] = static_cast<int>(i % 7) - 3;
+  ivec exclusive(input.size());
+  partial_sum(begin(input), end(input) - 1, begin(exclusive) + 1);
+  auto w1 = spawn_scan(sys, dev, in_out<int,val,val>{});
+  self->send(w1, input);
+  self->receive([&](const ivec& result) {
+    check_vector_results("Exclusive scan (val -> val)", exclusive, result);
+  }, others >> wrong_msg);
+  ivec xs(input.size());
+  for (size_t i = 0; i < xs.size(); ++i)
+    xs[i] = static_cast<int>((i * 7919) % 100003);
+  ivec maxima(xs.size());
+  partial_sum(begin(xs), end(xs), begin(maxima),
+              [](int x, int y) { return std::max(x, y); });
+  auto w2 = spawn_scan(sys, dev, in_out<int,mref,mref>{}, scan_mode::inclusive,
+                       binary_op::maximum<int>());
+  self->send(w2, dev->global_argument(xs));
+  self->receive([&](iref& result) {
+    check_mref_results("Inclusive max scan (mref -> mref)", maxima, result);
+  }, others >> wrong_msg);
+  auto w3 = spawn_scan(sys, dev, in_out<int,val,val>{});
+  self->send(w3, ivec{});
+  self->receive([&](const ivec& result) {
+    CAF_CHECK(result.empty());
+  }, others >> wrong_msg);
+}
+
+void test_reduce(actor_system& sys) {
+  CAF_MESSAGE("Testing reduction");
+  auto& mngr = sys.opencl_manager();
+  auto opt = mngr.find_device(0);
+  CAF_REQUIRE(opt);
+  auto dev = *opt;
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  ivec input(100000);
+  for (size_t i = 0; i < input.size(); ++i)
+    input[i] = static_cast<int>((i * 7919) % 1009) - 500;
+  auto w1 = spawn_reduce(sys, dev, in<int>{}, out<int>{});
+  self->send(w1, input);
+  self->receive([&](int result) {
+    CAF_CHECK_EQUAL(result, accumulate(begin(input), end(input), 0));
+  }, others >> wrong_msg);
+  auto w2 = spawn_reduce(sys, dev, in<int,mref>{}, out<int,mref>{},
+                         binary_op::maximum<int>());
+  self->send(w2, dev->global_argument(input));
+  self->receive([&](iref& result) {
+    check_mref_results("Max reduction (mref -> mref)",
+                       ivec{*max_element(begin(input), end(input))}, result);
+  }, others >> wrong_msg);
+  self->send(w1, ivec{});
+  self->receive([&](int result) {
+    CAF_CHECK_EQUAL(result, 0);
+  }, others >> wrong_msg);
+}
+
+void test_radix_sort(actor_system& sys) {
+  CAF_MESSAGE("Testing radix sort");
+  auto& mngr = sys.opencl_manager();
+  auto opt = mngr.find_device(0);
+  CAF_REQUIRE(opt);
+  auto dev = *opt;
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  // spans several tiles per group with a partial last step
+  ivec input(70001);
+  for (size_t i = 0; i < input.size(); ++i)
+    input[i] = static_cast<int>((i * 2654435761u) % 200003) - 100000;
+  auto sorted = input;
+  sort(begin(sorted), end(sorted));
+  auto w1 = spawn_radix_sort(sys, dev, in_out<int,val,val>{});
+  self->send(w1, input);
+  self->receive([&](const ivec& result) {
+    check_vector_results("Radix sort (val -> val)", sorted, result);
+  }, others >> wrong_msg);
+  // few distinct keys show whether equal keys keep their order
+  vector<float> keys(input.size());
+  ivec values(input.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys[i] = static_cast<float>(input[i] % 50) / 4.f;
+    values[i] = static_cast<int>(i);
+  }
+  auto order = values;
+  stable_sort(begin(order), end(order), [&](int x, int y) {
+    return keys[static_cast<size_t>(x)] < keys[static_cast<size_t>(y)];
+  });
+  radix_sort_options opts;
+  opts.digit_bits = 8;
+  opts.group_size = 64;
+  auto w2 = spawn_radix_sort(sys, dev, in_out<float,mref,mref>{},
+                             in_out<int,mref,mref>{}, opts);
+  self->send(w2, dev->global_argument(keys), dev->global_argument(values));
+  self->receive([&](mem_ref<float>& sorted_keys, iref& sorted_values) {
+    auto ks = sorted_keys.data();
+    CAF_REQUIRE(ks);
+    CAF_CHECK(is_sorted(begin(*ks), end(*ks)));
+    check_mref_results("Key-value radix sort (mref -> mref)", order,
+                       sorted_values);
+  }, others >> wrong_msg);
+  self->send(w1, ivec{});
+  self->receive([&](const ivec& result) {
+    CAF_CHECK(result.empty());
+  }, others >> wrong_msg);
+}
+
+void test_histogram(actor_system& sys) {
+  CAF_MESSAGE("Testing histogram");
+  auto& mngr = sys.opencl_manager();
+  auto opt = mngr.find_device(0);
+  CAF_REQUIRE(opt);
+  auto dev = *opt;
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  constexpr size_t bins = 16;
+  // values of 16 and above fall outside of all bins
+  ivec input(100000);
+  for (size_t i = 0; i < input.size(); ++i)
+    input[i] = static_cast<int>((i * 7919) % 20);
+  vector<cl_uint> counts(bins);
+  for (auto x : input)
+    if (x < static_cast<int>(bins))
+      ++counts[static_cast<size_t>(x)];
+  // bucket offsets via the scan primitive
+  vector<cl_uint> offsets(bins);
+  partial_sum(begin(counts), end(counts) - 1, begin(offsets) + 1);
+  auto w1 = spawn_histogram(sys, dev, in<int,mref>{}, out<cl_uint,mref>{},
+                            bins);
+  auto w2 = spawn_scan(sys, dev, in_out<cl_uint,mref,mref>{});
+  self->send(w2 * w1, dev->global_argument(input));
+  self->receive([&](mem_ref<cl_uint>& result) {
+    check_mref_results("Bucket offsets (mref -> mref)", offsets, result);
+  }, others >> wrong_msg);
+  vector<float> xs(input.size());
+  for (size_t i = 0; i < xs.size(); ++i)
+    xs[i] = static_cast<float>(input[i]) / 10.f - 0.5f;
+  auto w3 = spawn_histogram(sys, dev, in<float>{}, out<cl_uint>{}, 4,
+                            bin_index::uniform(0., 1.));
+  self->send(w3, xs);
+  self->receive([&](const vector<cl_uint>& result) {
+    vector<cl_uint> expected(4);
+    for (auto x : xs)
+      if (x >= 0.f && x < 1.f)
+        ++expected[min(static_cast<size_t>(x * 4.f), size_t{3})];
+    check_vector_results("Uniform bins (val -> val)", expected, result);
+  }, others >> wrong_msg);
+}
+
+void test_gemm(actor_system& sys) {
+  CAF_MESSAGE("Testing matrix multiplication");
+  auto& mngr = sys.opencl_manager();
+  auto opt = mngr.find_device(0);
+  CAF_REQUIRE(opt);
+  auto dev = *opt;
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  // no dimension is a multiple of any tile size, B is column-major
+  size_t m = 37;
+  size_t n = 53;
+  size_t k = 29;
+  vector<float> a(m * k);
+  vector<float> b(k * n);
+  for (size_t i = 0; i < a.size(); ++i)
+    a[i] = static_cast<float>(i % 5) - 2.f;
+  for (size_t i = 0; i < b.size(); ++i)
+    b[i] = static_cast<float>(i % 3);
+  vector<float> c(m * n);
+  for (size_t row = 0; row < m; ++row)
+    for (size_t column = 0; column < n; ++column)
+      for (size_t x = 0; x < k; ++x)
+        c[row * n + column] += a[row * k + x] * b[column * k + x];
+  gemm_shape shape{m, n, k, matrix_order::row_major,
+                   matrix_order::column_major};
+  auto w1 = spawn_gemm(sys, dev, shape, in<float>{}, out<float>{},
+                       gemm_tiling{32, 32, 16, 4, 4});
+  self->send(w1, a, b);
+  self->receive([&](const vector<float>& result) {
+    check_vector_results("Tiled gemm (val -> val)", c, result);
+  }, others >> wrong_msg);
+  // operands of another shape get an error instead of no response
+  self->request(w1, infinite, b, a).receive(
+    [&](const vector<float>&) {
+      CAF_ERROR("multiplied operands of the wrong shape");
+    },
+    [&](const error& err) {
+      CAF_CHECK_EQUAL(err.code(), static_cast<uint8_t>(sec::invalid_argument));
+    }
+  );
+  auto w2 = spawn_gemm(sys, dev, shape, in<float,mref>{}, out<float,mref>{});
+  self->send(w2, dev->global_argument(a), dev->global_argument(b));
+  self->receive([&](mem_ref<float>& result) {
+    check_mref_results("Autotuned gemm (mref -> mref)", c, result);
+  }, others >> wrong_msg);
+}
+
+void test_compact(actor_system& sys) {
+  CAF_MESSAGE("Testing stream compaction");
+  auto& mngr = sys.opencl_manager();
+  auto opt = mngr.find_device(0);
+  CAF_REQUIRE(opt);
+  auto dev = *opt;
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  ivec input(100000);
+  for (size_t i = 0; i < input.size(); ++i)
+    input[i] = static_cast<int>((i * 7919) % 1009) - 500;
+  ivec expected;
+  copy_if(begin(input), end(input), back_inserter(expected),
+          [](int x) { return x % 3 == 0; });
+  auto w1 = spawn_compact(sys, dev, in<int>{}, out<int>{}, "x % 3 == 0");
+  self->send(w1, input);
+  self->receive([&](const ivec& result) {
+    check_vector_results("Compaction (val -> val)", expected, result);
+  }, others >> wrong_msg);
+  auto w2 = spawn_compact(sys, dev, in<int,mref>{}, out<int,mref>{},
+                          "x % 3 == 0");
+  self->send(w2, dev->global_argument(input));
+  self->receive([&](iref& result) {
+    CAF_CHECK_EQUAL(result.size(), expected.size());
+    check_mref_results("Compaction (mref -> mref)", expected, result);
+  }, others >> wrong_msg);
+  auto w3 = spawn_compact(sys, dev, in<int>{}, out<int>{}, "x > 1000");
+  self->send(w3, input);
+  self->receive([&](const ivec& result) {
+    CAF_CHECK(result.empty());
+  }, others >> wrong_msg);
+}
+
+void test_vector_types(actor_system& sys) {
+  CAF_MESSAGE("Testing vector types and half precision");
+  auto& mngr = sys.opencl_manager();
+  auto opt = mngr.find_device(0);
+  CAF_REQUIRE(opt);
+  auto dev = *opt;
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  // host conversions
+  CAF_CHECK_EQUAL(half{1.0f}.bits, 0x3C00u);
+  CAF_CHECK_EQUAL(half{-2.0f}.bits, 0xC000u);
+  CAF_CHECK_EQUAL(half{65504.0f}.bits, 0x7BFFu);
+  CAF_CHECK_EQUAL(half{65520.0f}.bits, 0x7C00u);
+  CAF_CHECK_EQUAL(half{1e-8f}.bits, 0u);
+  CAF_CHECK_EQUAL(static_cast<float>(half::from_bits(0x0001)), 5.9604645e-8f);
+  vector<float> floats(problem_size);
+  for (size_t i = 0; i < floats.size(); ++i)
+    floats[i] = static_cast<float>(i) * 0.25f - 100.0f;
+  CAF_CHECK(to_float(to_half(floats)) == floats);
+  // float4 buffers with a float4 argument
+  using f4vec = vector<cl_float4>;
+  f4vec input(problem_size);
+  for (size_t i = 0; i < input.size(); ++i)
+    for (size_t j = 0; j < 4; ++j)
+      input[i].s[j] = static_cast<float>(i * 4 + j);
+  cl_float4 factor;
+  for (size_t j = 0; j < 4; ++j)
+    factor.s[j] = static_cast<float>(j + 1);
+  auto w1 = mngr.spawn(kernel_source, kn_vector, nd_range{dims{problem_size}},
+                       in_out<cl_float4>{}, priv<cl_float4, val>{});
+  self->send(w1, input, factor);
+  self->receive([&](const f4vec& result) {
+    CAF_REQUIRE_EQUAL(result.size(), input.size());
+    auto same = true;
+    for (size_t i = 0; i < input.size(); ++i)
+      for (size_t j = 0; j < 4; ++j)
+        same = same && result[i].s[j] == input[i].s[j] * factor.s[j];
+    CAF_CHECK(same);
+  }, others >> wrong_msg);
+  // half buffers
+  auto w2 = mngr.spawn(kernel_source, kn_half, nd_range{dims{problem_size}},
+                       in<float>{}, out<half>{});
+  self->send(w2, floats);
+  self->receive([&](const vector<half>& result) {
+    CAF_CHECK(result == to_half(floats));
+  }, others >> wrong_msg);
+}
+
+void test_soa(actor_system& sys) {
+  CAF_MESSAGE("Testing structure of arrays arguments");
+  auto& mngr = sys.opencl_manager();
+  auto opt = mngr.find_device(0);
+  CAF_REQUIRE(opt);
+  auto dev = *opt;
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  vector<particle> input(problem_size);
+  for (size_t i = 0; i < input.size(); ++i) {
+    auto f = static_cast<float>(i);
+    input[i] = particle{f, 2 * f, static_cast<int>(i), -1.0f};
+  }
+  nd_range range{dims{problem_size}};
+  auto w1 = mngr.spawn(kernel_source, kn_soa_sum, range,
+                       soa_in<particle>{&particle::x, &particle::y},
+                       soa_out<particle>{&particle::mass});
+  self->send(w1, input);
+  self->receive([&](const vector<particle>& result) {
+    CAF_REQUIRE_EQUAL(result.size(), input.size());
+    auto same = true;
+    for (size_t i = 0; i < input.size(); ++i)
+      same = same && result[i].mass == input[i].x + input[i].y
+             && result[i].x == 0.0f && result[i].id == 0;
+    CAF_CHECK(same);
+  }, others >> wrong_msg);
+  // the private argument follows both buffers of the in_out argument
+  auto w2 = mngr.spawn(kernel_source, kn_soa_swap, range,
+                       soa_in_out<particle>{&particle::x, &particle::y},
+                       priv<float>{0.5f});
+  self->send(w2, input);
+  self->receive([&](const vector<particle>& result) {
+    CAF_REQUIRE_EQUAL(result.size(), input.size());
+    auto same = true;
+    for (size_t i = 0; i < input.size(); ++i)
+      same = same && result[i].x == input[i].y + 0.5f
+             && result[i].y == input[i].x && result[i].id == input[i].id
+             && result[i].mass == input[i].mass;
+    CAF_CHECK(same);
+  }, others >> wrong_msg);
+}
+
+void test_images(actor_system& sys) {
+  CAF_MESSAGE("Testing image arguments");
+  auto& mngr = sys.opencl_manager();
+  auto opt = mngr.find_device(0);
+  CAF_REQUIRE(opt);
+  auto dev = *opt;
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  using fimage = image2d<float>;
+  auto fmt = make_image_format<cl_float4>();
+  CAF_CHECK_EQUAL(fmt.image_channel_order, static_cast<cl_uint>(CL_RGBA));
+  CAF_CHECK_EQUAL(fmt.image_channel_data_type, static_cast<cl_uint>(CL_FLOAT));
+  auto mismatch = false;
+  try {
+    image_in<fimage>{make_image_format(CL_RGBA, CL_FLOAT)};
+  } catch (std::runtime_error&) {
+    mismatch = true;
+  }
+  CAF_CHECK(mismatch);
+  // rows are padded to 40 elements, the index space follows the input image
+  size_t width = 37;
+  size_t height = 11;
+  size_t pitch = 40;
+  vector<float> pixels(pitch * height, -1.0f);
+  for (size_t y = 0; y < height; ++y)
+    for (size_t x = 0; x < width; ++x)
+      pixels[y * pitch + x] = static_cast<float>(y * width + x);
+  auto input = make_image2d(width, height, pixels, pitch);
+  auto offset_by = [&](const fimage& result, float offset) {
+    CAF_REQUIRE_EQUAL(result.width(), width);
+    CAF_REQUIRE_EQUAL(result.height(), height);
+    auto same = true;
+    for (size_t y = 0; y < height; ++y)
+      for (size_t x = 0; x < width; ++x)
+        same = same && result(x, y) == input(x, y) + offset;
+    CAF_CHECK(same);
+  };
+  auto w1 = mngr.spawn(kernel_source, kn_image_offset, nd_range{},
+                       image_in<fimage>{}, image_out<fimage>{},
+                       priv<float>{0.5f});
+  self->send(w1, input);
+  self->receive([&](const fimage& result) {
+    offset_by(result, 0.5f);
+  }, others >> wrong_msg);
+  // images stay on the device between actors
+  auto w2 = mngr.spawn(kernel_source, kn_image_offset, nd_range{},
+                       image_in<fimage>{}, image_out<fimage, mref>{},
+                       priv<float>{1.0f});
+  auto w3 = mngr.spawn(kernel_source, kn_image_offset, nd_range{},
+                       image_in<fimage, mref>{}, image_out<fimage>{},
+                       priv<float>{1.0f});
+  self->send(w2, input);
+  image_ref<fimage> ref;
+  self->receive([&](image_ref<fimage>& result) {
+    ref = result;
+  }, others >> wrong_msg);
+  CAF_CHECK_EQUAL(ref.width(), width);
+  self->send(w3, ref);
+  self->receive([&](const fimage& result) {
+    offset_by(result, 2.0f);
+  }, others >> wrong_msg);
+  auto first = ref.data();
+  CAF_REQUIRE(first);
+  offset_by(*first, 1.0f);
+  // offsets must match the dimensions of the image
+  auto w5 = mngr.spawn(kernel_source, kn_image_offset,
+                       nd_range{dims{}, dims{0, 0, 0}},
+                       image_in<fimage>{}, image_out<fimage>{},
+                       priv<float>{0.5f});
+  self->request(w5, infinite, input).receive(
+    [&](const fimage&) {
+      CAF_ERROR("launched a 2D image with 3D offsets");
+    },
+    [&](const error& err) {
+      CAF_CHECK_EQUAL(err.code(), static_cast<uint8_t>(sec::invalid_argument));
+    }
+  );
+  // normalized channels of a 3D image, read into a buffer
+  using uimage = image3d<cl_uchar4>;
+  uimage volume{4, 3, 2};
+  for (size_t z = 0; z < volume.depth(); ++z)
+    for (size_t y = 0; y < volume.height(); ++y)
+      for (size_t x = 0; x < volume.width(); ++x)
+        volume(x, y, z).s[0] = static_cast<cl_uchar>((z * 3 + y) * 4 + x);
+  auto w4 = mngr.spawn(kernel_source, kn_image_unorm, nd_range{},
+                       image_in<uimage>{make_image_format(CL_RGBA,
+                                                          CL_UNORM_INT8)},
+                       out<float>{});
+  self->send(w4, volume);
+  self->receive([&](const vector<float>& result) {
+    CAF_REQUIRE_EQUAL(result.size(), volume.data().size());
+    auto same = true;
+    for (size_t i = 0; i < result.size(); ++i)
+      same = same && static_cast<size_t>(result[i] * 255.0f + 0.5f) == i;
+    CAF_CHECK(same);
+  }, others >> wrong_msg);
+}
+
+void test_resident(actor_system& sys) {
+  CAF_MESSAGE("Testing resident arguments");
+  auto& mngr = sys.opencl_manager();
+  auto opt = mngr.find_device(0);
+  CAF_REQUIRE(opt);
+  auto dev = *opt;
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  ivec input(problem_size);
+  ivec table(problem_size);
+  for (size_t i = 0; i < problem_size; ++i) {
+    input[i] = static_cast<int>(i);
+    table[i] = static_cast<int>(i) * 2;
+  }
+  auto added = [&](const ivec& result, int factor) {
+    CAF_REQUIRE_EQUAL(result.size(), input.size());
+    auto same = true;
+    for (size_t i = 0; i < input.size(); ++i)
+      same = same && result[i] == input[i] + table[i] * factor;
+    CAF_CHECK(same);
+  };
+  nd_range range{dims{problem_size}};
+  // the message only carries the in_out argument
+  auto w1 = mngr.spawn(kernel_source, kn_resident, range,
+                       resident<int>{table}, in_out<int>{});
+  for (int i = 0; i < 2; ++i) {
+    self->send(w1, input);
+    self->receive([&](const ivec& result) {
+      added(result, 1);
+    }, others >> wrong_msg);
+  }
+  // replaces the table, the next kernel waits for the upload
+  ivec doubled(table.size());
+  for (size_t i = 0; i < table.size(); ++i)
+    doubled[i] = table[i] * 2;
+  self->request(w1, infinite, resident_atom::value, size_t{0}, doubled).receive(
+    [&](ok_atom) {
+      // nop
+    },
+    [&](error&) {
+      CAF_ERROR("updating a resident argument failed");
+    }
+  );
+  self->send(w1, input);
+  self->receive([&](const ivec& result) {
+    added(result, 2);
+  }, others >> wrong_msg);
+  // resident arguments only exist at the position given at spawn time
+  self->request(w1, infinite, resident_atom::value, size_t{1}, doubled).receive(
+    [&](ok_atom) {
+      CAF_ERROR("updated a resident argument that does not exist");
+    },
+    [&](error&) {
+      // nop
+    }
+  );
+  // resident mem_refs stay on the device
+  auto w2 = mngr.spawn(kernel_source, kn_resident, range,
+                       resident<int>{dev->global_argument(table)},
+                       in_out<int>{});
+  self->send(w2, input);
+  self->receive([&](const ivec& result) {
+    added(result, 1);
+  }, others >> wrong_msg);
+}
+
+void test_upload_cache(actor_system& sys) {
+  CAF_MESSAGE("Testing the upload cache for repeated inputs");
+  auto& mngr = sys.opencl_manager();
+  auto opt = mngr.find_device(0);
+  CAF_REQUIRE(opt);
+  auto dev = *opt;
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  const ivec expected{ 56,  62,  68,  74, 152, 174, 196, 218,
+                      248, 286, 324, 362, 344, 398, 452, 506};
+  auto input = make_iota_vector<int>(matrix_size * matrix_size);
+  auto bytes = sizeof(int) * input.size();
+  dev->upload_cache_budget(bytes);
+  auto before = dev->mem_usage();
+  auto conf = opencl::nd_range{dims{matrix_size, matrix_size}};
+  auto w = mngr.spawn(kernel_source, kn_matrix, conf, in<int>{}, out<int>{});
+  for (int i = 0; i < 3; ++i) {
+    self->send(w, input);
+    self->receive([&](const ivec& result) {
+      check_vector_results("Matrix multiplication with cached input",
+                           expected, result);
+    }, others >> wrong_msg);
+  }
+  auto usage = dev->mem_usage();
+  CAF_CHECK_EQUAL(usage.upload_misses, before.upload_misses + 1);
+  CAF_CHECK_EQUAL(usage.upload_hits, before.upload_hits + 2);
+  CAF_CHECK_EQUAL(usage.upload_bytes_saved,
+                  before.upload_bytes_saved + 2 * bytes);
+  CAF_CHECK_EQUAL(usage.cached, bytes);
+  CAF_CHECK(usage.upload_hit_rate() > 0.);
+  // different content replaces the cached buffer, which fills the budget
+  auto other = input;
+  other[0] = 1;
+  auto send_other = [&] {
+    self->send(w, other);
+    self->receive([&](const ivec&) {
+      // nop
+    }, others >> wrong_msg);
+  };
+  send_other();
+  CAF_CHECK_EQUAL(dev->mem_usage().upload_misses, before.upload_misses + 2);
+  send_other();
+  CAF_CHECK_EQUAL(dev->mem_usage().upload_hits, before.upload_hits + 3);
+  // a budget of 0 disables the cache
+  dev->upload_cache_budget(0);
+  send_other();
+  usage = dev->mem_usage();
+  CAF_CHECK_EQUAL(usage.upload_hits, before.upload_hits + 3);
+  CAF_CHECK_EQUAL(usage.upload_misses, before.upload_misses + 2);
+}
+
+void test_constant(actor_system& sys) {
+  CAF_MESSAGE("Testing constant memory arguments");
+  auto& mngr = sys.opencl_manager();
+  auto opt = mngr.find_device(0);
+  CAF_REQUIRE(opt);
+  auto dev = *opt;
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  auto expect = [&](const actor& w, ivec table, int value) {
+    self->send(w, std::move(table));
+    self->receive([&](const ivec& result) {
+      check_vector_results("Reading a constant argument",
+                           ivec(problem_size, value), result);
+    }, others >> wrong_msg);
+  };
+  nd_range range{dims{problem_size}};
+  // the actor compares the content with the previous upload
+  auto w1 = mngr.spawn(kernel_source, kn_const, range,
+                       constant<int>{2}, out<int>{});
+  expect(w1, ivec{3, 0}, 3);
+  expect(w1, ivec{3, 0}, 3);
+  expect(w1, ivec{4, 0}, 4);
+  // the second element is the version, i.e., unchanged versions skip uploads
+  auto w2 = mngr.spawn(kernel_source, kn_const, range,
+                       constant<int>{2, [](const ivec& xs) {
+                         return static_cast<size_t>(xs[1]);
+                       }},
+                       out<int>{});
+  expect(w2, ivec{3, 1}, 3);
+  expect(w2, ivec{5, 1}, 3);
+  expect(w2, ivec{5, 2}, 5);
+  // tables must fit into the constant buffer of the device
+  auto limit = static_cast<size_t>(dev->max_constant_buffer_size());
+  auto reject = [&](const actor& w, ivec table) {
+    self->request(w, infinite, std::move(table)).receive(
+      [&](const ivec&) {
+        CAF_ERROR("uploaded a table beyond its maximum size");
+      },
+      [&](const error& err) {
+        CAF_CHECK_EQUAL(err.code(),
+                        static_cast<uint8_t>(sec::invalid_argument));
+      }
+    );
+  };
+  reject(w1, ivec{3, 0, 0});
+  auto w3 = mngr.spawn(kernel_source, kn_const, range,
+                       constant<int>{}, out<int>{});
+  expect(w3, ivec{6, 0}, 6);
+  reject(w3, ivec(limit / sizeof(int) + 1, 0));
+  auto too_large = false;
+  try {
+    mngr.spawn(kernel_source, kn_const, range,
+               constant<int>{limit / sizeof(int) + 1}, out<int>{});
+  } catch (std::runtime_error&) {
+    too_large = true;
+  }
+  CAF_CHECK(too_large);
+}
+
+void test_svm(actor_system& sys) {
+  CAF_MESSAGE("Testing shared virtual memory");
+  auto& mngr = sys.opencl_manager();
+  auto opt = mngr.find_device(0);
+  CAF_REQUIRE(opt);
+  auto dev = *opt;
+  if (dev->svm_capabilities() == 0) {
+    CAF_MESSAGE("Device does not support shared virtual memory, skipping");
+    CAF_CHECK(!dev->svm_argument<int>(problem_size));
+    return;
+  }
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  // kernels update the allocation in place
+  auto input = make_iota_vector<int>(problem_size);
+  auto values = dev->svm_argument(input);
+  CAF_REQUIRE(values);
+  nd_range range{dims{problem_size}};
+  auto w1 = mngr.spawn(kernel_source, kn_inout, range,
+                       in_out<int, svm, svm>{});
+  self->send(w1, *values);
+  self->receive([&](svm_ref<int>& result) {
+    CAF_CHECK(result.data() == values->data());
+    auto doubled = result.values();
+    CAF_REQUIRE(doubled);
+    ivec expected(input.size());
+    for (size_t i = 0; i < input.size(); ++i)
+      expected[i] = input[i] * 2;
+    check_vector_results("Doubling values in shared virtual memory",
+                         expected, *doubled);
+  }, others >> wrong_msg);
+  // results share their addresses with the host as well
+  const ivec res{ 56,  62,  68,  74, 152, 174, 196, 218,
+                 248, 286, 324, 362, 344, 398, 452, 506};
+  auto matrix = dev->svm_argument(make_iota_vector<int>(matrix_size
+                                                        * matrix_size));
+  CAF_REQUIRE(matrix);
+  auto w2 = mngr.spawn(kernel_source, kn_matrix,
+                       nd_range{dims{matrix_size, matrix_size}},
+                       in<int, svm>{}, out<int, svm>{});
+  self->send(w2, *matrix);
+  self->receive([&](svm_ref<int>& result) {
+    auto squared = result.values();
+    CAF_REQUIRE(squared);
+    check_vector_results("Matrix multiplication in shared virtual memory",
+                         res, *squared);
+  }, others >> wrong_msg);
+}
+
+void test_shared_span(actor_system& sys) {
+  CAF_MESSAGE("Testing shared spans as input payloads");
+  auto& mngr = sys.opencl_manager();
+  auto opt = mngr.find_device(0);
+  CAF_REQUIRE(opt);
+  auto dev = *opt;
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  // spans wrap existing vectors and check their bounds
+  auto input = make_shared_span(make_iota_vector<int>(problem_size));
+  CAF_CHECK_EQUAL(input.size(), problem_size);
+  CAF_CHECK_EQUAL(input.subspan(2, 3)[0], 2);
+  auto out_of_range = false;
+  try {
+    input.subspan(problem_size, 1);
+  } catch (std::out_of_range&) {
+    out_of_range = true;
+  }
+  CAF_CHECK(out_of_range);
+  // the same span fans out to several actors without copies
+  const ivec res{ 56,  62,  68,  74, 152, 174, 196, 218,
+                 248, 286, 324, 362, 344, 398, 452, 506};
+  auto matrix = make_shared_span(make_iota_vector<int>(matrix_size
+                                                       * matrix_size));
+  nd_range range{dims{matrix_size, matrix_size}};
+  auto w1 = mngr.spawn(kernel_source, kn_matrix, range,
+                       in<int, shared>{}, out<int>{});
+  auto w2 = mngr.spawn(kernel_source, kn_matrix, range,
+                       in<int, shared>{}, out<int>{});
+  self->send(w1, matrix);
+  self->send(w2, matrix);
+  for (int i = 0; i < 2; ++i) {
+    self->receive([&](const ivec& result) {
+      check_vector_results("Matrix multiplication with a shared span",
+                           res, result);
+    }, others >> wrong_msg);
+  }
+  // in_out arguments read from the span and return a new result
+  auto w3 = mngr.spawn(kernel_source, kn_inout, nd_range{dims{problem_size}},
+                       in_out<int, shared, val>{});
+  self->send(w3, input);
+  self->receive([&](const ivec& result) {
+    ivec expected(problem_size);
+    for (size_t i = 0; i < problem_size; ++i)
+      expected[i] = input[i] * 2;
+    check_vector_results("Doubling values from a shared span",
+                         expected, result);
+  }, others >> wrong_msg);
+  // pinned spans release their memory with the last reference
+  auto pinned = dev->pinned_span<int>(problem_size, [](int* xs, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+      xs[i] = static_cast<int>(i);
+  });
+  self->send(w3, pinned);
+  self->receive([&](const ivec& result) {
+    CAF_REQUIRE_EQUAL(result.size(), problem_size);
+    for (size_t i = 0; i < problem_size; ++i)
+      CAF_CHECK_EQUAL(result[i], static_cast<int>(i * 2));
+  }, others >> wrong_msg);
+}
+
+void test_program_family(actor_system& sys) {
+  CAF_MESSAGE("Testing program variants selected per message");
+  auto& mngr = sys.opencl_manager();
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  // the first element of each input selects the factor at compile time
+  auto select = [](const message& msg) {
+    return defines{{"FACTOR", std::to_string(msg.get_as<ivec>(0)[0])}};
+  };
+  auto scaled = [&](const actor& worker, int factor) {
+    auto input = make_iota_vector<int>(array_size);
+    input[0] = factor;
+    self->send(worker, input);
+    self->receive([&](const ivec& result) {
+      ivec expected(input.size());
+      for (size_t i = 0; i < input.size(); ++i)
+        expected[i] = input[i] * factor;
+      check_vector_results("Scaling with a compile-time factor",
+                           expected, result);
+    }, others >> wrong_msg);
+  };
+  auto family = mngr.create_program_family(kernel_source_variants);
+  CAF_CHECK_EQUAL(family->build_options({{"FACTOR", "2"}, {"FAST", ""}}),
+                  "-D FACTOR=2 -D FAST");
+  auto w1 = mngr.spawn(family, kn_scale_by, nd_range{dims{array_size}},
+                       select, in<int>{}, out<int>{});
+  scaled(w1, 2);
+  scaled(w1, 3);
+  scaled(w1, 2);
+  CAF_CHECK_EQUAL(family->stats().builds, 2u);
+  CAF_CHECK_EQUAL(family->live_variants(), 2u);
+  // the selector never sees messages of other types
+  self->request(w1, infinite, 42).receive(
+    [&](const ivec&) {
+      CAF_ERROR("dispatched a message of the wrong type");
+    },
+    [&](const error& err) {
+      CAF_CHECK_EQUAL(err.code(),
+                      static_cast<uint8_t>(sec::unexpected_message));
+    }
+  );
+  // families evict the least recently used variant
+  auto small = mngr.create_program_family(kernel_source_variants, nullptr,
+                                          0u, 1);
+  auto w2 = mngr.spawn(small, kn_scale_by, nd_range{dims{array_size}},
+                       select, in<int>{}, out<int>{});
+  scaled(w2, 2);
+  scaled(w2, 3);
+  scaled(w2, 2);
+  CAF_CHECK_EQUAL(small->stats().builds, 3u);
+  CAF_CHECK_EQUAL(small->stats().evictions, 2u);
+  CAF_CHECK_EQUAL(small->live_variants(), 1u);
+  // compiler errors reach the sender
+  auto w3 = mngr.spawn(family, kn_scale_by, nd_range{dims{array_size}},
+                       [](const message&) { return defines{}; },
+                       in<int>{}, out<int>{});
+  self->request(w3, infinite, make_iota_vector<int>(array_size)).receive(
+    [&](const ivec&) {
+      CAF_ERROR("kernel compiled without a factor");
+    },
+    [&](const error& err) {
+      CAF_CHECK_EQUAL(err.code(), static_cast<uint8_t>(sec::runtime_error));
+    }
+  );
+}
+
+void test_program_cache(actor_system& sys) {
+  CAF_MESSAGE("Testing deduplication of programs");
+  auto& mngr = sys.opencl_manager();
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  // identical sources, options and devices share one program
+  auto p1 = mngr.create_program(kernel_source);
+  auto p2 = mngr.create_program(kernel_source);
+  CAF_CHECK(p1 == p2);
+  auto p3 = mngr.create_program(kernel_source_compiler_flag, compiler_flag);
+  auto p4 = mngr.create_program(kernel_source_compiler_flag);
+  CAF_CHECK(p3 != p4);
+  // concurrent requests build the program once
+  mngr.clear_program_cache();
+  CAF_CHECK_EQUAL(mngr.cached_programs(), 0u);
+  std::vector<program_ptr> progs(4);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < progs.size(); ++i)
+    threads.emplace_back([&, i] {
+      progs[i] = mngr.create_program(kernel_source);
+    });
+  for (auto& t : threads)
+    t.join();
+  for (auto& prog : progs)
+    CAF_CHECK(prog == progs.front());
+  CAF_CHECK_EQUAL(mngr.cached_programs(), 1u);
+  // the cache drops least recently used programs beyond its limit
+  auto limit = mngr.max_cached_programs();
+  program_ptr oldest;
+  for (size_t i = 0; i < limit; ++i) {
+    auto flags = "-D CACHE_ENTRY=" + std::to_string(i);
+    auto prog = mngr.create_program(kernel_source, flags.c_str());
+    if (i == 0)
+      oldest = prog;
+    // using a program keeps it in the cache
+    CAF_CHECK(mngr.create_program(kernel_source) == progs.front());
+  }
+  CAF_CHECK_EQUAL(mngr.cached_programs(), limit);
+  CAF_CHECK(mngr.create_program(kernel_source, "-D CACHE_ENTRY=0") != oldest);
+  CAF_CHECK_EQUAL(mngr.cached_programs(), limit);
+  mngr.clear_program_cache();
+  // actors spawned from one source still set their arguments independently
+  nd_range range{dims{problem_size}};
+  auto w1 = mngr.spawn(kernel_source, kn_inout, range, in_out<int>{});
+  auto w2 = mngr.spawn(kernel_source, kn_inout, range, in_out<int>{});
+  CAF_CHECK_EQUAL(mngr.cached_programs(), 1u);
+  auto input = make_iota_vector<int>(problem_size);
+  self->send(w1, input);
+  self->send(w2, ivec(problem_size, 1));
+  for (int i = 0; i < 2; ++i) {
+    self->receive([&](const ivec& result) {
+      CAF_REQUIRE_EQUAL(result.size(), problem_size);
+      if (result[0] == 2) {
+        CAF_CHECK(result == ivec(problem_size, 2));
+      } else {
+        for (size_t j = 0; j < problem_size; ++j)
+          CAF_CHECK_EQUAL(result[j], input[j] * 2);
+      }
+    }, others >> wrong_msg);
+  }
+}
+
+void test_multi_device(actor_system& sys) {
+  CAF_MESSAGE("Testing programs built for several devices at once");
+  auto& mngr = sys.opencl_manager();
+  auto opt = mngr.find_device(0);
+  CAF_REQUIRE(opt);
+  auto dev = *opt;
+  vector<device_ptr> devs;
+  vector<device_ptr> foreign;
+  for (size_t i = 0; (opt = mngr.find_device(i)); ++i)
+    (dev->shares_context(**opt) ? devs : foreign).push_back(*opt);
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  auto prog = mngr.create_program(kernel_source, nullptr, devs);
+  CAF_CHECK_EQUAL(prog->devices().size(), devs.size());
+  CAF_CHECK(prog->get_device() == dev);
+  // actors on each device share the single build
+  nd_range range{dims{problem_size}};
+  auto input = make_iota_vector<int>(problem_size);
+  auto times = [&](int factor) {
+    ivec result(input.size());
+    for (size_t i = 0; i < input.size(); ++i)
+      result[i] = input[i] * factor;
+    return result;
+  };
+  for (auto& x : devs) {
+    auto on_x = prog->for_device(x);
+    CAF_CHECK(on_x->get_device() == x);
+    auto worker = mngr.spawn(on_x, kn_inout, range, in_out<int>{});
+    self->send(worker, input);
+    self->receive([&](const ivec& result) {
+      check_vector_results("Doubling values on device " + to_string(x->id()),
+                           times(2), result);
+    }, others >> wrong_msg);
+  }
+  // buffers produced on one device feed actors on another
+  auto producer = mngr.spawn(prog->for_device(devs.back()), kn_inout, range,
+                             in_out<int, val, mref>{});
+  auto consumer = mngr.spawn(prog, kn_inout, range, in_out<int, mref, val>{});
+  self->send(producer, input);
+  self->receive([&](iref& ref) {
+    self->send(consumer, ref);
+  }, others >> wrong_msg);
+  self->receive([&](const ivec& result) {
+    check_vector_results("Passing a mem_ref between devices", times(4),
+                         result);
+  }, others >> wrong_msg);
+  // devices of other contexts need their own build
+  for (auto& x : foreign) {
+    auto rejected = false;
+    try {
+      prog->for_device(x);
+    } catch (std::runtime_error&) {
+      rejected = true;
+    }
+    CAF_CHECK(rejected);
+  }
+}
+
+void test_program_binary(actor_system& sys) {
+  CAF_MESSAGE("Testing programs loaded from binaries");
+  auto& mngr = sys.opencl_manager();
+  auto opt = mngr.find_device(0);
+  CAF_REQUIRE(opt);
+  auto dev = *opt;
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  nd_range range{dims{problem_size}};
+  auto input = make_iota_vector<int>(problem_size);
+  ivec expected(problem_size);
+  for (size_t i = 0; i < problem_size; ++i)
+    expected[i] = input[i] * 2;
+  auto doubles = [&](program_ptr prog, const char* description) {
+    auto worker = mngr.spawn(prog, kn_inout, range, in_out<int>{});
+    self->send(worker, input);
+    self->receive([&](const ivec& result) {
+      check_vector_results(description, expected, result);
+    }, others >> wrong_msg);
+  };
+  auto binary = mngr.create_program(kernel_source, nullptr, dev)->binary();
+  CAF_REQUIRE(!binary.empty());
+  doubles(mngr.create_program_from_binary(binary.data(), binary.size(),
+                                          nullptr, dev),
+          "Doubling values with a program loaded from memory");
+  // files are mapped into memory instead of copied
+  const char* path = "caf_opencl_test_program.bin";
+  { // lifetime scope of out
+    std::ofstream out{path, std::ios::binary};
+    out.write(reinterpret_cast<const char*>(binary.data()),
+              static_cast<std::streamsize>(binary.size()));
+  }
+  doubles(mngr.create_program_from_binary_file(path, nullptr, dev),
+          "Doubling values with a program loaded from a file");
+  std::remove(path);
+  auto missing = false;
+  try {
+    mngr.create_program_from_il_file(path, nullptr, dev);
+  } catch (std::runtime_error&) {
+    missing = true;
+  }
+  CAF_CHECK(missing);
+}
+
+void test_input_size(actor_system& sys) {
+  CAF_MESSAGE("Testing index spaces derived from the input length");
+  auto& mngr = sys.opencl_manager();
+  scoped_actor self{sys};
+  auto wrong_msg = [&](message_view& x) -> result<message> {
+    CAF_ERROR("unexpected message" << x.content().stringify());
+    return sec::unexpected_message;
+  };
+  auto w = mngr.spawn(kernel_source_bounded, kn_bounded,
+                      nd_range{input_size{}}, in<int>{}, out<int>{},
+                      priv<cl_uint, elements>{});
+  // lengths that are no multiple of any work group size
+  for (auto n : {size_t{1}, size_t{97}, size_t{1000}, size_t{4099}}) {
+    auto input = make_iota_vector<int>(n);
+    self->send(w, input);
+    self->receive([&](const ivec& result) {
+      ivec expected(input.size());
+      for (size_t i = 0; i < input.size(); ++i)
+        expected[i] = input[i] + 1;
+      check_vector_results("Incrementing " + to_string(n) + " values",
+                           expected, result);
+    }, others >> wrong_msg);
+  }
+  // empty inputs define no index space
+  self->request(w, infinite, ivec{}).receive(
+    [&](const ivec&) {
+      CAF_ERROR("launched a kernel without work items");
+    },
+    [&](const error& err) {
+      CAF_CHECK_EQUAL(err.code(), static_cast<uint8_t>(sec::invalid_argument));
+    }
+  );
+  // the policy must select an existing input
+  auto rejected = false;
+  try {
+    mngr.spawn(kernel_source_bounded, kn_bounded, nd_range{input_size{1}},
+               in<int>{}, out<int>{}, priv<cl_uint, elements>{});
+  } catch (std::runtime_error&) {
+    rejected = true;
+  }
+  CAF_CHECK(rejected);
+}
+
 CAF_TEST(actor_facade) {
   actor_system_config cfg;
   cfg.load<opencl::manager>()
     .add_message_type<ivec>("int_vector")
     .add_message_type<matrix_type>("square_matrix");
+  add_vector_types(cfg);
   actor_system system{cfg};
   test_in_val_out_val(system);
   test_in_val_out_mref(system);
@@ -1112,5 +2345,27 @@ CAF_TEST(actor_facade) {
   test_inout(system);
   test_priv(system);
   test_local(system);
+  test_host_pool(system);
+  test_memory_usage(system);
+  test_spilling(system);
+  test_scan(system);
+  test_reduce(system);
+  test_radix_sort(system);
+  test_histogram(system);
+  test_gemm(system);
+  test_compact(system);
+  test_vector_types(system);
+  test_soa(system);
+  test_images(system);
+  test_resident(system);
+  test_upload_cache(system);
+  test_constant(system);
+  test_svm(system);
+  test_shared_span(system);
+  test_program_family(system);
+  test_program_cache(system);
+  test_multi_device(system);
+  test_program_binary(system);
+  test_input_size(system);
   system.await_all_actors_done();
 }